@@ -0,0 +1,220 @@
+/*
+ *  OpenVPN-GUI -- A Windows GUI for OpenVPN.
+ *
+ *  Copyright (C) 2026 OpenVPN GUI contributors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program (see the file COPYING included with this
+ *  distribution); if not, write to the Free Software Foundation, Inc.,
+ *  59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <windows.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "main.h"
+#include "auth_param.h"
+
+void
+free_auth_param (auth_param_t *param)
+{
+    if (!param)
+        return;
+    arena_free (&param->arena);
+    if (param->cr_response && *param->cr_response)
+    {
+        SecureZeroMemory (param->cr_response, strlen (param->cr_response));
+        free (param->cr_response);
+    }
+    free (param);
+}
+
+/* Challenge flags and the letters that set them in "E,R" style flag strings */
+static const struct {
+    char ch;
+    unsigned int flag;
+} cr_flag_table[] = {
+    { 'E', FLAG_CR_ECHO },
+    { 'R', FLAG_CR_RESPONSE },
+};
+
+static unsigned int
+parse_cr_flags (const char *str)
+{
+    unsigned int flags = 0;
+
+    for ( ; *str; ++str)
+    {
+        for (size_t i = 0; i < _countof(cr_flag_table); ++i)
+        {
+            if (*str == cr_flag_table[i].ch)
+                flags |= cr_flag_table[i].flag;
+        }
+    }
+    return flags;
+}
+
+/*
+ * Split str in place at the first occurrence of sep and return a pointer
+ * to the rest of the string, or NULL if sep is not found.
+ */
+static char *
+split_at (char *str, char sep)
+{
+    char *p = strchr (str, sep);
+    if (!p)
+        return NULL;
+    *p = '\0';
+    return p + 1;
+}
+
+/*
+ * Parse dynamic challenge string received from the server. Returns
+ * true on success. The caller must free param using free_auth_param
+ * even on error.
+ */
+BOOL
+parse_dynamic_cr (const char *str, auth_param_t *param)
+{
+    if (!param || !str)
+        return FALSE;
+
+    /* One arena allocation holds the tokens and the decoded username */
+    size_t len = strlen (str) + 1;
+    char *p = arena_alloc (&param->arena, len + Base64DecodedSize (str));
+    if (!p)
+        return FALSE;
+    memcpy (p, str, len);
+
+    /* expected: str = "E,R:challenge_id:user_b64:challenge_str" */
+    char *token[4] = {p};
+    for (int i = 1; i < 4; ++i)
+    {
+        /* the last token is the entire trailing string */
+        token[i] = split_at (token[i-1], ':');
+        if (!token[i])
+            return FALSE;
+    }
+    /* flags may be empty, the id, username and challenge may not */
+    if (!*token[1] || !*token[2] || !*token[3])
+        return FALSE;
+
+    param->user = p + len;
+    if (Base64DecodeTo (token[2], param->user, Base64DecodedSize (str)) <= 0)
+    {
+        PrintDebug (L"Error decoding the username in dynamic challenge string");
+        param->user = NULL;
+        return FALSE;
+    }
+
+    param->flags |= FLAG_CR_TYPE_CRV1;
+    param->flags |= parse_cr_flags (token[0]);
+    param->id = token[1];
+    param->str = token[3];
+
+    return TRUE;
+}
+
+/*
+ * Parse crtext string received from the server. Returns
+ * true on success. The caller must free param using free_auth_param
+ * even on error.
+ */
+BOOL
+parse_crtext (const char* str, auth_param_t* param)
+{
+    if (!param || !str)
+        return FALSE;
+
+    char *p = arena_strdup (&param->arena, str);
+    if (!p)
+        return FALSE;
+
+    /* expected: str = "E,R:challenge_str" */
+    char *challenge = split_at (p, ':');
+    if (!challenge)
+        return FALSE;
+
+    param->flags |= FLAG_CR_TYPE_CRTEXT;
+    param->flags |= parse_cr_flags (p);
+    param->str = challenge;
+
+    return TRUE;
+}
+
+/*
+ * Parse password or string request of the form "Need 'What' password/string MSG:message"
+ * and assign param->id = What, param->str = message. Also set param->flags if the type
+ * of the requested info is known. If message is empty param->id is copied to param->str.
+ * Return true on succsess. The caller must free param even when the function fails.
+ */
+BOOL
+parse_input_request (const char *msg, auth_param_t *param)
+{
+    BOOL ret = FALSE;
+    char *p = arena_strdup (&param->arena, msg);
+    char *sep[4] = {" ", "'", " ", ""}; /* separators to use to break up msg */
+    char *token[4];
+
+    if (!p)
+        goto out;
+
+    char *p1 = p;
+    for (int i = 0; i < 4; ++i, p1 = NULL)
+    {
+        token[i] = strtok (p1, sep[i]); /* strtok is thread-safe on Windows */
+        if (!token[i] && i < 3) /* first three tokens required */
+            goto out;
+    }
+    if (token[3] && strncmp(token[3], "MSG:", 4) == 0)
+        token[3] += 4;
+    if (!token[3] || !*token[3]) /* use id as the description if none provided */
+        token[3] = token[1];
+
+    PrintDebug (L"Tokens: '%hs' '%hs' '%hs' '%hs'", token[0], token[1],
+                token[2], token[3]);
+
+    if (strcmp (token[0], "Need") != 0)
+        goto out;
+
+    param->id = token[1];
+
+    if (strcmp(token[2], "password") == 0)
+    {
+        if (strcmp (param->id, "Private Key") == 0)
+            param->flags |= FLAG_PASS_PKEY;
+        else
+            param->flags |= FLAG_PASS_TOKEN;
+    }
+    else if (strcmp(token[2], "string") == 0
+             && strcmp (param->id, "pkcs11-id-request") == 0)
+    {
+        param->flags |= FLAG_STRING_PKCS11;
+    }
+
+    param->str = token[3];
+
+    PrintDebug (L"parse_input_request: id = '%hs' str = '%hs' flags = %u",
+                param->id, param->str, param->flags);
+    ret = TRUE;
+
+out:
+    if (!ret)
+        PrintDebug (L"Error parsing password/string request msg: <%hs>", msg);
+    return ret;
+}
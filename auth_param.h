@@ -0,0 +1,81 @@
+/*
+ *  OpenVPN-GUI -- A Windows GUI for OpenVPN.
+ *
+ *  Copyright (C) 2026 OpenVPN GUI contributors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program (see the file COPYING included with this
+ *  distribution); if not, write to the Free Software Foundation, Inc.,
+ *  59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef AUTH_PARAM_H
+#define AUTH_PARAM_H
+
+/*
+ * Parameters of user authentication requests and the parsers of the
+ * request strings. Uses no Windows API beyond basic types so that the
+ * parsers can be tested on any host (see tests/).
+ */
+
+#include <windows.h>
+
+#include "strutil.h"
+
+#define FLAG_CR_TYPE_SCRV1  0x1    /* static challenege */
+#define FLAG_CR_TYPE_CRV1   0x2    /* dynamic challenege */
+#define FLAG_CR_ECHO        0x4    /* echo the response */
+#define FLAG_CR_RESPONSE    0x8    /* response needed */
+#define FLAG_PASS_TOKEN     0x10   /* PKCS11 token password needed */
+#define FLAG_STRING_PKCS11  0x20   /* PKCS11 id needed */
+#define FLAG_PASS_PKEY      0x40   /* Private key password needed */
+#define FLAG_CR_TYPE_CRTEXT 0x80   /* crtext */
+
+typedef struct {
+    struct connection *c;  /* the connection_t that asked */
+    unsigned int flags;
+    char* str;             /* str, id and user point into arena */
+    char* id;
+    char* user;
+    char* cr_response;
+    arena_t arena;         /* wiped by free_auth_param */
+} auth_param_t;
+
+/*
+ * Parse dynamic challenge string received from the server. Returns
+ * true on success. The caller must free param using free_auth_param
+ * even on error.
+ */
+BOOL
+parse_dynamic_cr(const char* str, auth_param_t* param);
+
+/*
+ * Parse crtext string of the form "E,R:challenge_str" received from
+ * the server. Returns true on success. The caller must free param
+ * using free_auth_param even on error.
+ */
+BOOL
+parse_crtext(const char* str, auth_param_t* param);
+
+/*
+ * Parse password or string request of the form "Need 'What' password/string MSG:message".
+ * Returns true on success. The caller must free param using free_auth_param
+ * even on error.
+ */
+BOOL
+parse_input_request(const char* msg, auth_param_t* param);
+
+void
+free_auth_param(auth_param_t* param);
+
+#endif
@@ -42,18 +42,75 @@ extern options_t o;
 #define ECHO_MSG_WINDOW (1)
 #define ECHO_MSG_NOTIFY (2)
 
-/* Old text in the window is deleted when content grows beyond this many lines */
-#define MAX_MSG_LINES 1000
+/* Number of messages kept for display in the message window */
+#define MAX_MSG_ITEMS 500
+/* Messages rendered at a time: more are added as the user scrolls down */
+#define MSG_PAGE_SIZE 20
 
+/* Posted to the message window to check whether more messages should be rendered */
+#define WM_MSG_CHECK_SCROLL (WM_APP + 100)
+
+/* Max number of messages remembered and persisted per connection */
+#define ECHO_MSG_HISTORY_SIZE 100
+/* Size of the hash table indexing the history: a power of 2, at least twice the above */
+#define ECHO_MSG_HASH_SIZE 256
+
+/*
+ * Message history used to be persisted with SHA1 digests. Such entries
+ * are kept aside on load and matched by computing SHA1 of new messages
+ * until they are migrated or expire.
+ */
+#define LEGACY_HASHLEN 20
+struct echo_msg_legacy_fp {
+    BYTE digest[LEGACY_HASHLEN];
+    time_t timestamp;
+};
+
+/*
+ * Message history: fingerprints of recently shown messages indexed
+ * by an open addressing hash table on the digest, and kept in least
+ * recently used order. When full, the least recently used entry is
+ * replaced.
+ */
 struct echo_msg_history {
-    struct echo_msg_fp fp;
-    struct echo_msg_history *next;
+    struct echo_msg_fp fp[ECHO_MSG_HISTORY_SIZE];
+    short prev[ECHO_MSG_HISTORY_SIZE];  /* LRU list links, -1 terminated */
+    short next[ECHO_MSG_HISTORY_SIZE];
+    short bucket[ECHO_MSG_HASH_SIZE];   /* index into fp[] or -1 if empty */
+    short head;                         /* most recently used */
+    short tail;                         /* least recently used */
+    short count;
+    short nlegacy;                      /* number of items in legacy */
+    struct echo_msg_legacy_fp *legacy;  /* SHA1 entries loaded from registry or NULL */
 };
 
 /* We use a global message window for all messages
  */
 static HWND echo_msg_window;
 
+/*
+ * Messages shown in the window are kept in a ring buffer, and only
+ * the most recent ones, enough to fill the view, are rendered into the
+ * edit control. Older ones are rendered on demand as the user scrolls
+ * down, and the content is discarded when the window is hidden.
+ * The store and the control are only accessed from the window thread.
+ */
+struct msg_item {
+    wchar_t *title;
+    wchar_t *text;
+    wchar_t *from;
+    LONG nchars;            /* length of the message as rendered in the control */
+};
+
+static struct {
+    struct msg_item item[MAX_MSG_ITEMS];
+    int first;              /* index of the oldest message */
+    int count;
+    int shown;              /* number of most recent messages rendered */
+    int limit;              /* max messages to render before the user scrolls further */
+    LONG nchars;            /* total length of the rendered text */
+} msg_store;
+
 /* Forward declarations */
 static void
 AddMessageBoxText(HWND hwnd, const wchar_t *text, const wchar_t *title, const wchar_t *from);
@@ -72,58 +129,225 @@ echo_msg_init(void)
     }
 }
 
-/* compute a digest of the message and add it to the msg struct */
+/* Add data to the fingerprint of the message, starting a new one if required */
 static void
-echo_msg_add_fp(struct echo_msg *msg, time_t timestamp)
+echo_msg_digest_update(struct echo_msg *msg, const void *data, size_t size)
 {
-    md_ctx ctx;
-
-    msg->fp.timestamp = timestamp;
-    if (md_init(&ctx, CALG_SHA1) != 0)
-        return;
-    md_update(&ctx, (BYTE*) msg->text, msg->txtlen*sizeof(msg->text[0]));
-    md_update(&ctx, (BYTE*) msg->title, wcslen(msg->title)*sizeof(msg->title[0]));
-    md_final(&ctx, msg->fp.digest);
-    return;
+    /* SHA1 is computed only to match entries in legacy history */
+    if (msg->hash.len == 0 && !msg->md
+        && msg->history && msg->history->nlegacy > 0)
+    {
+        msg->md = malloc(sizeof(*msg->md));
+        if (msg->md && md_init(msg->md, CALG_SHA1) != 0)
+        {
+            free(msg->md);
+            msg->md = NULL;
+        }
+    }
+    echo_msg_hash_update(&msg->hash, data, size);
+    if (msg->md)
+        md_update(msg->md, data, size);
 }
 
-/* find message with given digest in history */
 static struct echo_msg_history *
-echo_msg_recall(const BYTE *digest, struct echo_msg_history *hist)
+echo_msg_history_new(void)
+{
+    struct echo_msg_history *h = calloc(1, sizeof(*h));
+    if (h)
+    {
+        memset(h->bucket, 0xff, sizeof(h->bucket)); /* all -1 */
+        h->head = h->tail = -1;
+    }
+    return h;
+}
+
+/* The digest is well mixed: any of its bytes will do as a hash key */
+static inline unsigned int
+echo_msg_hash(const BYTE *digest)
 {
-    for( ; hist; hist = hist->next)
+    unsigned int k;
+    memcpy(&k, digest, sizeof(k));
+    return k & (ECHO_MSG_HASH_SIZE - 1);
+}
+
+/* Return the bucket holding the message with given digest or -1 if not found */
+static int
+echo_msg_find_bucket(const struct echo_msg_history *h, const BYTE *digest)
+{
+    for (unsigned int b = echo_msg_hash(digest); h->bucket[b] >= 0; b = (b + 1) & (ECHO_MSG_HASH_SIZE - 1))
     {
-        if (memcmp(hist->fp.digest, digest, HASHLEN) == 0) break;
+        if (memcmp(h->fp[h->bucket[b]].digest, digest, HASHLEN) == 0)
+            return b;
     }
-    return hist;
+    return -1;
 }
 
-/* Add an item to message history and return the head of the list */
-static struct echo_msg_history*
-echo_msg_history_add(struct echo_msg_history *head, const struct echo_msg_fp *fp)
+/* Empty a bucket and shift back later entries of its probe sequence */
+static void
+echo_msg_remove_bucket(struct echo_msg_history *h, unsigned int b)
 {
-    struct echo_msg_history *hist = malloc(sizeof(struct echo_msg_history));
-    if (hist)
+    const unsigned int mask = ECHO_MSG_HASH_SIZE - 1;
+    unsigned int j = b;
+
+    while (1)
     {
-        memcpy(&hist->fp, fp, sizeof(*fp));
-        hist->next = head;
-        head = hist;
+        j = (j + 1) & mask;
+        if (h->bucket[j] < 0)
+            break;
+        unsigned int home = echo_msg_hash(h->fp[h->bucket[j]].digest);
+        /* move entry at j to b if b lies cyclically in [home, j) */
+        if (((j - home) & mask) >= ((j - b) & mask))
+        {
+            h->bucket[b] = h->bucket[j];
+            b = j;
+        }
     }
-    return head;
+    h->bucket[b] = -1;
+}
+
+static void
+echo_msg_lru_unlink(struct echo_msg_history *h, int i)
+{
+    if (h->prev[i] >= 0)
+        h->next[h->prev[i]] = h->next[i];
+    else
+        h->head = h->next[i];
+    if (h->next[i] >= 0)
+        h->prev[h->next[i]] = h->prev[i];
+    else
+        h->tail = h->prev[i];
+}
+
+static void
+echo_msg_lru_push_front(struct echo_msg_history *h, int i)
+{
+    h->prev[i] = -1;
+    h->next[i] = h->head;
+    if (h->head >= 0)
+        h->prev[h->head] = i;
+    else
+        h->tail = i;
+    h->head = i;
+}
+
+/* Remove the least recently used item */
+static void
+echo_msg_drop_lru(struct echo_msg_history *h)
+{
+    int i = h->tail;
+    echo_msg_remove_bucket(h, echo_msg_find_bucket(h, h->fp[i].digest));
+    echo_msg_lru_unlink(h, i);
+    h->count--;
+    /* keep entries packed in fp[0..count-1]: move the last one into the hole */
+    int last = h->count;
+    if (i != last)
+    {
+        h->fp[i] = h->fp[last];
+        h->bucket[echo_msg_find_bucket(h, h->fp[i].digest)] = i;
+        h->prev[i] = h->prev[last];
+        h->next[i] = h->next[last];
+        if (h->prev[i] >= 0)
+            h->next[h->prev[i]] = i;
+        else
+            h->head = i;
+        if (h->next[i] >= 0)
+            h->prev[h->next[i]] = i;
+        else
+            h->tail = i;
+    }
+}
+
+/* Return true if a history item with this time stamp no longer mutes a message shown at now */
+static BOOL
+echo_msg_expired(time_t timestamp, time_t now)
+{
+    return timestamp + (time_t) o.popup_mute_interval*3600 <= now;
+}
+
+/* find message with given digest in history */
+static struct echo_msg_fp *
+echo_msg_recall(const BYTE *digest, struct echo_msg_history *h)
+{
+    if (!h)
+        return NULL;
+    int b = echo_msg_find_bucket(h, digest);
+    return (b >= 0) ? &h->fp[h->bucket[b]] : NULL;
+}
+
+/* Add an item to message history or refresh it if present, and mark it as most recently used */
+static void
+echo_msg_history_add(struct echo_msg_history *h, const struct echo_msg_fp *fp)
+{
+    int b = echo_msg_find_bucket(h, fp->digest);
+    if (b >= 0) /* update */
+    {
+        int i = h->bucket[b];
+        h->fp[i].timestamp = fp->timestamp;
+        echo_msg_lru_unlink(h, i);
+        echo_msg_lru_push_front(h, i);
+        return;
+    }
+
+    /* make room: drop expired items and, if still full, the least recently used one */
+    while (h->count > 0 && echo_msg_expired(h->fp[h->tail].timestamp, fp->timestamp))
+        echo_msg_drop_lru(h);
+    if (h->count == ECHO_MSG_HISTORY_SIZE)
+        echo_msg_drop_lru(h);
+
+    int i = h->count++;
+    h->fp[i] = *fp;
+    for (b = echo_msg_hash(fp->digest); h->bucket[b] >= 0; b = (b + 1) & (ECHO_MSG_HASH_SIZE - 1))
+        ;
+    h->bucket[b] = i;
+    echo_msg_lru_push_front(h, i);
 }
 
 /* Save message in history -- update if already present */
 static void
 echo_msg_save(struct echo_msg *msg)
 {
-    struct echo_msg_history *hist = echo_msg_recall(msg->fp.digest, msg->history);
-    if (hist) /* update */
+    if (!msg->history)
+        msg->history = echo_msg_history_new();
+    if (msg->history)
+        echo_msg_history_add(msg->history, &msg->fp);
+}
+
+/*
+ * If a legacy history entry matches the SHA1 digest, move it into the
+ * history under the new fingerprint.
+ */
+static void
+echo_msg_migrate(struct echo_msg_history *h, const BYTE *sha1, const BYTE *digest)
+{
+    for (int i = 0; i < h->nlegacy; i++)
     {
-        hist->fp.timestamp = msg->fp.timestamp;
+        if (memcmp(h->legacy[i].digest, sha1, LEGACY_HASHLEN) == 0)
+        {
+            struct echo_msg_fp fp = { .timestamp = h->legacy[i].timestamp };
+            memcpy(fp.digest, digest, HASHLEN);
+            h->legacy[i] = h->legacy[--h->nlegacy];
+            if (!echo_msg_recall(digest, h))
+                echo_msg_history_add(h, &fp);
+            return;
+        }
     }
-    else     /* add */
+}
+
+/* Complete the digest of the message and add it to the msg struct with timestamp */
+static void
+echo_msg_add_fp(struct echo_msg *msg, time_t timestamp)
+{
+    msg->fp.timestamp = timestamp;
+    /* The text has already been added to the digest as it was received */
+    echo_msg_digest_update(msg, msg->title, wcslen(msg->title)*sizeof(msg->title[0]));
+    echo_msg_hash_final(&msg->hash, msg->fp.digest);
+    if (msg->md)
     {
-        msg->history = echo_msg_history_add(msg->history, &msg->fp);
+        BYTE sha1[LEGACY_HASHLEN];
+        if (md_final(msg->md, sha1) == 0 && msg->history)
+            echo_msg_migrate(msg->history, sha1, msg->fp.digest);
+        free(msg->md);
+        msg->md = NULL;
     }
 }
 
@@ -131,122 +355,153 @@ echo_msg_save(struct echo_msg *msg)
 void
 echo_msg_persist(connection_t *c)
 {
-    struct echo_msg_history *hist;
+    struct echo_msg_history *h = c->echo_msg.history;
+    struct echo_msg_fp data[ECHO_MSG_HISTORY_SIZE];
     size_t len = 0;
 
-    for (hist = c->echo_msg.history; hist; hist = hist->next)
+    if (!h)
+        return;
+
+    /* write in most recently used first order, skipping expired ones */
+    time_t now = time(NULL);
+    for (int i = h->head; i >= 0 && !echo_msg_expired(h->fp[i].timestamp, now); i = h->next[i])
     {
-        len++;
-        if (len > 99) break; /* max 100 history items persisted */
+        data[len++] = h->fp[i];
     }
-    if (len == 0)
+
+    if (len > 0
+        && !SetConfigRegistryValueBinary(c->config_name, L"echo_msg_history2", (BYTE *) data, len*sizeof(data[0])))
+        WriteStatusLog(c, L"GUI> ", L"Failed to persist echo msg history: error writing to registry", false);
+
+    if (!h->legacy)
         return;
 
-    size_t size = len*sizeof(struct echo_msg_fp);
-    struct echo_msg_fp *data = malloc(size);
-    if (data == NULL)
+    /* keep legacy entries not yet migrated or expired, drop the old value when none are left */
+    struct echo_msg_legacy_fp *legacy = h->legacy;
+    len = 0;
+    for (int i = 0; i < h->nlegacy; i++)
     {
-        WriteStatusLog(c, L"GUI> ", L"Failed to persist echo msg history: Out of memory", false);
-        return;
+        if (!echo_msg_expired(legacy[i].timestamp, now))
+            legacy[len++] = legacy[i];
     }
+    h->nlegacy = (short) len;
 
-    size_t i = 0;
-    for (hist = c->echo_msg.history; i < len && hist; hist = hist->next)
+    if (len == 0)
     {
-        data[i++] = hist->fp;
+        DeleteConfigRegistryValue(c->config_name, L"echo_msg_history");
+        free(h->legacy);
+        h->legacy = NULL;
     }
-    if (!SetConfigRegistryValueBinary(c->config_name, L"echo_msg_history", (BYTE *) data, size))
+    else if (!SetConfigRegistryValueBinary(c->config_name, L"echo_msg_history", (BYTE *) legacy, len*sizeof(legacy[0])))
         WriteStatusLog(c, L"GUI> ", L"Failed to persist echo msg history: error writing to registry", false);
+}
+
+/*
+ * Load SHA1 based echo msg history persisted by earlier versions. The
+ * entries are matched and migrated as messages arrive.
+ */
+static void
+echo_msg_load_legacy(connection_t *c, struct echo_msg_history *h)
+{
+    DWORD item_len = sizeof(struct echo_msg_legacy_fp);
+
+    size_t size = GetConfigRegistryValue(c->config_name, L"echo_msg_history", NULL, 0);
+    if (size == 0)
+        return;
+    else if (size%item_len != 0 || size > ECHO_MSG_HISTORY_SIZE*item_len)
+    {
+        DeleteConfigRegistryValue(c->config_name, L"echo_msg_history");
+        return;
+    }
 
-    free(data);
-    return;
+    struct echo_msg_legacy_fp *legacy = malloc(size);
+    if (!legacy)
+        return;
+    if (!GetConfigRegistryValue(c->config_name, L"echo_msg_history", (BYTE *) legacy, size))
+    {
+        free(legacy);
+        return;
+    }
+    free(h->legacy);
+    h->legacy = legacy;
+    h->nlegacy = (short) (size/item_len);
 }
 
 /* load echo msg history from registry */
 void
 echo_msg_load(connection_t *c)
 {
-    struct echo_msg_fp *data = NULL;
+    struct echo_msg_fp data[ECHO_MSG_HISTORY_SIZE];
     DWORD item_len = sizeof(struct echo_msg_fp);
 
-    size_t size = GetConfigRegistryValue(c->config_name, L"echo_msg_history", NULL, 0);
+    if (!c->echo_msg.history)
+        c->echo_msg.history = echo_msg_history_new();
+    if (!c->echo_msg.history)
+        return;
+
+    echo_msg_load_legacy(c, c->echo_msg.history);
+
+    size_t size = GetConfigRegistryValue(c->config_name, L"echo_msg_history2", NULL, 0);
     if (size == 0)
         return; /* no history in registry */
-    else if (size%item_len != 0)
+    else if (size%item_len != 0 || size > sizeof(data))
     {
         WriteStatusLog(c, L"GUI> ", L"echo msg history in registry has invalid size", false);
         return;
     }
 
-    data = malloc(size);
-    if (!data || !GetConfigRegistryValue(c->config_name, L"echo_msg_history", (BYTE*) data, size))
-        goto out;
+    if (!GetConfigRegistryValue(c->config_name, L"echo_msg_history2", (BYTE*) data, size))
+        return;
 
-    size_t len = size/item_len;
-    for(size_t i = 0; i < len; i++)
+    /* saved as most recently used first: add in reverse to restore that order */
+    time_t now = time(NULL);
+    for (size_t i = size/item_len; i > 0; i--)
     {
-        c->echo_msg.history = echo_msg_history_add(c->echo_msg.history, &data[i]);
+        if (!echo_msg_expired(data[i-1].timestamp, now))
+            echo_msg_history_add(c->echo_msg.history, &data[i-1]);
     }
-
-out:
-    free(data);
 }
 
 /* Return true if the message is same as recently shown */
 static BOOL
 echo_msg_repeated(const struct echo_msg *msg)
 {
-    const struct echo_msg_history *hist;
-
-    hist = echo_msg_recall(msg->fp.digest, msg->history);
-    return (hist && (hist->fp.timestamp + o.popup_mute_interval*3600 > msg->fp.timestamp));
+    const struct echo_msg_fp *fp = echo_msg_recall(msg->fp.digest, msg->history);
+    return (fp && !echo_msg_expired(fp->timestamp, msg->fp.timestamp));
 }
 
 /* Append a line of echo msg */
 static void
 echo_msg_append(connection_t *c, time_t UNUSED timestamp, const char *msg, BOOL addnl)
 {
-    wchar_t *eol = L"";
-    wchar_t *wmsg = NULL;
+    struct echo_msg *m = &c->echo_msg;
+    int n = echo_msg_append_text(m, msg, addnl);
 
-    if (!(wmsg = Widen(msg)))
+    if (n == -1)
     {
         WriteStatusLog(c, L"GUI> ", L"Error: out of memory while processing echo msg", false);
-        goto out;
-    }
-
-    size_t len = c->echo_msg.txtlen + wcslen(wmsg) + 1;  /* including null terminator */
-    if (addnl)
-    {
-        eol = L"\r\n";
-        len += 2;
+        return;
     }
-    WCHAR *s = realloc(c->echo_msg.text, len*sizeof(WCHAR));
-    if (!s)
+    else if (n < 0)
     {
-        WriteStatusLog(c, L"GUI> ", L"Error: out of memory while processing echo msg", false);
-        goto out;
+        WriteStatusLog(c, L"GUI> ", L"Error converting echo msg to widechar", false);
+        return;
     }
-    swprintf(s + c->echo_msg.txtlen, len - c->echo_msg.txtlen,  L"%ls%ls", wmsg, eol);
 
-    s[len-1] = L'\0';
-    c->echo_msg.text = s;
-    c->echo_msg.txtlen = len - 1; /* exclude null terminator */
-
-out:
-    free(wmsg);
-    return;
+    /* Fold the new text into the digest now to avoid rehashing it all at the end */
+    echo_msg_digest_update(m, m->text + m->txtlen - n, n*sizeof(WCHAR));
 }
 
 /* Called when echo msg-window or echo msg-notify is received */
 static void
 echo_msg_display(connection_t *c, time_t timestamp, const char *title, int type)
 {
-    WCHAR *wtitle = Widen(title);
+    widebuf_t wtitle;
 
-    if (wtitle)
+    /* the title is needed only until the message is shown and saved */
+    if (WidenBuf(&wtitle, CP_UTF8, title))
     {
-        c->echo_msg.title = wtitle;
+        c->echo_msg.title = wtitle.str;
     }
     else
     {
@@ -258,7 +513,7 @@ echo_msg_display(connection_t *c, time_t timestamp, const char *title, int type)
      /* Check whether the message is muted */
     if (c->flags & FLAG_DISABLE_ECHO_MSG || echo_msg_repeated(&c->echo_msg))
     {
-        return;
+        goto out;
     }
     if (type == ECHO_MSG_WINDOW)
     {
@@ -276,6 +531,10 @@ echo_msg_display(connection_t *c, time_t timestamp, const char *title, int type)
     }
     /* save or update history */
     echo_msg_save(&c->echo_msg);
+
+out:
+    c->echo_msg.title = NULL;
+    FreeWidebuf(&wtitle);
 }
 
 void
@@ -324,23 +583,27 @@ void
 echo_msg_clear(connection_t *c, BOOL clear_history)
 {
     CLEAR(c->echo_msg.fp);
+    CLEAR(c->echo_msg.hash);
+    if (c->echo_msg.md)
+    {
+        BYTE digest[LEGACY_HASHLEN];
+        md_final(c->echo_msg.md, digest); /* releases the hash context */
+        free(c->echo_msg.md);
+        c->echo_msg.md = NULL;
+    }
     free(c->echo_msg.text);
     free(c->echo_msg.title);
     c->echo_msg.text = NULL;
     c->echo_msg.txtlen = 0;
+    c->echo_msg.txtsize = 0;
     c->echo_msg.title = NULL;
 
     if (clear_history)
     {
         echo_msg_persist(c);
-        struct echo_msg_history *head = c->echo_msg.history;
-        struct echo_msg_history *next;
-        while (head)
-        {
-            next = head->next;
-            free(head);
-            head = next;
-        }
+        if (c->echo_msg.history)
+            free(c->echo_msg.history->legacy);
+        free(c->echo_msg.history);
         CLEAR(c->echo_msg);
     }
 }
@@ -399,14 +662,23 @@ OnEnLinkNotify(HWND UNUSED hwnd, ENLINK *el)
     return 0;
 }
 
-/* Add new message to the message box window */
-static void
-AddMessageBoxText(HWND hwnd, const wchar_t *text, const wchar_t *title, const wchar_t *from)
+/* Return the i'th most recent message in the store */
+static struct msg_item *
+msg_store_get(int i)
 {
-    HWND hmsg = GetDlgItem(hwnd, ID_TXT_MESSAGE);
+    return &msg_store.item[(msg_store.first + msg_store.count - 1 - i) % MAX_MSG_ITEMS];
+}
 
-    /* Start adding new message at the top */
-    SendMessage(hmsg, EM_SETSEL, 0, 0);
+/*
+ * Render a message into the edit control at character position pos.
+ * Returns the number of characters added.
+ */
+static LONG
+RenderMessage(HWND hmsg, const struct msg_item *m, LONG pos)
+{
+    CHARRANGE cr;
+
+    SendMessage(hmsg, EM_SETSEL, pos, pos);
 
     CHARFORMATW cfm = {.cbSize = sizeof(CHARFORMATW) };
 
@@ -416,7 +688,7 @@ AddMessageBoxText(HWND hwnd, const wchar_t *text, const wchar_t *title, const wc
     WORD pf_align_saved = pf.dwMask & PFM_ALIGNMENT ? pf.wAlignment : PFA_LEFT;
     pf.dwMask |= PFM_ALIGNMENT;
 
-    if (from && wcslen(from))
+    if (m->from && wcslen(m->from))
     {
         /* Change font to italics */
         SendMessage(hmsg, EM_GETCHARFORMAT, SCF_DEFAULT, (LPARAM) &cfm);
@@ -427,14 +699,14 @@ AddMessageBoxText(HWND hwnd, const wchar_t *text, const wchar_t *title, const wc
        /* Align to right */
         pf.wAlignment = PFA_RIGHT;
         SendMessage(hmsg, EM_SETPARAFORMAT, 0, (LPARAM) &pf);
-        SendMessage(hmsg, EM_REPLACESEL, FALSE, (LPARAM) from);
+        SendMessage(hmsg, EM_REPLACESEL, FALSE, (LPARAM) m->from);
         SendMessage(hmsg, EM_REPLACESEL, FALSE, (LPARAM) L"\n");
     }
 
     pf.wAlignment = PFA_LEFT;
     SendMessage(hmsg, EM_SETPARAFORMAT, 0, (LPARAM) &pf);
 
-    if (title && wcslen(title))
+    if (m->title && wcslen(m->title))
     {
         /* Increase font size and set font color for title of the message */
         SendMessage(hmsg, EM_GETCHARFORMAT, SCF_DEFAULT, (LPARAM) &cfm);
@@ -444,35 +716,149 @@ AddMessageBoxText(HWND hwnd, const wchar_t *text, const wchar_t *title, const wc
         cfm.dwEffects = 0;
 
         SendMessage(hmsg, EM_SETCHARFORMAT, SCF_SELECTION, (LPARAM) &cfm);
-        SendMessage(hmsg, EM_REPLACESEL, FALSE, (LPARAM) title);
+        SendMessage(hmsg, EM_REPLACESEL, FALSE, (LPARAM) m->title);
         SendMessage(hmsg, EM_REPLACESEL, FALSE, (LPARAM) L"\n");
     }
 
     /* Revert to default font and set the text */
     SendMessage(hmsg, EM_GETCHARFORMAT, SCF_DEFAULT, (LPARAM) &cfm);
     SendMessage(hmsg, EM_SETCHARFORMAT, SCF_SELECTION, (LPARAM) &cfm);
-    if (text)
+    if (m->text)
     {
-        SendMessage(hmsg, EM_REPLACESEL, FALSE, (LPARAM) text);
+        SendMessage(hmsg, EM_REPLACESEL, FALSE, (LPARAM) m->text);
         SendMessage(hmsg, EM_REPLACESEL, FALSE, (LPARAM) L"\n");
     }
     /* revert alignment */
     pf.wAlignment = pf_align_saved;
     SendMessage(hmsg, EM_SETPARAFORMAT, 0, (LPARAM) &pf);
 
-    /* Remove lines from the window if it is getting full
-     * We allow the window to grow by upto 50 lines beyond a
-     * max value before truncating
-     */
-    int pos2 = SendMessage(hmsg, EM_GETLINECOUNT, 0, 0);
-    if (pos2 > MAX_MSG_LINES + 50)
+    /* the caret is now at the end of the inserted text */
+    SendMessage(hmsg, EM_EXGETSEL, 0, (LPARAM) &cr);
+    return cr.cpMin - pos;
+}
+
+/* Remove the oldest rendered message from the end of the control */
+static void
+UnrenderLastMessage(HWND hmsg)
+{
+    struct msg_item *m = msg_store_get(msg_store.shown - 1);
+
+    SendMessage(hmsg, EM_SETSEL, msg_store.nchars - m->nchars, -1);
+    SendMessage(hmsg, EM_REPLACESEL, FALSE, (LPARAM) L"");
+    msg_store.nchars -= m->nchars;
+    msg_store.shown--;
+}
+
+/* Render up to limit most recent messages, replacing the current content */
+static void
+RenderMessages(HWND hwnd)
+{
+    HWND hmsg = GetDlgItem(hwnd, ID_TXT_MESSAGE);
+
+    SendMessage(hmsg, WM_SETREDRAW, FALSE, 0);
+    SetWindowText(hmsg, L"");
+    msg_store.shown = 0;
+    msg_store.nchars = 0;
+    msg_store.limit = MSG_PAGE_SIZE;
+
+    while (msg_store.shown < min(msg_store.count, msg_store.limit))
     {
-        int pos1 = SendMessage(hmsg, EM_LINEINDEX, MAX_MSG_LINES, 0);
-        SendMessage(hmsg, EM_SETSEL, pos1, -1);
-        SendMessage(hmsg, EM_REPLACESEL, FALSE, (LPARAM) _T(""));
-        PrintDebug(L"Text from character position %d to end removed", pos1);
+        struct msg_item *m = msg_store_get(msg_store.shown);
+        m->nchars = RenderMessage(hmsg, m, msg_store.nchars);
+        msg_store.nchars += m->nchars;
+        msg_store.shown++;
     }
 
+    SendMessage(hmsg, WM_SETREDRAW, TRUE, 0);
+    InvalidateRect(hmsg, NULL, TRUE);
+
+    /* Select top of the message and scroll to there */
+    SendMessage(hmsg, EM_SETSEL, 0, 0);
+    SendMessage(hmsg, EM_SCROLLCARET, 0, 0);
+}
+
+/* Render the next page of older messages if the view is scrolled to the end */
+static void
+RenderMoreIfScrolledToEnd(HWND hwnd)
+{
+    HWND hmsg = GetDlgItem(hwnd, ID_TXT_MESSAGE);
+    SCROLLINFO si = {.cbSize = sizeof(si), .fMask = SIF_ALL};
+
+    if (msg_store.shown == msg_store.count
+        || !GetScrollInfo(hmsg, SB_VERT, &si)
+        || si.nPos + (int) si.nPage < si.nMax)
+    {
+        return;
+    }
+
+    CHARRANGE cr;
+    POINT scroll_pos;
+    SendMessage(hmsg, EM_EXGETSEL, 0, (LPARAM) &cr);
+    SendMessage(hmsg, EM_GETSCROLLPOS, 0, (LPARAM) &scroll_pos);
+    SendMessage(hmsg, WM_SETREDRAW, FALSE, 0);
+
+    msg_store.limit += MSG_PAGE_SIZE;
+    while (msg_store.shown < min(msg_store.count, msg_store.limit))
+    {
+        struct msg_item *m = msg_store_get(msg_store.shown);
+        m->nchars = RenderMessage(hmsg, m, msg_store.nchars);
+        msg_store.nchars += m->nchars;
+        msg_store.shown++;
+    }
+
+    /* restore selection and scroll position */
+    SendMessage(hmsg, EM_EXSETSEL, 0, (LPARAM) &cr);
+    SendMessage(hmsg, EM_SETSCROLLPOS, 0, (LPARAM) &scroll_pos);
+    SendMessage(hmsg, WM_SETREDRAW, TRUE, 0);
+    InvalidateRect(hmsg, NULL, TRUE);
+}
+
+static void
+msg_item_free(struct msg_item *m)
+{
+    free(m->title);
+    free(m->text);
+    free(m->from);
+    CLEAR(*m);
+}
+
+/* Add new message to the store and, if the window is visible, at the top of the view */
+static void
+AddMessageBoxText(HWND hwnd, const wchar_t *text, const wchar_t *title, const wchar_t *from)
+{
+    HWND hmsg = GetDlgItem(hwnd, ID_TXT_MESSAGE);
+    BOOL visible = IsWindowVisible(hwnd);
+
+    /* Drop the oldest message when full */
+    if (msg_store.count == MAX_MSG_ITEMS)
+    {
+        if (visible && msg_store.shown == msg_store.count)
+            UnrenderLastMessage(hmsg);
+        msg_store.shown = min(msg_store.shown, msg_store.count - 1);
+        msg_item_free(&msg_store.item[msg_store.first]);
+        msg_store.first = (msg_store.first + 1) % MAX_MSG_ITEMS;
+        msg_store.count--;
+    }
+
+    struct msg_item *m = &msg_store.item[(msg_store.first + msg_store.count) % MAX_MSG_ITEMS];
+    m->title = title ? _wcsdup(title) : NULL;
+    m->text = text ? _wcsdup(text) : NULL;
+    m->from = from ? _wcsdup(from) : NULL;
+    m->nchars = 0;
+    msg_store.count++;
+
+    if (!visible)
+        return; /* rendered when the window is shown */
+
+    /* Start adding new message at the top */
+    m->nchars = RenderMessage(hmsg, m, 0);
+    msg_store.nchars += m->nchars;
+    msg_store.shown++;
+
+    /* Keep the view bounded: drop the oldest rendered one */
+    if (msg_store.shown > msg_store.limit)
+        UnrenderLastMessage(hmsg);
+
     /* Select top of the message and scroll to there */
     SendMessage(hmsg, EM_SETSEL, 0, 0);
     SendMessage(hmsg, EM_SCROLLCARET, 0, 0);
@@ -506,6 +892,10 @@ MessageDialogFunc(HWND hwnd, UINT msg, UNUSED WPARAM wParam, LPARAM lParam)
 
         enable_url_detection(hmsg);
 
+        /* Get notified of scrolling so that older messages can be rendered on demand */
+        LRESULT evmask = SendMessage(hmsg, EM_GETEVENTMASK, 0, 0);
+        SendMessage(hmsg, EM_SETEVENTMASK, 0, evmask | ENM_SCROLL | ENM_SCROLLEVENTS | ENM_KEYEVENTS);
+
         /* Position the window close to top right corner of the screen */
         RECT rc;
         GetWindowRect(hwnd, &rc);
@@ -542,9 +932,22 @@ MessageDialogFunc(HWND hwnd, UINT msg, UNUSED WPARAM wParam, LPARAM lParam)
             {
                 ShowCaret((HWND)lParam);
             }
+            else if (HIWORD(wParam) == EN_VSCROLL)
+            {
+                RenderMoreIfScrolledToEnd(hwnd);
+            }
         }
         break;
 
+    case WM_MSG_CHECK_SCROLL:
+        RenderMoreIfScrolledToEnd(hwnd);
+        break;
+
+    case WM_SHOWWINDOW:
+        if (wParam)
+            RenderMessages(hwnd);
+        break;
+
     /* Must be sent with lParam = connection pointer
      * Adds the current echo message and shows the window.
      */
@@ -566,13 +969,23 @@ MessageDialogFunc(HWND hwnd, UINT msg, UNUSED WPARAM wParam, LPARAM lParam)
 
     case WM_NOTIFY:
         nmh = (NMHDR*) lParam;
-        /* We handle only EN_LINK messages */
         if (nmh->idFrom == ID_TXT_MESSAGE && nmh->code == EN_LINK)
             return OnEnLinkNotify(hwnd, (ENLINK*)lParam);
+        if (nmh->idFrom == ID_TXT_MESSAGE && nmh->code == EN_MSGFILTER)
+        {
+            /* wheel and keyboard scrolling: check after the control has processed it */
+            UINT m = ((MSGFILTER *) lParam)->msg;
+            if (m == WM_MOUSEWHEEL || m == WM_KEYDOWN)
+                PostMessage(hwnd, WM_MSG_CHECK_SCROLL, 0, 0);
+        }
         break;
 
     case WM_CLOSE:
         ShowWindow(hwnd, SW_HIDE);
+        /* release the rendered content: it is rebuilt from the store when shown again */
+        SetWindowText(GetDlgItem(hwnd, ID_TXT_MESSAGE), L"");
+        msg_store.shown = 0;
+        msg_store.nchars = 0;
         return TRUE;
     }
 
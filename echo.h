@@ -22,25 +22,9 @@
 #ifndef ECHO_H
 #define ECHO_H
 
-#include <wchar.h>
-
-/* data structures and methods for handling echo msg */
-#define HASHLEN 20
-
-/* message finger print consists of a SHA1 hash and a timestamp */
-struct echo_msg_fp {
-    BYTE digest[HASHLEN];
-    time_t timestamp;
-};
-struct echo_msg_history;
-struct echo_msg {
-    struct echo_msg_fp fp; /* keep this as the first element */
-    wchar_t *title;
-    wchar_t *text;
-    int txtlen;
-    int type;
-    struct echo_msg_history *history;
-};
+#include "echo_text.h"
+
+/* methods for handling echo msg, its data structures are in echo_text.h */
 
 /* init echo message -- call on program start */
 void echo_msg_init();
@@ -0,0 +1,120 @@
+/*
+ *  OpenVPN-GUI -- A Windows GUI for OpenVPN.
+ *
+ *  Copyright (C) 2026 OpenVPN GUI contributors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program (see the file COPYING included with this
+ *  distribution); if not, write to the Free Software Foundation, Inc.,
+ *  59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <windows.h>
+#include <string.h>
+
+#include "main.h"
+#include "echo_hash.h"
+
+#define ROTL64(x, r) (((x) << (r)) | ((x) >> (64 - (r))))
+
+/* Mix one 64 bit word into the fingerprint hash, using the MurmurHash3 x64 128 mixing steps */
+static inline void
+echo_msg_hash_word(struct echo_msg_hash_state *hs, UINT64 k)
+{
+    const UINT64 c1 = 0x87c37b91114253d5ULL;
+    const UINT64 c2 = 0x4cf5ad432745937fULL;
+
+    UINT64 k1 = k * c1;
+    k1 = ROTL64(k1, 31) * c2;
+    hs->h1 ^= k1;
+    hs->h1 = ROTL64(hs->h1, 27) + hs->h2;
+    hs->h1 = hs->h1*5 + 0x52dce729;
+
+    UINT64 k2 = k * c2;
+    k2 = ROTL64(k2, 33) * c1;
+    hs->h2 ^= k2;
+    hs->h2 = ROTL64(hs->h2, 31) + hs->h1;
+    hs->h2 = hs->h2*5 + 0x38495ab5;
+}
+
+static inline UINT64
+echo_msg_hash_fmix(UINT64 k)
+{
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdULL;
+    k ^= k >> 33;
+    k *= 0xc4ceb9fe1a85ec53ULL;
+    k ^= k >> 33;
+    return k;
+}
+
+void
+echo_msg_hash_update(struct echo_msg_hash_state *hs, const BYTE *data, size_t size)
+{
+    if (hs->len == 0)
+    {
+        hs->h1 = 0x6f70656e76706e31ULL;
+        hs->h2 = 0x6563686f6d736731ULL;
+        hs->tail = 0;
+    }
+
+    unsigned int ntail = hs->len % 8;
+    hs->len += size;
+
+    /* complete a pending word first */
+    while (ntail && size)
+    {
+        hs->tail |= (UINT64) *data++ << (8*ntail);
+        size--;
+        if (++ntail == 8)
+        {
+            echo_msg_hash_word(hs, hs->tail);
+            hs->tail = 0;
+            ntail = 0;
+        }
+    }
+    for ( ; size >= 8; data += 8, size -= 8)
+    {
+        UINT64 k;
+        memcpy(&k, data, sizeof(k));
+        echo_msg_hash_word(hs, k);
+    }
+    for (ntail = 0; ntail < size; ntail++)
+        hs->tail |= (UINT64) data[ntail] << (8*ntail);
+}
+
+void
+echo_msg_hash_final(struct echo_msg_hash_state *hs, BYTE digest[HASHLEN])
+{
+    if (hs->len == 0)
+        echo_msg_hash_update(hs, NULL, 0);
+    if (hs->len % 8)
+        echo_msg_hash_word(hs, hs->tail);
+
+    UINT64 h1 = hs->h1 ^ hs->len;
+    UINT64 h2 = hs->h2 ^ hs->len;
+    h1 += h2;
+    h2 += h1;
+    h1 = echo_msg_hash_fmix(h1);
+    h2 = echo_msg_hash_fmix(h2);
+    h1 += h2;
+    h2 += h1;
+
+    memcpy(digest, &h1, sizeof(h1));
+    memcpy(digest + sizeof(h1), &h2, sizeof(h2));
+    CLEAR(*hs);
+}
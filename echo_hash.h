@@ -0,0 +1,52 @@
+/*
+ *  OpenVPN-GUI -- A Windows GUI for OpenVPN.
+ *
+ *  Copyright (C) 2026 OpenVPN GUI contributors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program (see the file COPYING included with this
+ *  distribution); if not, write to the Free Software Foundation, Inc.,
+ *  59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ECHO_HASH_H
+#define ECHO_HASH_H
+
+/*
+ * Fingerprint hash of echo messages. Uses no Windows API beyond basic
+ * types so that it can be tested on any host (see tests/).
+ */
+
+#include <windows.h>
+
+#define HASHLEN 16
+
+/* state of the incremental fingerprint hash */
+struct echo_msg_hash_state {
+    UINT64 h1;
+    UINT64 h2;
+    UINT64 tail;           /* bytes not yet mixed in: len%8 of them */
+    UINT64 len;            /* total number of bytes hashed */
+};
+
+/*
+ * Add data to the fingerprint hash. This is a fast non-cryptographic
+ * hash but with a fixed seed, so it is stable across runs and can be
+ * persisted. A zeroed state starts a new hash.
+ */
+void echo_msg_hash_update(struct echo_msg_hash_state *hs, const BYTE *data, size_t size);
+
+/* Write the 128 bit digest of the data added so far and reset the state */
+void echo_msg_hash_final(struct echo_msg_hash_state *hs, BYTE digest[HASHLEN]);
+
+#endif
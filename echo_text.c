@@ -0,0 +1,74 @@
+/*
+ *  OpenVPN-GUI -- A Windows GUI for OpenVPN.
+ *
+ *  Copyright (C) 2026 OpenVPN GUI contributors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program (see the file COPYING included with this
+ *  distribution); if not, write to the Free Software Foundation, Inc.,
+ *  59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <windows.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "main.h"
+#include "echo_text.h"
+
+BOOL
+echo_msg_reserve(struct echo_msg *msg, size_t len)
+{
+    if (msg->txtlen + len <= (size_t) msg->txtsize)
+        return true;
+
+    /* grow geometrically to keep the total cost of appending linear */
+    size_t size = max(2*(size_t) msg->txtsize, msg->txtlen + len);
+    size = max(size, 256);
+    if (size > INT_MAX)
+        return false;
+    WCHAR *s = realloc(msg->text, size*sizeof(WCHAR));
+    if (!s)
+        return false;
+    msg->text = s;
+    msg->txtsize = (int) size;
+    return true;
+}
+
+int
+echo_msg_append_text(struct echo_msg *msg, const char *line, BOOL addnl)
+{
+    /* UTF-8 never converts to more UTF-16 units than its length in bytes */
+    size_t len = strlen(line) + 3; /* room for \r\n and null terminator */
+
+    if (!echo_msg_reserve(msg, len))
+        return -1;
+
+    WCHAR *s = msg->text + msg->txtlen;
+    int n = MultiByteToWideChar(CP_UTF8, 0, line, -1, s, (int) len) - 1; /* exclude null terminator */
+    if (n < 0)
+        return -2;
+    if (addnl)
+    {
+        s[n++] = L'\r';
+        s[n++] = L'\n';
+    }
+    s[n] = L'\0';
+    msg->txtlen += n;
+    return n;
+}
@@ -0,0 +1,67 @@
+/*
+ *  OpenVPN-GUI -- A Windows GUI for OpenVPN.
+ *
+ *  Copyright (C) 2026 OpenVPN GUI contributors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program (see the file COPYING included with this
+ *  distribution); if not, write to the Free Software Foundation, Inc.,
+ *  59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ECHO_TEXT_H
+#define ECHO_TEXT_H
+
+/*
+ * Echo message data and the accumulation of its text. Uses no Windows
+ * API beyond basic types and UTF-8 conversion so that it can be tested
+ * on any host (see tests/).
+ */
+
+#include <windows.h>
+#include <wchar.h>
+#include <time.h>
+
+#include "echo_hash.h"
+
+/* message finger print consists of a 128 bit hash and a timestamp */
+struct echo_msg_fp {
+    BYTE digest[HASHLEN];
+    time_t timestamp;
+};
+
+struct echo_msg_history;
+struct md_ctx;
+struct echo_msg {
+    struct echo_msg_fp fp; /* keep this as the first element */
+    wchar_t *title;
+    wchar_t *text;
+    int txtlen;
+    int txtsize;           /* allocated size of text in wide chars */
+    struct echo_msg_hash_state hash; /* fingerprint of text being accumulated */
+    struct md_ctx *md;     /* SHA1 of the text, only while legacy history is in use */
+    int type;
+    struct echo_msg_history *history;
+};
+
+/* Make room for at least len more wide chars in the message text */
+BOOL echo_msg_reserve(struct echo_msg *msg, size_t len);
+
+/*
+ * Append a line of UTF-8 text to the message, followed by \r\n if
+ * addnl is true. Returns the number of wide chars appended, -1 if out
+ * of memory or -2 if the text could not be converted.
+ */
+int echo_msg_append_text(struct echo_msg *msg, const char *line, BOOL addnl);
+
+#endif
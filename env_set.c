@@ -31,11 +31,22 @@
 #include "openvpn.h"
 #include "env_set.h"
 
-struct env_item {
-    wchar_t *nameval;
-    struct env_item *next;
+/*
+ * The env set is an array of name=val strings kept sorted by name,
+ * along with the env block made by merging it with the process env.
+ * The block is rebuilt only when the set or the process env changes.
+ */
+struct env_set {
+    wchar_t **items;
+    size_t count;
+    size_t size;            /* allocated length of items[] */
+    wchar_t *block;         /* cached merged env block or NULL */
+    LONG block_gen;         /* process env generation the block was made from */
 };
 
+/* Incremented whenever this process changes its own environment */
+static volatile LONG process_env_gen;
+
 /* To match with openvpn we accept only :ALPHA:, :DIGIT: or '_' in names */
 BOOL
 is_valid_env_name(const char *name)
@@ -78,167 +89,169 @@ env_name_compare(const wchar_t *nameval1, const wchar_t *nameval2)
     return cmp - 2; /* -2 to bring the result match strcmp semantics */
 }
 
+/* Invalidate the cached env block */
 static void
-env_item_free(struct env_item *item)
+env_set_changed(struct env_set *es)
 {
-    free(item->nameval);
-    free(item);
+    free(es->block);
+    es->block = NULL;
 }
 
-/* Delete an env var item with matching name: if name is of the
- * form xxx=yyy, only the part xxx is used for matching.
- * Returns the head of the list.
+/*
+ * Find the position of name in the env set by binary search: if name is
+ * of the form xxx=yyy, only the part xxx is used for matching.
+ * Returns true if found. In either case *pos is set to the index of the
+ * matching item or the index at which it should be inserted.
  */
-static struct env_item *
-env_item_del(struct env_item *head, const wchar_t *name)
+static BOOL
+env_set_find(const struct env_set *es, const wchar_t *name, size_t *pos)
 {
-    struct env_item *item, *prev = NULL;
-
-    if (!name) return head;
+    size_t lo = 0, hi = es->count;
 
-    for (item = head; item; item = item->next)
+    while (lo < hi)
     {
-        if (env_name_compare(name, item->nameval) == 0)
+        size_t mid = lo + (hi - lo)/2;
+        int cmp = env_name_compare(name, es->items[mid]);
+        if (cmp == 0)
         {
-            /* matching item found */
-            if (prev)
-                prev->next = item->next;
-            else /* head is going to be deleted */
-                head = item->next;
-            env_item_free(item);
-            break;
+            *pos = mid;
+            return true;
         }
-        prev = item;
-        continue;
+        else if (cmp < 0)
+            hi = mid;
+        else
+            lo = mid + 1;
     }
+    *pos = lo;
+    return false;
+}
 
-    return head;
+/* Delete an env var item with matching name: if name is of the
+ * form xxx=yyy, only the part xxx is used for matching.
+ */
+static void
+env_set_del(struct env_set *es, const wchar_t *name)
+{
+    size_t pos;
+
+    if (!es || !name || !env_set_find(es, name, &pos))
+        return;
+
+    free(es->items[pos]);
+    memmove(&es->items[pos], &es->items[pos+1], (es->count - pos - 1)*sizeof(es->items[0]));
+    es->count--;
+    env_set_changed(es);
 }
 
-/* Insert a env var item to an env set: any existing item
- * with same name is replaced by the new entry. Else
- * the item is added at an alphabetically sorted location.
- * Returns the new head of the list.
+/* Insert a name=val string to an env set taking ownership of it:
+ * any existing item with same name is replaced by the new entry.
+ * Else the item is added at an alphabetically sorted location.
+ * Returns false on error in which case nameval is freed.
  */
-struct env_item *
-env_item_insert(struct env_item *head, struct env_item *item)
+static BOOL
+env_set_insert(struct env_set *es, wchar_t *nameval)
 {
-    struct env_item *tmp, *prev = NULL;
-    int cmp = -1;
+    size_t pos;
 
-    /* find location of new item in sorted order: head == NULL is ok */
-    for (tmp = head; tmp; tmp = tmp->next)
-    {
-        cmp = env_name_compare(item->nameval, tmp->nameval);
-        if (cmp <= 0) /* found the position to add */
-        {
-             break;
-        }
-        prev = tmp;
-        continue;
-    }
-    if (cmp == 0) /* name already set -- replace */
+    if (env_set_find(es, nameval, &pos)) /* name already set -- replace */
     {
-        item->next = tmp->next;
-        env_item_free(tmp);
+        free(es->items[pos]);
+        es->items[pos] = nameval;
     }
-    else /* add item at this point */
+    else
     {
-        item->next = tmp;
+        if (es->count == es->size)
+        {
+            size_t size = es->size ? 2*es->size : 16;
+            wchar_t **tmp = realloc(es->items, size*sizeof(es->items[0]));
+            if (!tmp)
+            {
+                free(nameval);
+                return false;
+            }
+            es->items = tmp;
+            es->size = size;
+        }
+        memmove(&es->items[pos+1], &es->items[pos], (es->count - pos)*sizeof(es->items[0]));
+        es->items[pos] = nameval;
+        es->count++;
     }
-
-    if (prev)
-        prev->next = item;
-    else
-        head = item;
-
-    return head;
+    env_set_changed(es);
+    return true;
 }
 
 void
-env_item_del_all(struct env_item *head)
+env_set_free(struct env_set *es)
 {
-    struct env_item *next;
-    for ( ; head; head = next)
-    {
-        next = head->next;
-        env_item_free(head);
-    }
+    if (!es)
+        return;
+    for (size_t i = 0; i < es->count; i++)
+        free(es->items[i]);
+    free(es->items);
+    free(es->block);
+    free(es);
 }
 
-/* convenience functions for create, add and delete an item
+/* convenience functions for add and delete an item
  * given nameval as a utf8 string.
  */
 
-/* Create a new env item given nameval name=val */
-struct env_item *
-env_item_new_utf8(const char *nameval)
+/* Insert an env item to the set given nameval: name=val.
+ * The set is created if es is NULL. Returns the set.
+ */
+static struct env_set *
+env_set_insert_utf8(struct env_set *es, const char *nameval)
 {
-    struct env_item *new = malloc(sizeof(struct env_item));
+    wchar_t *wnameval = Widen(nameval);
 
-    if (!new)
-    {
-        return NULL;
-    }
-    new->nameval = Widen(nameval);
-    new->next = NULL;
+    if (!wnameval)
+        return es;
 
-    if (!new->nameval)
+    if (!es && !(es = calloc(1, sizeof(*es))))
     {
-        free(new);
-        return NULL;
+        free(wnameval);
+        return es;
     }
-    return new;
+    env_set_insert(es, wnameval);
+    return es;
 }
 
-/* Insert an env item to the set given nameval: name=val.
- * Returns new head of the list.
+/* Delete an env item from the set with matching name. If name is
+ * given as name=val, only the name part is used for matching.
  */
-static struct env_item*
-env_item_insert_utf8(struct env_item *head, const char *nameval)
+static void
+env_set_del_utf8(struct env_set *es, const char *name)
 {
-    struct env_item *item = env_item_new_utf8(nameval);
-
-    if (!item)
-        return head;
+    widebuf_t wname;
 
-    return env_item_insert(head, item);
+    if (WidenBuf(&wname, CP_UTF8, name))
+    {
+        env_set_del(es, wname.str);
+        FreeWidebuf(&wname);
+    }
 }
 
-/* Delete an env item from the list with matching name. Returns the
- * new head of the list. If name is given as name=val, only the
- * name part is used for matching.
- */
-static struct env_item *
-env_item_del_utf8(struct env_item *head, const char *name)
+void
+env_process_changed(void)
 {
-    wchar_t *wname = Widen(name);
-
-    if (wname)
-    {
-        head = env_item_del(head, wname);
-        free(wname);
-    }
-    return head;
+    InterlockedIncrement(&process_env_gen);
 }
 
 /*
  * Make an env block by merging items in es to the process env block
  * retaining alphabetical order as necessary on Windows.
- * Returns NULL on error or a newly allocated string that may be passed
- * to CreateProcess as the env block. The caller must free the returned
- * pointer.
+ * Returns NULL on error or a newly allocated string.
  */
-wchar_t *
-merge_env_block(const struct env_item *es)
+static wchar_t *
+merge_env_block(const struct env_set *es)
 {
     size_t len = 0;
     /* e should be treated as read-only though cannot be defined as const
      * due to the need to call FreeEnvironmentStrings in the end.
      */
     wchar_t *e = GetEnvironmentStringsW();
-    const struct env_item *item;
     const wchar_t *pe;
+    size_t i;
 
     if (!e)
     {
@@ -251,9 +264,9 @@ merge_env_block(const struct env_item *es)
     }
     len = (pe + 1 - e); /* including the extra '\0' at the end */
 
-    for(item = es; item; item = item->next)
+    for (i = 0; i < es->count; i++)
     {
-        len += wcslen(item->nameval) + 1;
+        len += wcslen(es->items[i]) + 1;
     }
 
     wchar_t *env = malloc(sizeof(wchar_t)*len);
@@ -265,7 +278,7 @@ merge_env_block(const struct env_item *es)
     }
 
     wchar_t *p = env;
-    item = es;
+    i = 0;
     pe = e;
     len = wcslen(pe) + 1;
 
@@ -273,18 +286,19 @@ merge_env_block(const struct env_item *es)
      * In case of duplicates the env set entry replaces that in the
      * process env.
      */
-    while (item && *pe)
+    while (i < es->count && *pe)
     {
-        int cmp = env_name_compare(item->nameval, pe);
+        int cmp = env_name_compare(es->items[i], pe);
         if (cmp <= 0) /* add entry from env set */
         {
-            wcscpy(p, item->nameval);
-            p += wcslen(item->nameval) + 1;
-            item = item->next;
+            size_t n = wcslen(es->items[i]) + 1;
+            memcpy(p, es->items[i], n*sizeof(wchar_t));
+            p += n;
+            i++;
         }
         else  /* add entry from process env */
         {
-            wcscpy(p, pe);
+            memcpy(p, pe, len*sizeof(wchar_t));
             p += len;
         }
         if (cmp >= 0) /* pe was added (cmp >0) or has to be skipped (cmp==0) */
@@ -294,18 +308,19 @@ merge_env_block(const struct env_item *es)
                 len = wcslen(pe) + 1;
         }
     }
-    /* Add any remaining entries -- either item or *pe is NULL at this point.
+    /* Add any remaining entries -- either i == count or *pe is NULL at this point.
      * So only one of the two following loops will run.
      */
-    for ( ; item; item = item->next)
+    for ( ; i < es->count; i++)
     {
-        wcscpy(p, item->nameval);
-        p += wcslen(item->nameval) + 1;
+        size_t n = wcslen(es->items[i]) + 1;
+        memcpy(p, es->items[i], n*sizeof(wchar_t));
+        p += n;
     }
     for ( ; *pe; pe += len, p += len)
     {
-        wcscpy(p, pe);
         len = wcslen(pe) + 1;
+        memcpy(p, pe, len*sizeof(wchar_t));
     }
     *p = L'\0';
 
@@ -314,6 +329,22 @@ merge_env_block(const struct env_item *es)
     return env;
 }
 
+const wchar_t *
+get_env_block(struct env_set *es)
+{
+    if (!es || es->count == 0)
+        return NULL;
+
+    LONG gen = process_env_gen;
+    if (es->block && es->block_gen == gen)
+        return es->block;
+
+    free(es->block);
+    es->block = merge_env_block(es);
+    es->block_gen = gen;
+    return es->block;
+}
+
 /* Expect "setenv name value" and add name=value
  * to a private env set with name prefixed by OPENVPN_.
  * If value is missing we delete name from the env set.
@@ -352,7 +383,7 @@ process_setenv(connection_t *c, UNUSED time_t timestamp, const char *msg)
         if (is_valid_env_name(nameval))
         {
             *p = '=';
-            c->es = env_item_insert_utf8(c->es, nameval);
+            c->es = env_set_insert_utf8(c->es, nameval);
         }
         else
         {
@@ -363,7 +394,7 @@ process_setenv(connection_t *c, UNUSED time_t timestamp, const char *msg)
     /* if only name is specified and valid, delete the value from env set */
     else if (is_valid_env_name(nameval))
     {
-        c->es = env_item_del_utf8(c->es, nameval);
+        env_set_del_utf8(c->es, nameval);
     }
-    free(nameval); /* env_item keeps a private wide string copy */
+    free(nameval); /* env set keeps a private wide string copy */
 }
@@ -28,19 +28,27 @@
 /*
  * data structures and methods for config specific env set and echo setenv
  */
-struct env_item;
+struct env_set;
 /* free all env set resources -- to be called when a connection thread exits */
-void env_item_del_all(struct env_item *head);
+void env_set_free(struct env_set *es);
 /* parse setenv name val to add name=val to the connection env set */
 void process_setenv(connection_t *c, time_t timestamp, const char *msg);
 
 /**
- * Make an env block by merging items in es to the process env block
- * retaining alphabetical order as necessary on Windows.
- * Returns a newly allocated string that may be passed to CreateProcess
- * as the env block or NULL on error. The caller must free the returned
- * pointer.
+ * Get an env block made by merging items in es to the process env block
+ * retaining alphabetical order as necessary on Windows. The result
+ * may be passed to CreateProcess as the env block. Returns NULL if es
+ * is empty or on error.
+ * The block is cached in es and remains valid until es is modified or
+ * freed: the caller must not free it.
  */
-wchar_t * merge_env_block(const struct env_item *es);
+const wchar_t *get_env_block(struct env_set *es);
+
+/**
+ * Notify that the environment of this process has been changed so that
+ * env blocks merged from the old one are not reused. Must be called
+ * after any SetEnvironmentVariable or _wputenv by the GUI.
+ */
+void env_process_changed(void);
 
 #endif
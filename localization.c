@@ -41,9 +41,40 @@
 
 extern options_t o;
 
+#ifdef _MSC_VER
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL __thread
+#endif
+
 static const LANGID fallbackLangId = MAKELANGID(LANG_ENGLISH, SUBLANG_DEFAULT);
 static LANGID gui_language;
 
+/*
+ * Index of the string table in the GUI language. String resources are
+ * stored in blocks of 16 length-prefixed entries. A block is resolved,
+ * with missing entries taken from the fallback language, and copied as
+ * nul-terminated strings on first use. Blocks and the index are
+ * published with atomic compare-exchange, so lookups only need the lock
+ * shared. A language switch takes it exclusive to free the index.
+ */
+#define STRING_BLOCKS 256 /* covers string ids up to 4095 */
+
+struct string_block {
+    const WCHAR *str[16];   /* NULL if the string does not exist */
+    WCHAR data[];
+};
+
+struct string_index {
+    LANGID lang;
+    struct string_block *volatile block[STRING_BLOCKS];
+};
+
+static struct string_index *volatile string_index;
+static SRWLOCK string_index_lock = SRWLOCK_INIT;
+
+static void FreeStringIndex(void);
+
 static HRSRC
 FindResourceLang(PTSTR resType, PTSTR resId, LANGID langId)
 {
@@ -99,7 +130,12 @@ SetGUILanguage(LANGID langId)
 
     SetRegistryValueNumeric(regkey, _T("ui_language"), langId);
     InitMUILanguage(langId);
+
+    AcquireSRWLockExclusive(&string_index_lock);
     gui_language = langId;
+    FreeStringIndex();
+    ReleaseSRWLockExclusive(&string_index_lock);
+    ClearIconCache();
 }
 
 static int
@@ -221,12 +257,170 @@ err:
 }
 
 
+/* Find the non-empty entries of a string block in the given language */
+static void
+FindStringBlockEntries(UINT blockId, LANGID langId, PWCH entry[16])
+{
+    HRSRC res = FindResourceLang(RT_STRING, MAKEINTRESOURCE(blockId + 1), langId);
+    if (res == NULL)
+        return;
+
+    PWCH p = (PWCH) LoadResource(o.hInstance, res);
+    if (p == NULL)
+        return;
+
+    for (int i = 0; i < 16; p += *p + 1, i++)
+    {
+        if (*p != 0)
+            entry[i] = p;
+    }
+}
+
+static struct string_block *
+LoadStringBlock(UINT blockId, LANGID langId)
+{
+    PWCH entry[16] = {0};
+    size_t len = 0;
+
+    FindStringBlockEntries(blockId, langId, entry);
+    if (langId != fallbackLangId)
+    {
+        PWCH fallback[16] = {0};
+        FindStringBlockEntries(blockId, fallbackLangId, fallback);
+        for (int i = 0; i < 16; i++)
+        {
+            if (!entry[i])
+                entry[i] = fallback[i];
+        }
+    }
+
+    for (int i = 0; i < 16; i++)
+    {
+        if (entry[i])
+            len += *entry[i] + 1;
+    }
+
+    struct string_block *block = calloc(1, sizeof(*block) + len * sizeof(WCHAR));
+    if (block == NULL)
+        return NULL;
+
+    WCHAR *p = block->data;
+    for (int i = 0; i < 16; i++)
+    {
+        if (!entry[i])
+            continue;
+        wcsncpy(p, entry[i] + 1, *entry[i]);
+        p[*entry[i]] = 0;
+        block->str[i] = p;
+        p += *entry[i] + 1;
+    }
+    return block;
+}
+
+/*
+ * Return the index for the given language, creating it if required.
+ * Caller must hold string_index_lock shared. The language only changes
+ * under the exclusive lock, which also frees the index, so an existing
+ * index is always for the current language.
+ */
+static struct string_index *
+GetStringIndex(LANGID langId)
+{
+    struct string_index *index = string_index;
+    if (index)
+        return index->lang == langId ? index : NULL;
+
+    struct string_index *new = calloc(1, sizeof(*new));
+    if (new == NULL)
+        return NULL;
+    new->lang = langId;
+
+    index = InterlockedCompareExchangePointer((PVOID *) &string_index, new, NULL);
+    if (index)
+    {
+        free(new);
+        return index->lang == langId ? index : NULL;
+    }
+    return new;
+}
+
+/* Free the string table index. Caller must hold string_index_lock exclusive. */
+static void
+FreeStringIndex(void)
+{
+    struct string_index *index = string_index;
+    if (index == NULL)
+        return;
+
+    string_index = NULL;
+    for (int i = 0; i < STRING_BLOCKS; i++)
+        free(index->block[i]);
+    free(index);
+}
+
+/*
+ * Return the format string for stringId in the GUI language. Sets
+ * *found to false if the string table index cannot be used.
+ */
+static const WCHAR *
+GetIndexedString(UINT stringId, LANGID langId, BOOL *found)
+{
+    UINT blockId = stringId / 16;
+    struct string_index *index;
+
+    *found = FALSE;
+    if (blockId >= STRING_BLOCKS || (index = GetStringIndex(langId)) == NULL)
+        return NULL;
+
+    struct string_block *block = index->block[blockId];
+    if (block == NULL)
+    {
+        block = LoadStringBlock(blockId, langId);
+        if (block == NULL)
+            return NULL;
+        struct string_block *old = InterlockedCompareExchangePointer((PVOID *) &index->block[blockId], block, NULL);
+        if (old)
+        {
+            free(block);
+            block = old;
+        }
+    }
+    *found = TRUE;
+    return block->str[stringId & 15];
+}
+
+static int
+FormatLocalizedString(UINT stringId, PTSTR buffer, int bufferSize, va_list args)
+{
+    BOOL found;
+    int len = 0;
+
+    /* Held until the format string is no longer used */
+    AcquireSRWLockShared(&string_index_lock);
+    LANGID langId = GetGUILanguage();
+    const WCHAR *format = GetIndexedString(stringId, langId, &found);
+
+    if (!found)
+    {
+        len = LoadStringLang(stringId, langId, buffer, bufferSize, args);
+    }
+    else if (format != NULL)
+    {
+        _vsntprintf(buffer, bufferSize, format, args);
+        buffer[bufferSize - 1] = 0;
+        len = _tcslen(buffer);
+    }
+    ReleaseSRWLockShared(&string_index_lock);
+    return len;
+}
+
+/* Returns a per-thread buffer, valid until the next call from the same thread */
 static PTSTR
 __LoadLocalizedString(const UINT stringId, va_list args)
 {
-    static TCHAR msg[512];
+    static THREAD_LOCAL TCHAR msg[512];
     msg[0] = 0;
-    LoadStringLang(stringId, GetGUILanguage(), msg, _countof(msg), args);
+    FormatLocalizedString(stringId, msg, _countof(msg), args);
     return msg;
 }
 
@@ -247,7 +441,7 @@ LoadLocalizedStringBuf(PTSTR buffer, int bufferSize, const UINT stringId, ...)
 {
     va_list args;
     va_start(args, stringId);
-    int len = LoadStringLang(stringId, GetGUILanguage(), buffer, bufferSize, args);
+    int len = FormatLocalizedString(stringId, buffer, bufferSize, args);
     va_end(args);
     return len;
 }
@@ -281,11 +475,76 @@ ShowLocalizedMsg(const UINT stringId, ...)
     va_end(args);
 }
 
-HICON
-LoadLocalizedIconEx(const UINT iconId, int cxDesired, int cyDesired)
+/*
+ * Icons returned by LoadLocalizedIconEx, keyed by everything that may
+ * select a different image. Icons are loaded with LR_SHARED and owned
+ * by the system, so entries are dropped, never destroyed.
+ */
+#define ICON_CACHE_SIZE 32
+
+struct icon_cache_entry {
+    UINT id;
+    LANGID lang;
+    int cx;
+    int cy;
+    UINT dpi_scale;
+    HICON icon;
+};
+
+static SRWLOCK icon_cache_lock = SRWLOCK_INIT;
+static struct icon_cache_entry icon_cache[ICON_CACHE_SIZE];
+static int icon_cache_count;
+static int icon_cache_next; /* entry to replace when full */
+
+static HICON
+IconCacheLookup(const struct icon_cache_entry *key)
 {
-    LANGID langId = GetGUILanguage();
+    HICON icon = NULL;
+
+    AcquireSRWLockShared(&icon_cache_lock);
+    for (int i = 0; i < icon_cache_count; i++)
+    {
+        const struct icon_cache_entry *e = &icon_cache[i];
+        if (e->id == key->id && e->lang == key->lang && e->cx == key->cx
+            && e->cy == key->cy && e->dpi_scale == key->dpi_scale)
+        {
+            icon = e->icon;
+            break;
+        }
+    }
+    ReleaseSRWLockShared(&icon_cache_lock);
+    return icon;
+}
+
+static void
+IconCacheAdd(const struct icon_cache_entry *entry)
+{
+    AcquireSRWLockExclusive(&icon_cache_lock);
+    if (icon_cache_count < ICON_CACHE_SIZE)
+    {
+        icon_cache[icon_cache_count++] = *entry;
+    }
+    else
+    {
+        icon_cache[icon_cache_next] = *entry;
+        icon_cache_next = (icon_cache_next + 1) % ICON_CACHE_SIZE;
+    }
+    ReleaseSRWLockExclusive(&icon_cache_lock);
+}
 
+/* Forget all cached icons: call when the GUI language or DPI changes */
+void
+ClearIconCache(void)
+{
+    AcquireSRWLockExclusive(&icon_cache_lock);
+    icon_cache_count = 0;
+    icon_cache_next = 0;
+    ReleaseSRWLockExclusive(&icon_cache_lock);
+}
+
+static HICON
+LoadLocalizedIconUncached(const UINT iconId, int cxDesired, int cyDesired, LANGID langId)
+{
     HICON hIcon =
             (HICON) LoadImage (o.hInstance, MAKEINTRESOURCE(iconId),
                     IMAGE_ICON, cxDesired, cyDesired, LR_DEFAULTSIZE|LR_SHARED);
@@ -329,6 +588,27 @@ LoadLocalizedIconEx(const UINT iconId, int cxDesired, int cyDesired)
     return hIcon;
 }
 
+HICON
+LoadLocalizedIconEx(const UINT iconId, int cxDesired, int cyDesired)
+{
+    struct icon_cache_entry entry = {
+        .id = iconId,
+        .lang = GetGUILanguage(),
+        .cx = cxDesired,
+        .cy = cyDesired,
+        .dpi_scale = o.dpi_scale
+    };
+
+    entry.icon = IconCacheLookup(&entry);
+    if (entry.icon)
+        return entry.icon;
+
+    entry.icon = LoadLocalizedIconUncached(iconId, cxDesired, cyDesired, entry.lang);
+    if (entry.icon)
+        IconCacheAdd(&entry);
+    return entry.icon;
+}
+
 HICON
 LoadLocalizedIcon(const UINT iconId)
 {
@@ -396,7 +676,7 @@ CreateLocalizedDialog(const UINT dialogId, DLGPROC dialogFunc)
 static PTSTR
 LangListEntry(const UINT stringId, const LANGID langId, ...)
 {
-    static TCHAR str[128];
+    static THREAD_LOCAL TCHAR str[128];
     va_list args;
 
     va_start(args, langId);
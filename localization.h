@@ -31,6 +31,7 @@ int ShowLocalizedMsgEx(const UINT, HANDLE, LPCTSTR, const UINT, ...);
 HICON LoadLocalizedIconEx(const UINT, int cx, int cy);
 HICON LoadLocalizedIcon(const UINT);
 HICON LoadLocalizedSmallIcon(const UINT);
+void ClearIconCache(void);
 LPCDLGTEMPLATE LocalizedDialogResource(const UINT);
 INT_PTR LocalizedDialogBoxParam(const UINT, DLGPROC, const LPARAM);
 HWND CreateLocalizedDialogParam(const UINT, DLGPROC, const LPARAM);
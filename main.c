@@ -51,6 +51,11 @@
 #include "save_pass.h"
 #include "echo.h"
 #include "as.h"
+#include "metrics.h"
+#include "trace.h"
+#include "replay.h"
+#include "quickconnect.h"
+#include "scheduler.h"
 
 #ifndef DISABLE_CHANGE_PASSWORD
 #include <openssl/crypto.h>
@@ -77,6 +82,108 @@ options_t o;
 /* Workaround for ASLR on Windows */
 __declspec(dllexport) char aslr_workaround;
 
+/* Durations of startup phases, reported if --profile_startup is given */
+static struct {
+    LARGE_INTEGER freq;
+    LARGE_INTEGER start;
+    LARGE_INTEGER mark;
+    WCHAR report[1024];
+    size_t len;
+    double tray_msec;       /* time from start until the tray icon is shown */
+} startup;
+
+/* Background part of the initialization, see EarlyInitStart() */
+static struct {
+    HANDLE thread;
+    double msec;
+    BOOL version_cached;    /* the version was read from the cache, not probed */
+} early_init;
+
+static double
+StartupMsec(LARGE_INTEGER from, LARGE_INTEGER to)
+{
+    return (to.QuadPart - from.QuadPart) * 1000.0 / startup.freq.QuadPart;
+}
+
+/* Record the time since the previous mark as the duration of phase name */
+static void
+StartupMark(const WCHAR *name)
+{
+    LARGE_INTEGER now;
+
+    QueryPerformanceCounter(&now);
+    if (startup.freq.QuadPart == 0)
+    {
+        QueryPerformanceFrequency(&startup.freq);
+        startup.start = startup.mark = now;
+    }
+    if (name && startup.len < _countof(startup.report))
+    {
+        int n = _snwprintf(startup.report + startup.len, _countof(startup.report) - startup.len,
+                           L"\n  %ls: %.1f", name, StartupMsec(startup.mark, now));
+        startup.len = (n < 0) ? _countof(startup.report) : startup.len + n;
+    }
+    startup.mark = now;
+}
+
+static void
+StartupReport(void)
+{
+    startup.report[_countof(startup.report)-1] = L'\0';
+    MsgToEventLog(EVENTLOG_INFORMATION_TYPE, L"Startup profile (msec) with %d configs:%ls\n"
+                  L"  version %ls and OpenSSL init (background): %.1f\n"
+                  L"  time to tray icon: %.1f\n  total: %.1f",
+                  o.num_configs, startup.report, early_init.version_cached ? L"from cache" : L"probe",
+                  early_init.msec, startup.tray_msec, StartupMsec(startup.start, startup.mark));
+}
+
+/* Determine the OpenVPN version and initialize OpenSSL: neither
+ * is required to show the tray icon.
+ */
+static DWORD WINAPI
+EarlyInitThread(UNUSED void *arg)
+{
+    LARGE_INTEGER from, to;
+    BOOL ok;
+
+    QueryPerformanceCounter(&from);
+    ok = CheckVersion(&early_init.version_cached);
+
+#ifndef DISABLE_CHANGE_PASSWORD
+    /* Initialize OpenSSL */
+    OPENSSL_init_crypto(OPENSSL_INIT_LOAD_CONFIG, NULL);
+#endif
+
+    QueryPerformanceCounter(&to);
+    early_init.msec = StartupMsec(from, to);
+    return ok;
+}
+
+static void
+EarlyInitStart(void)
+{
+#ifndef DISABLE_CHANGE_PASSWORD
+    set_openssl_env_vars(); /* changes the environment: not to be done on another thread */
+#endif
+    early_init.thread = CreateThread(NULL, 0, EarlyInitThread, NULL, 0, NULL);
+}
+
+/* Wait for EarlyInitThread. Returns false if the version check failed */
+static BOOL
+EarlyInitDone(void)
+{
+    DWORD ok = FALSE;
+
+    if (!early_init.thread)
+        return EarlyInitThread(NULL);
+
+    WaitForSingleObject(early_init.thread, INFINITE);
+    GetExitCodeThread(early_init.thread, &ok);
+    CloseHandle(early_init.thread);
+    early_init.thread = NULL;
+    return ok;
+}
+
 static int
 VerifyAutoConnections()
 {
@@ -166,6 +273,7 @@ int WINAPI _tWinMain (HINSTANCE hThisInstance,
   /* a session local semaphore to detect second instance */
   HANDLE session_semaphore = InitSemaphore(L"Local\\"PACKAGE_NAME);
 
+  StartupMark(NULL);
   srand(time(NULL));
   /* try to lock the semaphore, else we are not the first instance */
   if (session_semaphore &&
@@ -234,6 +342,7 @@ int WINAPI _tWinMain (HINSTANCE hThisInstance,
 #ifdef DEBUG
   PrintDebug(_T("Shell32.dll version: 0x%lx"), shell32_version);
 #endif
+  StartupMark(L"libraries");
 
   if (first_instance)
       UpdateRegistry(); /* Checks version change and update keys/values */
@@ -241,6 +350,7 @@ int WINAPI _tWinMain (HINSTANCE hThisInstance,
   GetRegistryKeys();
   /* Parse command-line options */
   ProcessCommandLine(&o, GetCommandLine());
+  StartupMark(L"registry and options");
 
   EnsureDirExists(o.config_dir);
 
@@ -263,9 +373,11 @@ int WINAPI _tWinMain (HINSTANCE hThisInstance,
       exit(OVPN_EXITCODE_ERROR);
   }
 
-  if (!CheckVersion()) {
-    exit(1);
-  }
+  if (o.trace)
+    trace_start();
+
+  /* Version check and OpenSSL init run in the background until DeferredInit() */
+  EarlyInitStart();
 
   if (!EnsureDirExists(o.log_dir))
   {
@@ -273,25 +385,17 @@ int WINAPI _tWinMain (HINSTANCE hThisInstance,
     exit(1);
   }
 
-  BOOL use_iservice = (o.iservice_admin && IsWindows7OrGreater()) || !IsUserAdmin();
-  if (use_iservice && strtod(o.ovpn_version, NULL) > 2.3 && !o.silent_connection)
-    CheckIServiceStatus(TRUE);
+  /* Required before the scan: persistent configs are listed only if the service is running */
+  CheckServiceStatus();
+  StartupMark(L"service status");
 
-  CheckServiceStatus();	/* Check if automatic service is running or not */
   BuildFileList();
+  StartupMark(L"config scan");
 
   if (!VerifyAutoConnections()) {
     exit(1);
   }
 
-  GetProxyRegistrySettings();
-
-#ifndef DISABLE_CHANGE_PASSWORD
-  /* Initialize OpenSSL */
-  set_openssl_env_vars();
-  OPENSSL_init_crypto(OPENSSL_INIT_LOAD_CONFIG, NULL);
-#endif /* DISABLE_CHANGE_PASSWORD */
-
   /* The Window structure */
   wincl.hInstance = hThisInstance;
   wincl.lpszClassName = szClassName;
@@ -352,6 +456,9 @@ StopAllOpenVPN()
 {
     int i;
 
+    /* Nothing queued should start while we stop */
+    ScheduleClear();
+
     /* Stop all connections started by us -- we leave persistent ones
      * at their current state. Use the disconnect menu to put them into
      * hold state before exit, if desired.
@@ -388,7 +495,7 @@ AutoStartConnections()
     for (i = 0; i < o.num_configs; i++)
     {
         if (o.conn[i].auto_connect && !(o.conn[i].flags & FLAG_DAEMON_PERSISTENT))
-            StartOpenVPN(&o.conn[i]);
+            ScheduleStart(&o.conn[i], start_auto);
     }
 
     return TRUE;
@@ -402,7 +509,7 @@ ResumeConnections()
     for (i = 0; i < o.num_configs; i++) {
         /* Restart suspend connections */
         if (o.conn[i].state == suspended)
-            StartOpenVPN(&o.conn[i]);
+            ScheduleStart(&o.conn[i], start_resume);
 
         /* If some connection never reached SUSPENDED state */
         if (o.conn[i].state == suspending)
@@ -410,6 +517,17 @@ ResumeConnections()
     }
 }
 
+/* Write recorded trace events to a file in log_dir */
+static void
+DumpTrace(void)
+{
+    WCHAR path[MAX_PATH];
+
+    _sntprintf_0(path, L"%ls\\openvpn-gui-trace.json", o.log_dir);
+    if (trace_dump(path))
+        MsgToEventLog(EVENTLOG_INFORMATION_TYPE, L"Trace events written to %ls", path);
+}
+
 static int
 HandleCopyDataMessage(const COPYDATASTRUCT *copy_data)
 {
@@ -437,10 +555,10 @@ HandleCopyDataMessage(const COPYDATASTRUCT *copy_data)
             ForceForegroundWindow(o.hWnd);
         RestartOpenVPN(c);
     }
-    else if(copy_data->dwData == WM_OVPN_SHOWSTATUS && c && c->hwndStatus)
+    else if(copy_data->dwData == WM_OVPN_SHOWSTATUS && c && c->hwndConn)
     {
         ForceForegroundWindow(o.hWnd);
-        ShowWindow(c->hwndStatus, SW_SHOW);
+        ShowStatusWindowAsync(c, TRUE);
     }
     else if(copy_data->dwData == WM_OVPN_STOPALL)
         StopAllOpenVPN();
@@ -467,6 +585,15 @@ HandleCopyDataMessage(const COPYDATASTRUCT *copy_data)
     {
         OnNotifyTray(WM_OVPN_RESCAN);
     }
+    else if (copy_data->dwData == WM_OVPN_TRACE && str)
+    {
+        if (wcscmp(str, L"start") == 0)
+            trace_start();
+        else if (wcscmp(str, L"stop") == 0)
+            trace_stop();
+        else if (wcscmp(str, L"dump") == 0)
+            DumpTrace();
+    }
     else
     {
         MsgToEventLog(EVENTLOG_ERROR_TYPE,
@@ -477,37 +604,61 @@ HandleCopyDataMessage(const COPYDATASTRUCT *copy_data)
     return TRUE; /* indicate we handled the message */
 }
 
-/* If automatic service is running, check whether we are
- * attached to the management i/f of persistent daemons
- * and re-attach if necessary. The timer is reset to
- * call this routine again after a delay. Periodic check
- * is required as we get detached if the daemon gets restarted
- * by the service or we do a disconnect.
+#define ATTACH_STABLE       30000   /* msec an attach must last to not count as dropped */
+#define ATTACH_BACKOFF      1000    /* msec before re-attach after the first drop */
+#define ATTACH_BACKOFF_MAX  300000
+
+/* If automatic service is running, queue attach to the management
+ * i/f of a persistent daemon unless we are attached or the user
+ * has disconnected it.
  */
-static void CALLBACK
-ManagePersistent(HWND hwnd, UINT UNUSED msg, UINT_PTR id, DWORD UNUSED now)
+static void
+AttachPersistent(connection_t *c, DWORD delay)
 {
-    CheckServiceStatus();
-    if (o.service_state == service_connected)
+    if (o.service_state != service_connected || o.session_locked)
+        return;
+
+    if (c->flags & FLAG_DAEMON_PERSISTENT
+        && c->auto_connect
+        && (c->state == disconnected || c->state == detached))
     {
-        for (int i = 0; i < o.num_configs; i++)
-        {
-            if (o.conn[i].flags & FLAG_DAEMON_PERSISTENT
-                && o.conn[i].auto_connect
-                && (o.conn[i].state == disconnected || o.conn[i].state == detached))
-            {
-                /* disable auto-connect to avoid repeated re-connect
-                 * after unrecoverable errors. Re-enabled on successful
-                 * connect.
-                 */
-                o.conn[i].auto_connect = false;
-                o.conn[i].state = detached; /* this is required to retain management-hold on re-attach */
-                StartOpenVPN(&o.conn[i]); /* attach to the management i/f */
-            }
-        }
+        ScheduleStartAfter(c, start_persistent, delay);
+    }
+}
+
+/* Called when the service starts or stops, configs are rescanned
+ * or the session is unlocked: connection index is -1. Else we
+ * got detached from connection i, e.g., as the daemon was restarted
+ * by the service. If that happens soon after attaching, delay the
+ * re-attach more each time.
+ */
+static void
+ManagePersistent(int i)
+{
+    if (i < 0)
+    {
+        for (i = 0; i < o.num_configs; i++)
+            AttachPersistent(&o.conn[i], 0);
+        return;
+    }
+    if (i >= o.num_configs)
+        return;
+
+    connection_t *c = &o.conn[i];
+    DWORD delay = 0;
+
+    CheckServiceStatus(); /* the service may be stopping */
+    if (c->attach_tick && GetTickCount64() - c->attach_tick < ATTACH_STABLE)
+    {
+        delay = min(ATTACH_BACKOFF << min(c->attach_drops, 9), ATTACH_BACKOFF_MAX);
+        c->attach_drops++;
     }
-    /* schedule to call again after 10 sec */
-    SetTimer(hwnd, id, 10000, ManagePersistent);
+    else
+    {
+        c->attach_drops = 0;
+    }
+    c->attach_tick = 0;
+    AttachPersistent(c, delay);
 }
 
 /* Detach from the mgmt i/f of all atatched persistent
@@ -538,12 +689,58 @@ HandleSessionUnlock(void)
     {
         if (o.conn[i].flags & FLAG_WAIT_UNLOCK)
         {
-            o.conn[i].auto_connect = true; /* so that ManagePersistent will trigger attach */
+            o.conn[i].auto_connect = true; /* so that ManagePersistent will attach */
             o.conn[i].flags &= ~ FLAG_WAIT_UNLOCK;
         }
     }
 }
 
+/* The part of the initialization that is done once the tray icon is shown */
+static void
+DeferredInit(HWND hwnd)
+{
+  if (!EarlyInitDone()) {
+    OnDestroyTray();
+    exit(1);
+  }
+  StartupMark(L"wait for version probe");
+
+  BOOL use_iservice = (o.iservice_admin && IsWindows7OrGreater()) || !IsUserAdmin();
+  if (use_iservice && strtod(o.ovpn_version, NULL) > 2.3 && !o.silent_connection)
+    CheckIServiceStatus(TRUE);
+  StartupMark(L"interactive service status");
+
+  GetProxyRegistrySettings();
+  QuickConnectIndexBuild();
+  echo_msg_init();
+  StartupMark(L"proxy settings, search index and echo window");
+
+  metrics_start();          /* no-op unless metrics_port is set */
+
+  /* if '--import' was specified, do it now */
+  if (o.action == WM_OVPN_IMPORT && o.action_arg)
+  {
+    ImportConfigFile(o.action_arg, true); /* prompt user */
+  }
+
+  if (!AutoStartConnections()) {
+    SendMessage(hwnd, WM_CLOSE, 0, 0);
+    return;
+  }
+
+  if (o.mgmt_replay)
+    mgmt_replay_start(o.mgmt_replay, o.mgmt_replay_fast);
+
+  /* Persistent connections are attached when the service is
+   * found running and whenever it starts
+   */
+  ServiceWatchStart(hwnd, WM_OVPN_SERVICE);
+  StartupMark(L"auto-start");
+
+  if (o.profile_startup)
+    StartupReport();
+}
+
 /*  This function is called by the Windows function DispatchMessage()  */
 LRESULT CALLBACK WindowProcedure (HWND hwnd, UINT message, WPARAM wParam, LPARAM lParam)
 {
@@ -574,30 +771,41 @@ LRESULT CALLBACK WindowProcedure (HWND hwnd, UINT message, WPARAM wParam, LPARAM
       ChangeWindowMessageFilterEx(hwnd, WM_COPYDATA, MSGFLT_ALLOW, NULL);
 #endif
 
-      echo_msg_init();
-
       CreatePopupMenus();	/* Create popup menus */
       ShowTrayIcon();
+      StartupMark(L"window and tray icon");
+      startup.tray_msec = StartupMsec(startup.start, startup.mark);
 
-      /* if '--import' was specified, do it now */
-      if (o.action == WM_OVPN_IMPORT && o.action_arg)
-      {
-        ImportConfigFile(o.action_arg, true); /* prompt user */
-      }
-
-      if (!AutoStartConnections()) {
-        SendMessage(hwnd, WM_CLOSE, 0, 0);
-        break;
-      }
-      /* A timer to periodically tend to persistent connections */
-      SetTimer(hwnd, 1, 100, ManagePersistent);
+      /* Posted messages are served before input: done before the user can click the icon */
+      PostMessage(hwnd, WM_OVPN_INIT_DEFERRED, 0, 0);
+      break;
 
+    case WM_OVPN_INIT_DEFERRED:
+      DeferredInit(hwnd);
       break;
 
     case WM_NOTIFYICONTRAY:
       OnNotifyTray(lParam); 	// Manages message from tray
       break;
 
+    case WM_OVPN_SERVICE:
+      CheckServiceStatus();
+      ManagePersistent(-1);
+      break;
+
+    case WM_OVPN_PERSISTENT:
+      ManagePersistent((int) wParam);
+      break;
+
+    case WM_OVPN_START_FAILED:
+      if ((int) wParam < o.num_configs)
+        ScheduleStartFailed(&o.conn[wParam]);
+      break;
+
+    case WM_INITMENUPOPUP:
+      OnInitMenuPopup((HMENU) wParam); // Fills in tray submenus as they open
+      break;
+
     case WM_COPYDATA:   // custom messages with data from other processes
       HandleCopyDataMessage((COPYDATASTRUCT*) lParam);
       return TRUE; /* lets the sender free copy_data */
@@ -616,6 +824,9 @@ LRESULT CALLBACK WindowProcedure (HWND hwnd, UINT message, WPARAM wParam, LPARAM
       else if (LOWORD(wParam) == IDM_IMPORT_URL) {
         ImportConfigFromURL();
       }
+      else if (LOWORD(wParam) == IDM_QUICKCONNECT) {
+        ShowQuickConnectDialog();
+      }
       else if (LOWORD(wParam) == IDM_SETTINGS) {
         ShowSettingsDialog();
       }
@@ -633,6 +844,7 @@ LRESULT CALLBACK WindowProcedure (HWND hwnd, UINT message, WPARAM wParam, LPARAM
       /* reach here only if the command did not match any global items and a valid connection id is available */
 
       if (LOWORD(wParam) == IDM_CONNECTMENU) {
+        QuickConnectNoteUse(&o.conn[conn_id]);
         StartOpenVPN(&o.conn[conn_id]);
       }
       else if (LOWORD(wParam) == IDM_DISCONNECTMENU) {
@@ -642,7 +854,7 @@ LRESULT CALLBACK WindowProcedure (HWND hwnd, UINT message, WPARAM wParam, LPARAM
         RestartOpenVPN(&o.conn[conn_id]);
       }
       else if (LOWORD(wParam) == IDM_STATUSMENU) {
-        ShowWindow(o.conn[conn_id].hwndStatus, SW_SHOW);
+        ShowStatusWindowAsync(&o.conn[conn_id], TRUE);
       }
       else if (LOWORD(wParam) == IDM_VIEWLOGMENU) {
         ViewLog(conn_id);
@@ -666,6 +878,10 @@ LRESULT CALLBACK WindowProcedure (HWND hwnd, UINT message, WPARAM wParam, LPARAM
 
     case WM_DESTROY:
       WTSUnRegisterSessionNotification(hwnd);
+      ServiceWatchStop();
+      metrics_stop();
+      if (trace_enabled)
+        DumpTrace();
       StopAllOpenVPN();
       OnDestroyTray();          /* Remove Tray Icon and destroy menus */
       PostQuitMessage (0);	/* Send a WM_QUIT to the message queue */
@@ -686,14 +902,13 @@ LRESULT CALLBACK WindowProcedure (HWND hwnd, UINT message, WPARAM wParam, LPARAM
           o.session_locked = TRUE;
           /* Detach persistent connections so that other users can connect to it */
           HandleSessionLock();
-          KillTimer(hwnd, 1); /* This ensure ManagePersistent is not called when session is locked */
           break;
 
         case WTS_SESSION_UNLOCK:
           PrintDebug(L"Session unlock triggered");
           o.session_locked = FALSE;
           HandleSessionUnlock();
-          SetTimer(hwnd, 1, 100, ManagePersistent);
+          ManagePersistent(-1);
           if (CountConnState(suspended) != 0)
             ResumeConnections();
           break;
@@ -64,6 +64,14 @@
 #define WM_OVPN_ECHOMSG        (WM_APP + 22)
 #define WM_OVPN_STATE          (WM_APP + 23)
 #define WM_OVPN_DETACH         (WM_APP + 24)
+#define WM_OVPN_TRACE          (WM_APP + 25)
+#define WM_OVPN_WAIT           (WM_APP + 26)
+#define WM_OVPN_CONN_START     (WM_APP + 27)
+#define WM_OVPN_PERSISTENT     (WM_APP + 28)
+#define WM_OVPN_SERVICE        (WM_APP + 29)
+#define WM_OVPN_INIT_DEFERRED  (WM_APP + 30)
+#define WM_OVPN_STATUSLOG      (WM_APP + 31)
+#define WM_OVPN_START_FAILED   (WM_APP + 32)
 
 /* bool definitions */
 #define bool int
@@ -31,11 +31,41 @@
 #include "manage.h"
 #include "main.h"
 #include "misc.h"
+#include "trace.h"
+#include "replay.h"
 
 extern options_t o;
 
 static mgmt_msg_func rtmsg_handler[mgmt_rtmsg_type_max];
 
+/* Span names used when tracing the handlers, indexed by mgmt_rtmsg_type */
+static const char *rtmsg_trace_name[mgmt_rtmsg_type_max] = {
+    [ready_] = "OnReady",
+    [stop_] = "OnStop",
+    [bytecount_] = "OnByteCount",
+    [echo_] = "OnEcho",
+    [hold_] = "OnHold",
+    [log_] = "OnLogLine",
+    [password_] = "OnPassword",
+    [proxy_] = "OnProxy",
+    [state_] = "OnStateChange",
+    [needok_] = "OnNeedOk",
+    [needstr_] = "OnNeedStr",
+    [pkcs11_id_count_] = "OnPkcs11",
+    [infomsg_] = "OnInfoMsg",
+    [timeout_] = "OnTimeout",
+};
+
+/* Notifications that prompt the user: skipped when replaying a recording */
+static const BOOL rtmsg_interactive[mgmt_rtmsg_type_max] = {
+    [password_] = TRUE,
+    [proxy_] = TRUE,
+    [needok_] = TRUE,
+    [needstr_] = TRUE,
+    [pkcs11_id_count_] = TRUE,
+    [infomsg_] = TRUE,
+};
+
 /*
  * Number of seconds to try connecting to management interface
  */
@@ -54,6 +84,26 @@ InitManagement(const mgmt_rtmsg_handler *handler)
     }
 }
 
+/*
+ * Call the handler registered for a real-time notification, if any
+ */
+static void
+DispatchRtmsg(connection_t *c, mgmt_rtmsg_type type, char *msg)
+{
+    if (!rtmsg_handler[type])
+        return;
+
+    if (c->manage.replay && rtmsg_interactive[type])
+    {
+        PrintDebug(L"Replay of %ls: %hs skipped", c->config_name, rtmsg_trace_name[type]);
+        return;
+    }
+
+    TRACE_BEGIN(rtmsg_trace_name[type]);
+    rtmsg_handler[type](c, msg);
+    TRACE_END(rtmsg_trace_name[type]);
+}
+
 /*
  * Connect to the OpenVPN management interface and register
  * asynchronous socket event notification for it
@@ -72,13 +122,16 @@ OpenManagement(connection_t *c)
         WSACleanup ();
         return FALSE;
     }
-    if (WSAAsyncSelect(c->manage.sk, c->hwndStatus, WM_MANAGEMENT,
+    if (WSAAsyncSelect(c->manage.sk, c->hwndConn, WM_MANAGEMENT,
         FD_CONNECT|FD_READ|FD_WRITE|FD_CLOSE) != 0)
         return FALSE;
 
     connect(c->manage.sk, (SOCKADDR *)&c->manage.skaddr, sizeof(c->manage.skaddr));
     c->manage.timeout = time(NULL) + max_connect_time;
 
+    if (o.mgmt_record)
+        mgmt_record_open(c);
+
     return TRUE;
 }
 
@@ -94,6 +147,10 @@ SendCommand(connection_t *c)
     if (cmd == NULL || cmd->size == 0)
         return;
 
+    /* a replayed session has no daemon: the recording holds its replies */
+    if (c->manage.replay)
+        return;
+
     res = send(c->manage.sk, cmd->command, cmd->size, 0);
     if (res < 1)
         return;
@@ -185,6 +242,219 @@ UnqueueCommand(connection_t *c)
 }
 
 
+/*
+ * Parse a buffer of management data into lines and dispatch them.
+ * A trailing partial line is saved until more data arrives.
+ */
+static void
+ParseManagementData(connection_t *c, char *data, ULONG data_size)
+{
+    ULONG offset;
+
+    TRACE_BEGIN("OnManagement");
+    offset = 0;
+    while (offset < data_size)
+    {
+        char *pos;
+        char *line = data + offset;
+        size_t line_size = data_size - offset;
+        BOOL passwd_request = false;
+        const char *passwd_prompt = "ENTER PASSWORD:";
+
+        if (line_size >= strlen(passwd_prompt)
+            && memcmp(line, passwd_prompt, strlen(passwd_prompt)) == 0)
+        {
+            pos = memchr(line, ':', line_size);
+            passwd_request = true;
+        }
+        else
+        {
+            pos = memchr(line, '\n', line_size);
+        }
+
+        if (pos == NULL)
+        {
+            c->manage.saved_data = malloc(line_size);
+            if (c->manage.saved_data)
+            {
+                c->manage.saved_size = line_size;
+                memcpy(c->manage.saved_data, line, c->manage.saved_size);
+            }
+            break;
+        }
+
+        offset += (pos - line) + 1;
+
+        /*
+         * A replay has no management password: the recorded session
+         * answered the prompt. Queue a command that is never sent to
+         * stand in for it, so that the recorded reply is consumed.
+         */
+        if (c->manage.replay && passwd_request)
+        {
+            ManagementCommand(c, "", NULL, regular);
+            continue;
+        }
+
+        /* Reply to a management password request */
+        if (*c->manage.password && passwd_request)
+        {
+            ManagementCommand(c, c->manage.password, NULL, regular);
+            SecureZeroMemory(c->manage.password, sizeof(c->manage.password));
+
+            continue;
+        }
+
+        if (!*c->manage.password && passwd_request)
+        {
+            /* either we don't have a password or we used it and didn't match */
+            MsgToEventLog(EVENTLOG_WARNING_TYPE, L"%ls: management password mismatch",
+                          c->config_name);
+            SetConnState(c, disconnecting);
+            CloseManagement (c);
+            DispatchRtmsg(c, stop_, "");
+
+            continue;
+        }
+
+        /* Handle regular management interface output */
+        line[pos - line - 1] = '\0';
+        if (line[0] == '>')
+        {
+            /* Real time notifications */
+            pos = line + 1;
+            if (strncmp(pos, "LOG:", 4) == 0)
+            {
+                DispatchRtmsg(c, log_, pos + 4);
+            }
+            else if (strncmp(pos, "STATE:", 6) == 0)
+            {
+                DispatchRtmsg(c, state_, pos + 6);
+            }
+            else if (strncmp(pos, "HOLD:", 5) == 0)
+            {
+                DispatchRtmsg(c, hold_, pos + 5);
+            }
+            else if (strncmp(pos, "PASSWORD:", 9) == 0)
+            {
+                DispatchRtmsg(c, password_, pos + 9);
+            }
+            else if (strncmp(pos, "PROXY:", 6) == 0)
+            {
+                DispatchRtmsg(c, proxy_, pos + 6);
+            }
+            else if (strncmp(pos, "INFO:", 5) == 0)
+            {
+                /* delay until management interface accepts input */
+                if (!c->manage.replay)
+                    Sleep(100);
+                c->manage.connected = 2;
+                DispatchRtmsg(c, ready_, pos + 5);
+            }
+            else if (strncmp(pos, "NEED-OK:", 8) == 0)
+            {
+                DispatchRtmsg(c, needok_, pos + 8);
+            }
+            else if (strncmp(pos, "NEED-STR:", 9) == 0)
+            {
+                DispatchRtmsg(c, needstr_, pos + 9);
+            }
+            else if (strncmp(pos, "ECHO:", 5) == 0)
+            {
+                DispatchRtmsg(c, echo_, pos + 5);
+            }
+            else if (strncmp(pos, "BYTECOUNT:", 10) == 0)
+            {
+                DispatchRtmsg(c, bytecount_, pos + 10);
+            }
+            else if (strncmp(pos, "INFOMSG:", 8) == 0)
+            {
+                DispatchRtmsg(c, infomsg_, pos + 8);
+            }
+            else if (strncmp(pos, "PKCS11ID", 8) == 0
+                     && c->manage.cmd_queue)
+            {
+                /* This is not a real-time message, but unfortunately implemented
+                 * in the core as one. Work around by handling the response here.
+                 */
+                mgmt_cmd_t *cmd = c->manage.cmd_queue;
+                if (cmd->handler)
+                    cmd->handler(c, line);
+                UnqueueCommand(c);
+            }
+        }
+        else if (c->manage.cmd_queue)
+        {
+            /* Response to commands */
+            mgmt_cmd_t *cmd = c->manage.cmd_queue;
+            TRACE_BEGIN("CommandResponse");
+            if (strncmp(line, "SUCCESS:", 8) == 0)
+            {
+                if (cmd->handler)
+                    cmd->handler(c, line + 9);
+                UnqueueCommand(c);
+            }
+            else if (strncmp(line, "ERROR:", 6) == 0)
+            {
+                /* Response sent to management is not processed. Log an error in status window  */
+                char buf[256];
+                _snprintf_0(buf, "%lld,N,Previous command sent to management failed: %s",
+                            (long long)time(NULL), line)
+                DispatchRtmsg(c, log_, buf);
+
+                if (cmd->handler)
+                    cmd->handler(c, NULL);
+                UnqueueCommand(c);
+            }
+            else if (strcmp(line, "END") == 0)
+            {
+                UnqueueCommand(c);
+            }
+            else if (cmd->handler)
+            {
+                cmd->handler(c, line);
+            }
+            TRACE_END("CommandResponse");
+        }
+    }
+    TRACE_END("OnManagement");
+}
+
+/*
+ * Process data received from the management interface by other
+ * means than the socket, e.g., from a recording.
+ */
+void
+FeedManagementData(connection_t *c, const char *buf, size_t len)
+{
+    char *data = malloc(c->manage.saved_size + len);
+    if (data == NULL)
+        return;
+
+    memcpy(data + c->manage.saved_size, buf, len);
+    if (c->manage.saved_size)
+    {
+        memcpy(data, c->manage.saved_data, c->manage.saved_size);
+        free(c->manage.saved_data);
+    }
+    len += c->manage.saved_size;
+    c->manage.saved_data = NULL;
+    c->manage.saved_size = 0;
+
+    ParseManagementData(c, data, (ULONG) len);
+    free(data);
+}
+
+/*
+ * Handle close of the management connection by the daemon
+ */
+void
+ManagementClosed(connection_t *c)
+{
+    CloseManagement(c);
+    DispatchRtmsg(c, stop_, "");
+}
+
 /*
  * Handle management socket events asynchronously
  */
@@ -193,7 +463,7 @@ OnManagement(SOCKET sk, LPARAM lParam)
 {
     int res;
     char *data;
-    ULONG data_size, offset;
+    ULONG data_size;
 
     connection_t *c = GetConnByManagement(sk);
     if (c == NULL)
@@ -214,7 +484,7 @@ OnManagement(SOCKET sk, LPARAM lParam)
                     char buf[256];
                     _snprintf_0(buf, "%lld,W,Waiting for the management interface to come up",
                                 (long long)time(NULL))
-                    rtmsg_handler[log_](c, buf);
+                    DispatchRtmsg(c, log_, buf);
                 }
 
                 connect(c->manage.sk, (SOCKADDR *)&c->manage.skaddr, sizeof(c->manage.skaddr));
@@ -224,7 +494,7 @@ OnManagement(SOCKET sk, LPARAM lParam)
                 /* Connection to MI timed out. */
                 CloseManagement (c);
                 if (c->state != disconnected)
-                    rtmsg_handler[timeout_](c, "");
+                    DispatchRtmsg(c, timeout_, "");
             }
         }
         else
@@ -240,13 +510,18 @@ OnManagement(SOCKET sk, LPARAM lParam)
         if (data == NULL)
             return;
 
+        TRACE_BEGIN("recv");
         res = recv(c->manage.sk, data + c->manage.saved_size, data_size, 0);
+        TRACE_END("recv");
         if (res != (int) data_size)
         {
             free(data);
             return;
         }
 
+        if (c->manage.record)
+            mgmt_record_data(c, data + c->manage.saved_size, data_size);
+
         /* Copy previously saved management data */
         if (c->manage.saved_size)
         {
@@ -257,168 +532,7 @@ OnManagement(SOCKET sk, LPARAM lParam)
             c->manage.saved_size = 0;
         }
 
-        offset = 0;
-        while (offset < data_size)
-        {
-            char *pos;
-            char *line = data + offset;
-            size_t line_size = data_size - offset;
-            BOOL passwd_request = false;
-            const char *passwd_prompt = "ENTER PASSWORD:";
-
-            if (line_size >= strlen(passwd_prompt)
-                && memcmp(line, passwd_prompt, strlen(passwd_prompt)) == 0)
-            {
-                pos = memchr(line, ':', line_size);
-                passwd_request = true;
-            }
-            else
-            {
-                pos = memchr(line, '\n', line_size);
-            }
-
-            if (pos == NULL)
-            {
-                c->manage.saved_data = malloc(line_size);
-                if (c->manage.saved_data)
-                {
-                    c->manage.saved_size = line_size;
-                    memcpy(c->manage.saved_data, line, c->manage.saved_size);
-                }
-                break;
-            }
-
-            offset += (pos - line) + 1;
-
-            /* Reply to a management password request */
-            if (*c->manage.password && passwd_request)
-            {
-                ManagementCommand(c, c->manage.password, NULL, regular);
-                SecureZeroMemory(c->manage.password, sizeof(c->manage.password));
-
-                continue;
-            }
-
-            if (!*c->manage.password && passwd_request)
-            {
-                /* either we don't have a password or we used it and didn't match */
-                MsgToEventLog(EVENTLOG_WARNING_TYPE, L"%ls: management password mismatch",
-                              c->config_name);
-                c->state = disconnecting;
-                CloseManagement (c);
-                rtmsg_handler[stop_](c, "");
-
-                continue;
-            }
-
-            /* Handle regular management interface output */
-            line[pos - line - 1] = '\0';
-            if (line[0] == '>')
-            {
-                /* Real time notifications */
-                pos = line + 1;
-                if (strncmp(pos, "LOG:", 4) == 0)
-                {
-                    if (rtmsg_handler[log_])
-                        rtmsg_handler[log_](c, pos + 4);
-                }
-                else if (strncmp(pos, "STATE:", 6) == 0)
-                {
-                    if (rtmsg_handler[state_])
-                        rtmsg_handler[state_](c, pos + 6);
-                }
-                else if (strncmp(pos, "HOLD:", 5) == 0)
-                {
-                    if (rtmsg_handler[hold_])
-                        rtmsg_handler[hold_](c, pos + 5);
-                }
-                else if (strncmp(pos, "PASSWORD:", 9) == 0)
-                {
-                    if (rtmsg_handler[password_])
-                        rtmsg_handler[password_](c, pos + 9);
-                }
-                else if (strncmp(pos, "PROXY:", 6) == 0)
-                {
-                    if (rtmsg_handler[proxy_])
-                        rtmsg_handler[proxy_](c, pos + 6);
-                }
-                else if (strncmp(pos, "INFO:", 5) == 0)
-                {
-                    /* delay until management interface accepts input */
-                    Sleep(100);
-                    c->manage.connected = 2;
-                    if (rtmsg_handler[ready_])
-                        rtmsg_handler[ready_](c, pos + 5);
-                }
-                else if (strncmp(pos, "NEED-OK:", 8) == 0)
-                {
-                    if (rtmsg_handler[needok_])
-                        rtmsg_handler[needok_](c, pos + 8);
-                }
-                else if (strncmp(pos, "NEED-STR:", 9) == 0)
-                {
-                    if (rtmsg_handler[needstr_])
-                        rtmsg_handler[needstr_](c, pos + 9);
-                }
-                else if (strncmp(pos, "ECHO:", 5) == 0)
-                {
-                    if (rtmsg_handler[echo_])
-                        rtmsg_handler[echo_](c, pos + 5);
-                }
-                else if (strncmp(pos, "BYTECOUNT:", 10) == 0)
-                {
-                    if (rtmsg_handler[bytecount_])
-                        rtmsg_handler[bytecount_](c, pos + 10);
-                }
-                else if (strncmp(pos, "INFOMSG:", 8) == 0)
-                {
-                    if (rtmsg_handler[infomsg_])
-                        rtmsg_handler[infomsg_](c, pos + 8);
-                }
-                else if (strncmp(pos, "PKCS11ID", 8) == 0
-                         && c->manage.cmd_queue)
-                {
-                    /* This is not a real-time message, but unfortunately implemented
-                     * in the core as one. Work around by handling the response here.
-                     */
-                    mgmt_cmd_t *cmd = c->manage.cmd_queue;
-                    if (cmd->handler)
-                        cmd->handler(c, line);
-                    UnqueueCommand(c);
-                }
-            }
-            else if (c->manage.cmd_queue)
-            {
-                /* Response to commands */
-                mgmt_cmd_t *cmd = c->manage.cmd_queue;
-                if (strncmp(line, "SUCCESS:", 8) == 0)
-                {
-                    if (cmd->handler)
-                        cmd->handler(c, line + 9);
-                    UnqueueCommand(c);
-                }
-                else if (strncmp(line, "ERROR:", 6) == 0)
-                {
-                    /* Response sent to management is not processed. Log an error in status window  */
-                    char buf[256];
-                    _snprintf_0(buf, "%lld,N,Previous command sent to management failed: %s",
-                                (long long)time(NULL), line)
-                    rtmsg_handler[log_](c, buf);
-
-                    if (cmd->handler)
-                        cmd->handler(c, NULL);
-                    UnqueueCommand(c);
-                }
-                else if (strcmp(line, "END") == 0)
-                {
-                    UnqueueCommand(c);
-                }
-                else if (cmd->handler)
-                {
-                    cmd->handler(c, line);
-                }
-            }
-        }
+        ParseManagementData(c, data, data_size);
         free(data);
         break;
 
@@ -427,9 +541,9 @@ OnManagement(SOCKET sk, LPARAM lParam)
         break;
 
     case FD_CLOSE:
-        CloseManagement (c);
-        if (rtmsg_handler[stop_])
-            rtmsg_handler[stop_](c, "");
+        if (c->manage.record)
+            mgmt_record_data(c, NULL, 0);
+        ManagementClosed(c);
         break;
     }
 }
@@ -452,4 +566,13 @@ CloseManagement(connection_t *c)
             ;
         WSACleanup();
     }
+
+    if (c->manage.record)
+        mgmt_record_close(c);
+    if (c->manage.replay)
+    {
+        mgmt_replay_close(c);
+        while (UnqueueCommand(c))
+            ;
+    }
 }
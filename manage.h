@@ -68,6 +68,8 @@ BOOL OpenManagement(connection_t *);
 BOOL ManagementCommand(connection_t *, char *, mgmt_msg_func, mgmt_cmd_type);
 
 void OnManagement(SOCKET, LPARAM);
+void FeedManagementData(connection_t *, const char *, size_t);
+void ManagementClosed(connection_t *);
 void CloseManagement(connection_t *);
 
 #endif
@@ -0,0 +1,145 @@
+/*
+ *  OpenVPN-GUI -- A Windows GUI for OpenVPN.
+ *
+ *  Copyright (C) 2026 OpenVPN GUI contributors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program (see the file COPYING included with this
+ *  distribution); if not, write to the Free Software Foundation, Inc.,
+ *  59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <windows.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "menu_index.h"
+
+BOOL
+menu_index_reset(menu_index_t *mi, int num_groups, int num_configs)
+{
+    menu_index_free(mi);
+
+    int ng = max(num_groups, 1);
+    int nc = max(num_configs, 1);
+
+    mi->parent = calloc(ng, sizeof(*mi->parent));
+    mi->listed = calloc(ng, sizeof(*mi->listed));
+    mi->group_pos = calloc(ng, sizeof(*mi->group_pos));
+    mi->children = calloc(ng, sizeof(*mi->children));
+    mi->config_group = calloc(nc, sizeof(*mi->config_group));
+    mi->config_pos = calloc(nc, sizeof(*mi->config_pos));
+    mi->first = calloc(ng + 1, sizeof(*mi->first));
+    mi->entry = calloc(ng + nc, sizeof(*mi->entry));
+
+    if (!mi->parent || !mi->listed || !mi->group_pos || !mi->children || !mi->config_group
+        || !mi->config_pos || !mi->first || !mi->entry)
+    {
+        menu_index_free(mi);
+        return FALSE;
+    }
+    mi->num_groups = num_groups;
+    mi->num_configs = num_configs;
+    for (int g = 0; g < num_groups; g++)
+        mi->parent[g] = -1;
+    return TRUE;
+}
+
+void
+menu_index_set_group(menu_index_t *mi, int g, int parent, BOOL listed)
+{
+    mi->parent[g] = parent;
+    mi->listed[g] = listed && parent >= 0;
+}
+
+void
+menu_index_set_config(menu_index_t *mi, int i, int g)
+{
+    mi->config_group[i] = g;
+}
+
+void
+menu_index_build(menu_index_t *mi)
+{
+    int *n = mi->children;
+
+    /* count the entries of each menu and lay the menus out one after another */
+    for (int g = 0; g < mi->num_groups; g++)
+        n[g] = 0;
+    for (int g = 0; g < mi->num_groups; g++)
+    {
+        if (mi->listed[g])
+            n[mi->parent[g]]++;
+    }
+    for (int i = 0; i < mi->num_configs; i++)
+        n[mi->config_group[i]]++;
+
+    mi->first[0] = 0;
+    for (int g = 0; g < mi->num_groups; g++)
+    {
+        mi->first[g + 1] = mi->first[g] + n[g];
+        n[g] = 0; /* recounted as entries are placed */
+    }
+
+    /* groups first, then configs */
+    for (int g = 0; g < mi->num_groups; g++)
+    {
+        if (!mi->listed[g])
+            continue;
+        int p = mi->parent[g];
+        mi->group_pos[g] = n[p]++;
+        mi->entry[mi->first[p] + mi->group_pos[g]] = MENU_INDEX_GROUP(g);
+    }
+    for (int i = 0; i < mi->num_configs; i++)
+    {
+        int g = mi->config_group[i];
+        mi->config_pos[i] = n[g]++;
+        mi->entry[mi->first[g] + mi->config_pos[i]] = i;
+    }
+}
+
+const int *
+menu_index_entries(const menu_index_t *mi, int g, int *count)
+{
+    *count = mi->first[g + 1] - mi->first[g];
+    return mi->entry + mi->first[g];
+}
+
+BOOL
+menu_index_in_group(const menu_index_t *mi, int i, int g)
+{
+    for (int cg = mi->config_group[i]; cg >= 0; cg = mi->parent[cg])
+    {
+        if (cg == g)
+            return TRUE;
+    }
+    return FALSE;
+}
+
+void
+menu_index_free(menu_index_t *mi)
+{
+    free(mi->parent);
+    free(mi->listed);
+    free(mi->group_pos);
+    free(mi->children);
+    free(mi->config_group);
+    free(mi->config_pos);
+    free(mi->first);
+    free(mi->entry);
+    memset(mi, 0, sizeof(*mi));
+}
@@ -0,0 +1,77 @@
+/*
+ *  OpenVPN-GUI -- A Windows GUI for OpenVPN.
+ *
+ *  Copyright (C) 2026 OpenVPN GUI contributors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program (see the file COPYING included with this
+ *  distribution); if not, write to the Free Software Foundation, Inc.,
+ *  59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MENU_INDEX_H
+#define MENU_INDEX_H
+
+/*
+ * Index of the tray menu tree: the position of each group and config
+ * in the menu that lists it and the entries of each group menu in
+ * order, so that a submenu is filled from its own entries when it
+ * opens instead of by scanning all groups and configs. Uses no Windows
+ * API beyond basic types so that it can be tested on any host (see
+ * tests/).
+ */
+
+#include <windows.h>
+
+/* Entries are configs by index and groups by this tag */
+#define MENU_INDEX_GROUP(id) (-(id) - 1)
+
+typedef struct {
+    int num_groups;
+    int num_configs;
+    int *parent;        /* parent of each group, -1 for none */
+    BOOL *listed;       /* whether a group is listed in its parent menu */
+    int *group_pos;     /* position of each listed group in its parent menu */
+    int *children;      /* number of entries in the menu of each group */
+    int *config_group;  /* group whose menu lists each config */
+    int *config_pos;    /* position of each config in that menu */
+    int *first;         /* entries of group g are entry[first[g]] .. entry[first[g + 1] - 1] */
+    int *entry;
+} menu_index_t;
+
+/* Empty the index and make room for the given number of groups and configs. Returns false on error */
+BOOL menu_index_reset(menu_index_t *mi, int num_groups, int num_configs);
+
+/* Set the parent of group g, and whether the parent menu lists it */
+void menu_index_set_group(menu_index_t *mi, int g, int parent, BOOL listed);
+
+/* Set the group whose menu lists config i */
+void menu_index_set_config(menu_index_t *mi, int i, int g);
+
+/*
+ * Assign menu positions and order the entries of each group menu:
+ * child groups first, then configs, each in index order. Call after
+ * all groups and configs are set.
+ */
+void menu_index_build(menu_index_t *mi);
+
+/* Return the entries of the menu of group g and set *count to their number */
+const int *menu_index_entries(const menu_index_t *mi, int g, int *count);
+
+/* Return true if config i is listed in the menu of group g or of a group below it */
+BOOL menu_index_in_group(const menu_index_t *mi, int i, int g);
+
+/* Release all memory of the index */
+void menu_index_free(menu_index_t *mi);
+
+#endif
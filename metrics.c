@@ -0,0 +1,427 @@
+/*
+ *  OpenVPN-GUI -- A Windows GUI for OpenVPN.
+ *
+ *  Copyright (C) 2026 OpenVPN GUI contributors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program (see the file COPYING included with this
+ *  distribution); if not, write to the Free Software Foundation, Inc.,
+ *  59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <winsock2.h>
+#include <windows.h>
+#include <stdarg.h>
+#include <stdio.h>
+
+#include "main.h"
+#include "options.h"
+#include "openvpn.h"
+#include "misc.h"
+#include "metrics.h"
+#include "scheduler.h"
+
+extern options_t o;
+
+/* A growable output buffer for the metrics snapshot */
+struct metrics_buf {
+    char *data;
+    size_t len;
+    size_t size;
+    BOOL error;
+};
+
+static SOCKET listen_sk = INVALID_SOCKET;
+static HANDLE metrics_thread;
+
+/* names of conn_state_t values as exposed in the state label */
+static const char *conn_state_names[] = {
+    "disconnected", "onhold", "connecting", "reconnecting", "connected",
+    "disconnecting", "suspending", "suspended", "resuming", "detaching",
+    "detached"
+};
+
+/* names of start_kind_t values as exposed in the kind label */
+static const char *start_kind_names[] = {
+    "resume", "auto", "persistent"
+};
+
+/* Append printf-style formatted output to the buffer */
+static void
+buf_printf(struct metrics_buf *b, const char *format, ...)
+{
+    va_list args;
+
+    while (!b->error)
+    {
+        va_start(args, format);
+        int n = _vsnprintf(b->data + b->len, b->size - b->len, format, args);
+        va_end(args);
+
+        if (n >= 0 && (size_t) n < b->size - b->len)
+        {
+            b->len += n;
+            return;
+        }
+
+        /* not enough space -- grow and retry */
+        size_t size = b->size ? 2*b->size : 4096;
+        char *tmp = realloc(b->data, size);
+        if (!tmp)
+        {
+            b->error = true;
+            return;
+        }
+        b->data = tmp;
+        b->size = size;
+    }
+}
+
+/* Convert profile name to UTF-8 escaped for use as a label value */
+static void
+label_value(const WCHAR *name, char *out, size_t len)
+{
+    char utf8[3*MAX_PATH];
+    size_t j = 0;
+
+    if (WideCharToMultiByte(CP_UTF8, 0, name, -1, utf8, sizeof(utf8), NULL, NULL) == 0)
+        utf8[0] = '\0';
+
+    for (const char *p = utf8; *p && j + 2 < len; p++)
+    {
+        if (*p == '\\' || *p == '"')
+        {
+            out[j++] = '\\';
+            out[j++] = *p;
+        }
+        else if (*p == '\n')
+        {
+            out[j++] = '\\';
+            out[j++] = 'n';
+        }
+        else
+        {
+            out[j++] = *p;
+        }
+    }
+    out[j] = '\0';
+}
+
+/* ScheduleForEach callbacks listing the start queue */
+static void
+queue_due(const WCHAR *profile, start_kind_t kind, UNUSED int attempts, LONGLONG due_in, void *arg)
+{
+    char name[3*MAX_PATH];
+
+    label_value(profile, name, sizeof(name));
+    buf_printf(arg, "openvpn_gui_start_queue_due_seconds{profile=\"%s\",kind=\"%s\"} %.3f\n",
+               name, start_kind_names[kind], due_in/1000.0);
+}
+
+static void
+queue_attempts(const WCHAR *profile, start_kind_t kind, int attempts, UNUSED LONGLONG due_in, void *arg)
+{
+    char name[3*MAX_PATH];
+
+    label_value(profile, name, sizeof(name));
+    buf_printf(arg, "openvpn_gui_start_queue_failed_attempts{profile=\"%s\",kind=\"%s\"} %d\n",
+               name, start_kind_names[kind], attempts);
+}
+
+/*
+ * Write a snapshot of all connection stats in Prometheus text format.
+ * The conn_lock guards against the connection array being reallocated
+ * while we walk it. The daemon state, byte counts and state timeline of
+ * a connection are copied under its stats_lock; the remaining fields
+ * are single words read as is, which may be one update stale.
+ */
+static void
+metrics_snapshot(struct metrics_buf *b)
+{
+    char name[3*MAX_PATH];
+    ULONGLONG now = GetTickCount64();
+
+    AcquireSRWLockShared(&o.conn_lock);
+
+    buf_printf(b, "# HELP openvpn_gui_connection_state Current state of the connection profile.\n"
+                  "# TYPE openvpn_gui_connection_state gauge\n");
+    for (int i = 0; i < o.num_configs; i++)
+    {
+        connection_t *c = &o.conn[i];
+        conn_state_t state = c->state;
+        char daemon_state[sizeof(c->daemon_state)];
+        if ((size_t) state >= _countof(conn_state_names))
+            continue;
+        AcquireSRWLockShared(&c->stats_lock);
+        strncpy_s(daemon_state, _countof(daemon_state), c->daemon_state, _TRUNCATE);
+        ReleaseSRWLockShared(&c->stats_lock);
+        label_value(c->config_name, name, sizeof(name));
+        buf_printf(b, "openvpn_gui_connection_state{profile=\"%s\",state=\"%s\",daemon_state=\"%s\"} 1\n",
+                   name, conn_state_names[state], daemon_state);
+    }
+
+    buf_printf(b, "# HELP openvpn_gui_bytes_received Bytes received as last reported by the daemon.\n"
+                  "# TYPE openvpn_gui_bytes_received gauge\n");
+    for (int i = 0; i < o.num_configs; i++)
+    {
+        connection_t *c = &o.conn[i];
+        if (c->state == disconnected)
+            continue;
+        AcquireSRWLockShared(&c->stats_lock);
+        unsigned long long bytes = c->bytes_in;
+        ReleaseSRWLockShared(&c->stats_lock);
+        label_value(c->config_name, name, sizeof(name));
+        buf_printf(b, "openvpn_gui_bytes_received{profile=\"%s\"} %I64u\n", name, bytes);
+    }
+
+    buf_printf(b, "# HELP openvpn_gui_bytes_sent Bytes sent as last reported by the daemon.\n"
+                  "# TYPE openvpn_gui_bytes_sent gauge\n");
+    for (int i = 0; i < o.num_configs; i++)
+    {
+        connection_t *c = &o.conn[i];
+        if (c->state == disconnected)
+            continue;
+        AcquireSRWLockShared(&c->stats_lock);
+        unsigned long long bytes = c->bytes_out;
+        ReleaseSRWLockShared(&c->stats_lock);
+        label_value(c->config_name, name, sizeof(name));
+        buf_printf(b, "openvpn_gui_bytes_sent{profile=\"%s\"} %I64u\n", name, bytes);
+    }
+
+    buf_printf(b, "# HELP openvpn_gui_connected_since_seconds Unix time at which the connection was established.\n"
+                  "# TYPE openvpn_gui_connected_since_seconds gauge\n");
+    for (int i = 0; i < o.num_configs; i++)
+    {
+        const connection_t *c = &o.conn[i];
+        if (c->state != connected)
+            continue;
+        label_value(c->config_name, name, sizeof(name));
+        buf_printf(b, "openvpn_gui_connected_since_seconds{profile=\"%s\"} %lld\n",
+                   name, (long long) c->connected_since);
+    }
+
+    buf_printf(b, "# HELP openvpn_gui_reconnects_total Number of reconnects reported by the daemon.\n"
+                  "# TYPE openvpn_gui_reconnects_total counter\n");
+    for (int i = 0; i < o.num_configs; i++)
+    {
+        const connection_t *c = &o.conn[i];
+        label_value(c->config_name, name, sizeof(name));
+        buf_printf(b, "openvpn_gui_reconnects_total{profile=\"%s\"} %d\n", name, c->reconnects);
+    }
+
+    buf_printf(b, "# HELP openvpn_gui_auth_failures Consecutive user authentication failures.\n"
+                  "# TYPE openvpn_gui_auth_failures gauge\n");
+    for (int i = 0; i < o.num_configs; i++)
+    {
+        const connection_t *c = &o.conn[i];
+        label_value(c->config_name, name, sizeof(name));
+        buf_printf(b, "openvpn_gui_auth_failures{profile=\"%s\"} %d\n", name, c->failed_auth_attempts);
+    }
+
+    buf_printf(b, "# HELP openvpn_gui_seconds_since_state_change Time elapsed since the last daemon state change.\n"
+                  "# TYPE openvpn_gui_seconds_since_state_change gauge\n");
+    for (int i = 0; i < o.num_configs; i++)
+    {
+        connection_t *c = &o.conn[i];
+        ULONGLONG tick = 0;
+        AcquireSRWLockShared(&c->stats_lock);
+        int n = c->timeline.count;
+        if (n > 0 && n <= MAX_STATE_MARKS)
+            tick = c->timeline.mark[n-1].tick;
+        ReleaseSRWLockShared(&c->stats_lock);
+        if (tick == 0)
+            continue;
+        label_value(c->config_name, name, sizeof(name));
+        buf_printf(b, "openvpn_gui_seconds_since_state_change{profile=\"%s\"} %.3f\n",
+                   name, (now - tick)/1000.0);
+    }
+
+    buf_printf(b, "# HELP openvpn_gui_connect_duration_seconds Time taken by the last connection setup.\n"
+                  "# TYPE openvpn_gui_connect_duration_seconds gauge\n");
+    for (int i = 0; i < o.num_configs; i++)
+    {
+        connection_t *c = &o.conn[i];
+        AcquireSRWLockShared(&c->stats_lock);
+        LONGLONG t = GetStatePhaseDuration(c, NULL, "CONNECTED");
+        ReleaseSRWLockShared(&c->stats_lock);
+        if (t < 0)
+            continue;
+        label_value(c->config_name, name, sizeof(name));
+        buf_printf(b, "openvpn_gui_connect_duration_seconds{profile=\"%s\"} %.3f\n", name, t/1000.0);
+    }
+
+    ReleaseSRWLockShared(&o.conn_lock);
+
+    buf_printf(b, "# HELP openvpn_gui_start_queue_due_seconds Time until a queued start may run, negative if waiting for a free slot.\n"
+                  "# TYPE openvpn_gui_start_queue_due_seconds gauge\n");
+    ScheduleForEach(queue_due, b);
+
+    buf_printf(b, "# HELP openvpn_gui_start_queue_failed_attempts Failed attempts to start a queued connection.\n"
+                  "# TYPE openvpn_gui_start_queue_failed_attempts gauge\n");
+    ScheduleForEach(queue_attempts, b);
+}
+
+/* Read the request header and return true if it is "GET /metrics" */
+static BOOL
+read_request(SOCKET sk)
+{
+    char req[1024];
+    int len = 0;
+    DWORD timeout = 2000; /* msec */
+
+    setsockopt(sk, SOL_SOCKET, SO_RCVTIMEO, (const char *) &timeout, sizeof(timeout));
+
+    while (len < (int) sizeof(req) - 1)
+    {
+        int n = recv(sk, req + len, sizeof(req) - 1 - len, 0);
+        if (n <= 0)
+            break;
+        len += n;
+        req[len] = '\0';
+        if (strstr(req, "\r\n\r\n") || strstr(req, "\n\n"))
+            break;
+    }
+    req[len] = '\0';
+
+    return (strbegins(req, "GET /metrics ") || strbegins(req, "GET / "));
+}
+
+static void
+send_all(SOCKET sk, const char *data, size_t len)
+{
+    while (len > 0)
+    {
+        int n = send(sk, data, (int) min(len, 0x10000), 0);
+        if (n <= 0)
+            return;
+        data += n;
+        len -= n;
+    }
+}
+
+static void
+serve_client(SOCKET sk)
+{
+    char header[256];
+    struct metrics_buf b = {0};
+
+    if (!read_request(sk))
+    {
+        const char *resp = "HTTP/1.0 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+        send_all(sk, resp, strlen(resp));
+        return;
+    }
+
+    metrics_snapshot(&b);
+    if (b.error)
+    {
+        const char *resp = "HTTP/1.0 500 Internal Server Error\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+        send_all(sk, resp, strlen(resp));
+    }
+    else
+    {
+        _snprintf_0(header, "HTTP/1.0 200 OK\r\n"
+                    "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                    "Content-Length: %lu\r\nConnection: close\r\n\r\n", (unsigned long) b.len)
+        send_all(sk, header, strlen(header));
+        send_all(sk, b.data, b.len);
+    }
+    free(b.data);
+}
+
+static DWORD WINAPI
+MetricsThread(void *p)
+{
+    SOCKET sk = (SOCKET) p;
+
+    while (TRUE)
+    {
+        SOCKET client = accept(sk, NULL, NULL);
+        if (client == INVALID_SOCKET)
+        {
+            /* listening socket closed by metrics_stop */
+            if (WSAGetLastError() == WSAENOTSOCK || WSAGetLastError() == WSAEINTR)
+                break;
+            Sleep(100);
+            continue;
+        }
+        serve_client(client);
+        shutdown(client, SD_SEND);
+        closesocket(client);
+    }
+    return 0;
+}
+
+BOOL
+metrics_start(void)
+{
+    WSADATA wsaData;
+    BOOL opt = TRUE;
+
+    if (o.metrics_port == 0 || metrics_thread)
+        return true;
+
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0)
+        return false;
+
+    SOCKADDR_IN addr = {.sin_family = AF_INET, .sin_port = htons((u_short) o.metrics_port)};
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK); /* never listen on external interfaces */
+
+    listen_sk = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (listen_sk == INVALID_SOCKET)
+        goto err;
+
+    /* do not let another process hijack the port */
+    setsockopt(listen_sk, SOL_SOCKET, SO_EXCLUSIVEADDRUSE, (const char *) &opt, sizeof(opt));
+
+    if (bind(listen_sk, (SOCKADDR *) &addr, sizeof(addr)) != 0
+        || listen(listen_sk, 4) != 0)
+    {
+        goto err;
+    }
+
+    metrics_thread = CreateThread(NULL, 0, MetricsThread, (void *) listen_sk, 0, NULL);
+    if (!metrics_thread)
+        goto err;
+
+    PrintDebug(L"Metrics available at http://127.0.0.1:%lu/metrics", o.metrics_port);
+    return true;
+
+err:
+    MsgToEventLog(EVENTLOG_ERROR_TYPE, L"Failed to start metrics listener on port %lu (error = %d)",
+                  o.metrics_port, WSAGetLastError());
+    if (listen_sk != INVALID_SOCKET)
+        closesocket(listen_sk);
+    listen_sk = INVALID_SOCKET;
+    WSACleanup();
+    return false;
+}
+
+void
+metrics_stop(void)
+{
+    if (!metrics_thread)
+        return;
+
+    /* closing the socket unblocks accept() and the thread exits */
+    closesocket(listen_sk);
+    listen_sk = INVALID_SOCKET;
+    WaitForSingleObject(metrics_thread, 2000);
+    CloseHandle(metrics_thread);
+    metrics_thread = NULL;
+    WSACleanup();
+}
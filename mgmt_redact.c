@@ -0,0 +1,89 @@
+/*
+ *  OpenVPN-GUI -- A Windows GUI for OpenVPN.
+ *
+ *  Copyright (C) 2026 OpenVPN GUI contributors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program (see the file COPYING included with this
+ *  distribution); if not, write to the Free Software Foundation, Inc.,
+ *  59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <windows.h>
+#include <string.h>
+
+#include "main.h"
+#include "mgmt_redact.h"
+
+enum {
+    redact_undecided = 0,   /* line start may still match a prefix */
+    redact_masking,         /* mask the rest of the line */
+    redact_passing          /* keep the rest of the line */
+};
+
+/* Lines whose remainder after the prefix is masked */
+static const char *redact_prefix[] = {
+    ">PASSWORD:Auth-Token:",
+    ">PASSWORD:Verification Failed: 'Auth' ['CRV1:",
+    ">INFOMSG:WEB_AUTH:",
+    ">INFOMSG:OPEN_URL:",
+};
+
+/* Update the mode after a byte has been added to the line head */
+static int
+redact_classify(const mgmt_redact_t *r)
+{
+    int mode = redact_passing;
+
+    for (size_t i = 0; i < _countof(redact_prefix); i++)
+    {
+        size_t plen = strlen(redact_prefix[i]);
+        size_t n = min(plen, r->len);
+
+        if (memcmp(r->head, redact_prefix[i], n) != 0)
+            continue;
+        if (r->len == plen)
+            return redact_masking;
+        mode = redact_undecided;
+    }
+    return mode;
+}
+
+void
+mgmt_redact(mgmt_redact_t *r, char *data, size_t len)
+{
+    for (size_t i = 0; i < len; i++)
+    {
+        char ch = data[i];
+
+        if (ch == '\n')
+        {
+            r->len = 0;
+            r->mode = redact_undecided;
+        }
+        else if (r->mode == redact_masking)
+        {
+            if (!strchr(":,']\r", ch))
+                data[i] = 'A';
+        }
+        else if (r->mode == redact_undecided)
+        {
+            r->head[r->len++] = ch;
+            r->mode = redact_classify(r);
+        }
+    }
+}
@@ -0,0 +1,53 @@
+/*
+ *  OpenVPN-GUI -- A Windows GUI for OpenVPN.
+ *
+ *  Copyright (C) 2026 OpenVPN GUI contributors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program (see the file COPYING included with this
+ *  distribution); if not, write to the Free Software Foundation, Inc.,
+ *  59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MGMT_REDACT_H
+#define MGMT_REDACT_H
+
+/*
+ * Masking of secrets in management data before it is written to a
+ * recording. Uses no Windows API beyond basic types so that it can be
+ * tested on any host (see tests/).
+ */
+
+#include <windows.h>
+
+#define MGMT_REDACT_HEAD 48 /* longer than any line prefix that is masked */
+
+/*
+ * State carried from one chunk of data to the next, as a line may be
+ * split across chunks. A zeroed state starts at the beginning of a line.
+ */
+typedef struct {
+    char head[MGMT_REDACT_HEAD];   /* start of the current line */
+    size_t len;                    /* number of bytes in head */
+    int mode;                      /* see mgmt_redact.c */
+} mgmt_redact_t;
+
+/*
+ * Mask in place the secret part of lines carrying a pushed auth-token,
+ * a dynamic challenge state or a web auth URL. Letters, digits and
+ * other characters are replaced by 'A' while separators are kept, so
+ * that a replay still parses the line. The length of data is unchanged.
+ */
+void mgmt_redact(mgmt_redact_t *r, char *data, size_t len);
+
+#endif
@@ -28,6 +28,7 @@
 #include <tchar.h>
 #include <string.h>
 #include <stdlib.h>
+#include <limits.h>
 #include <malloc.h>
 #include <shellapi.h>
 #include <ws2tcpip.h>
@@ -43,89 +44,7 @@
 #include "openvpn-gui-res.h"
 #include "tray.h"
 #include "config_parser.h"
-
-/*
- * Helper function to do base64 conversion through CryptoAPI
- * Returns TRUE on success, FALSE on error. Caller must free *output.
- */
-BOOL
-Base64Encode(const char *input, int input_len, char **output)
-{
-    DWORD output_len;
-    DWORD flags = CRYPT_STRING_BASE64|CRYPT_STRING_NOCRLF;
-
-    if (input_len == 0)
-    {
-        /* set output to empty string  -- matches the behavior in openvpn */
-        *output = calloc (1, sizeof(char));
-        return TRUE;
-    }
-    if (!CryptBinaryToStringA((const BYTE *) input, (DWORD) input_len,
-        flags, NULL, &output_len) || output_len == 0)
-    {
-#ifdef DEBUG
-        PrintDebug (L"Error in CryptBinaryToStringA: input = '%.*hs'", input_len, input);
-#endif
-        *output = NULL;
-        return FALSE;
-    }
-    *output = (char *)malloc(output_len);
-    if (*output == NULL)
-        return FALSE;
-
-    if (!CryptBinaryToStringA((const BYTE *) input, (DWORD) input_len,
-        flags, *output, &output_len))
-    {
-#ifdef DEBUG
-        PrintDebug (L"Error in CryptBinaryToStringA: input = '%.*hs'", input_len, input);
-#endif
-        free(*output);
-        *output = NULL;
-        return FALSE;
-    }
-
-    return TRUE;
-}
-/*
- * Decode a nul-terminated base64 encoded input and save the result in
- * an allocated buffer *output. The caller must free *output after use.
- * The decoded output is nul-terminated so that the caller may treat
- * it as a string when appropriate.
- *
- * Return the length of the decoded result (excluding nul) or -1 on
- * error.
- */
-int
-Base64Decode(const char *input, char **output)
-{
-    DWORD len;
-
-    PrintDebug (L"decoding %hs", input);
-    if (!CryptStringToBinaryA(input, 0, CRYPT_STRING_BASE64_ANY,
-                              NULL, &len, NULL, NULL) || len == 0)
-    {
-        *output = NULL;
-        return -1;
-    }
-
-    *output = malloc(len + 1);
-    if (*output == NULL)
-        return -1;
-
-    if (!CryptStringToBinaryA(input, 0,
-        CRYPT_STRING_BASE64, (BYTE *) *output, &len, NULL, NULL))
-    {
-        free(*output);
-        *output = NULL;
-        return -1;
-    }
-
-    /* NUL terminate output */
-    (*output)[len] = '\0';
-    PrintDebug (L"Decoded output %hs", *output);
-
-    return len;
-}
+#include "env_set.h"
 
 BOOL
 GetDlgItemTextUtf8(HWND hDlg, int id, LPSTR *str, int *len)
@@ -164,48 +83,6 @@ out:
     return retval;
 }
 
-/**
- * Escape backslash, space and double-quote in a string
- * @param input  Pointer to the string to escape
- * @returns      A newly allocated string containing the result or NULL
- *               on error. Caller must free it after use.
- */
-char *
-escape_string(const char *input)
-{
-    char *out = strdup(input);
-    const char *esc = "\"\\ ";
-
-    if (!out)
-    {
-        MsgToEventLog(EVENTLOG_ERROR_TYPE, L"Error in escape_string: out of memory");
-        return NULL;
-    }
-
-    int len = strlen(out);
-
-    for (int pos = 0; pos < len; ++pos)
-    {
-        if (strchr(esc, out[pos]))
-        {
-            char *buf = realloc(out, ++len + 1);
-            if (buf == NULL)
-            {
-                free(out);
-                MsgToEventLog(EVENTLOG_ERROR_TYPE, L"Error in escape_string: out of memory");
-                return NULL;
-            }
-            out = buf;
-            memmove(out + pos + 1, out + pos, len - pos + 1);
-            out[pos] = '\\';
-            pos += 1;
-        }
-    }
-
-    PrintDebug(L"escape_string: in: '%hs' out: '%hs' len = %d", input, out, len);
-    return out;
-}
-
 /*
  * Generate a management command from user input and send it
  */
@@ -214,30 +91,19 @@ ManagementCommandFromInput(connection_t *c, LPCSTR fmt, HWND hDlg, int id)
 {
     BOOL retval = FALSE;
     LPSTR input, cmd;
-    int input_len, cmd_len;
+    int input_len;
 
     GetDlgItemTextUtf8(hDlg, id, &input, &input_len);
 
-    /* Escape input if needed */
-    char *input_e = escape_string(input);
-    if (!input_e)
-    {
-        goto out;
-    }
-    free(input);
-    input = input_e;
-    input_len = strlen(input);
-
-    cmd_len = input_len + strlen(fmt);
-    cmd = malloc(cmd_len);
+    /* Escape input and build the command in one buffer */
+    cmd = format_escaped(fmt, input);
     if (cmd)
     {
-        snprintf(cmd, cmd_len, fmt, input);
         retval = ManagementCommand(c, cmd, NULL, regular);
+        SecureZeroMemory(cmd, strlen(cmd));
         free(cmd);
     }
 
-out:
     /* Clear buffers with potentially secret content */
     if (input_len)
     {
@@ -427,11 +293,15 @@ ForceForegroundWindow(HWND hWnd)
 void
 DpiSetScale(options_t* options, UINT dpix)
 {
+    UINT old_scale = options->dpi_scale;
+
     /* scale factor in percentage compared to the reference dpi of 96 */
     if (dpix != 0)
         options->dpi_scale = MulDiv(dpix, 100, 96);
     else
         options->dpi_scale = 100;
+    if (options->dpi_scale != old_scale)
+        ClearIconCache();
     PrintDebug(L"DPI scale set to %u", options->dpi_scale);
 }
 
@@ -540,6 +410,69 @@ Widen(const char *utf8)
     return WidenEx(CP_UTF8, utf8);
 }
 
+/**
+ * Convert a NUL terminated narrow string to wide string into a caller
+ * supplied buffer of size wide chars. Returns the number of chars
+ * written including the NUL, or 0 on error or if the buffer is too small.
+ */
+int
+WidenTo(UINT codepage, const char *str, WCHAR *out, int size)
+{
+    if (!str || !out || size <= 0)
+        return 0;
+    return MultiByteToWideChar(codepage, 0, str, -1, out, size);
+}
+
+/**
+ * Convert a NUL terminated narrow string to wide string using the
+ * inline storage of wb when it fits and the heap otherwise. Returns
+ * wb->str or NULL on error. Call FreeWidebuf(wb) when done.
+ */
+WCHAR *
+WidenBuf(widebuf_t *wb, UINT codepage, const char *str)
+{
+    wb->str = NULL;
+    if (!str)
+        return NULL;
+
+    /* the common case: short string converted without a size probe */
+    if (WidenTo(codepage, str, wb->buf, _countof(wb->buf)) > 0)
+        wb->str = wb->buf;
+    else if (GetLastError() == ERROR_INSUFFICIENT_BUFFER)
+        wb->str = WidenEx(codepage, str);
+
+    return wb->str;
+}
+
+void
+FreeWidebuf(widebuf_t *wb)
+{
+    if (wb->str != wb->buf)
+        free(wb->str);
+    wb->str = NULL;
+}
+
+/**
+ * Same as WidenEx but the result is allocated from the arena a and
+ * released by arena_free(). Return NULL on error.
+ */
+WCHAR *
+WidenArena(arena_t *a, UINT codepage, const char *str)
+{
+    if (!str)
+        return NULL;
+
+    int nch = MultiByteToWideChar(codepage, 0, str, -1, NULL, 0);
+    if (nch <= 0)
+        return NULL;
+
+    WCHAR *wstr = arena_alloc(a, sizeof(WCHAR) * nch);
+    if (wstr && MultiByteToWideChar(codepage, 0, str, -1, wstr, nch) == 0)
+        wstr = NULL;
+
+    return wstr;
+}
+
 /* Return false if input contains any characters in exclude */
 BOOL
 validate_input(const WCHAR *input, const WCHAR *exclude)
@@ -651,8 +584,11 @@ md_final(md_ctx *ctx, BYTE *md)
 {
     DWORD status = 0;
 
-    DWORD digest_len = HASHLEN;
-    if (!CryptGetHashParam(ctx->hash, HP_HASHVAL, md, &digest_len, 0))
+    /* md must have room for the digest size of the algorithm in use */
+    DWORD digest_len = 0;
+    DWORD n = sizeof(digest_len);
+    if (!CryptGetHashParam(ctx->hash, HP_HASHSIZE, (BYTE *) &digest_len, &n, 0)
+        || !CryptGetHashParam(ctx->hash, HP_HASHVAL, md, &digest_len, 0))
     {
         status = GetLastError();
         MsgToEventLog(EVENTLOG_ERROR_TYPE, L"Error in md_final: status = %lu", status);
@@ -773,6 +709,7 @@ set_openssl_env_vars()
             WCHAR val[MAX_PATH] = {0};
             _sntprintf_0(val, L"%ls%ls", o.install_path, ossl_env[i].value);
             _wputenv_s(ossl_env[i].name, val);
+            env_process_changed();
         }
     }
 }
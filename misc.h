@@ -25,6 +25,7 @@
 #include <wincrypt.h>
 
 #include "options.h"
+#include "strutil.h"
 
 BOOL ManagementCommandFromInput(connection_t *, LPCSTR, HWND, int);
 BOOL ManagementCommandFromTwoInputsBase64(connection_t*, LPCSTR, HWND, int, int);
@@ -43,10 +44,21 @@ BOOL IsUserAdmin(VOID);
 HANDLE InitSemaphore (WCHAR *);
 BOOL CheckFileAccess (const TCHAR *path, int access);
 
-BOOL Base64Encode(const char *input, int input_len, char **output);
-int Base64Decode(const char *input, char **output);
 WCHAR *Widen(const char *utf8);
 WCHAR *WidenEx(UINT codepage, const char *utf8);
+
+/* Wide string with inline storage for short conversions */
+#define WIDEBUF_INLINE 256
+typedef struct {
+    WCHAR *str;                  /* points to buf or to heap memory */
+    WCHAR buf[WIDEBUF_INLINE];
+} widebuf_t;
+
+int WidenTo(UINT codepage, const char *str, WCHAR *out, int size);
+WCHAR *WidenBuf(widebuf_t *wb, UINT codepage, const char *str);
+void FreeWidebuf(widebuf_t *wb);
+
+WCHAR *WidenArena(arena_t *a, UINT codepage, const char *str);
 BOOL validate_input(const WCHAR *input, const WCHAR *exclude);
 /* Concatenate two wide strings with a separator */
 void wcs_concat2(WCHAR *dest, int len, const WCHAR *src1, const WCHAR *src2, const WCHAR *sep);
@@ -86,9 +98,6 @@ GetDlgItemTextUtf8(HWND hDlg, int id, LPSTR* str, int* len);
  */
 void set_openssl_env_vars(void);
 
-/* Return escaped copy of a string */
-char *escape_string(const char *str);
-
 /**
  * Find a free port to bind to
  * @param addr : Address to bind to -- if port >0 it's tried first.
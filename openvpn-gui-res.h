@@ -162,6 +162,11 @@
 #define ID_LVW_PKCS11                    451
 #define ID_TXT_PKCS11                    452
 
+/* Quick connect dialog */
+#define ID_DLG_QUICKCONNECT              460
+#define ID_EDT_QUICKCONNECT              461
+#define ID_LST_QUICKCONNECT              462
+
 /*
  * String Table Resources
  */
@@ -196,6 +201,7 @@
 #define IDS_MENU_IMPORT_AS              1026
 #define IDS_MENU_IMPORT_FILE            1027
 #define IDS_MENU_IMPORT_URL             1028
+#define IDS_MENU_QUICKCONNECT           1029
 
 /* LogViewer Dialog */
 #define IDS_ERR_START_LOG_VIEWER        1101
@@ -382,5 +388,6 @@
 
 /* Timer IDs */
 #define IDT_STOP_TIMER                  2500  /* Timer used to trigger force termination */
+#define IDT_MGMT_REPLAY                 2501  /* Timer used to pace replay of management data */
 
 #endif
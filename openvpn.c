@@ -61,6 +61,8 @@
 #include "env_set.h"
 #include "echo.h"
 #include "pkcs11.h"
+#include "trace.h"
+#include "replay.h"
 
 #define OPENVPN_SERVICE_PIPE_NAME_OVPN2 L"\\\\.\\pipe\\openvpn\\service"
 #define OPENVPN_SERVICE_PIPE_NAME_OVPN3 L"\\\\.\\pipe\\ovpnagent"
@@ -69,20 +71,19 @@ extern options_t o;
 
 static BOOL TerminateOpenVPN(connection_t *c);
 static BOOL LaunchOpenVPN(connection_t *c);
+static void ConnectionDone(connection_t *c);
+static void OpenStatusWindow(connection_t *c);
+static void CloseStatusWindow(connection_t *c);
+static void DisconnectDaemon(connection_t *c);
 
 const TCHAR *cfgProp = _T("conn");
 
-void
-free_auth_param (auth_param_t *param)
-{
-    if (!param)
-        return;
-    free (param->str);
-    free (param->id);
-    free (param->user);
-    free (param->cr_response);
-    free (param);
-}
+/* Interval in seconds for bytecount reports while the status window is
+ * visible. While hidden, the reports are turned off as nobody is looking.
+ */
+#define BYTECOUNT_INTERVAL_VISIBLE 5
+#define BYTECOUNT_INTERVAL_HIDDEN  0
+#define BYTECOUNT_INTERVAL_METRICS 15  /* keeps counters fresh for the metrics endpoint */
 
 void
 AppendTextToCaption (HANDLE hwnd, const WCHAR *str)
@@ -110,6 +111,191 @@ show_error_tip(HWND editbox, const WCHAR *msg)
     SendMessage(editbox, EM_SHOWBALLOONTIP, 0, (LPARAM)&bt);
 }
 
+/*
+ * Ask the daemon to report bytecount at an interval suited to
+ * the visibility of the status window. The command is sent only
+ * if the interval differs from what was last requested.
+ */
+static void
+SetBytecountInterval(connection_t *c, BOOL visible)
+{
+    char cmd[32];
+    int interval = visible ? BYTECOUNT_INTERVAL_VISIBLE :
+                   (o.metrics_port ? BYTECOUNT_INTERVAL_METRICS : BYTECOUNT_INTERVAL_HIDDEN);
+
+    /* management interface not ready for input */
+    if (c->manage.connected < 2 || interval == c->bytecount_interval)
+        return;
+
+    _snprintf_0(cmd, "bytecount %d", interval)
+    if (ManagementCommand(c, cmd, NULL, regular))
+        c->bytecount_interval = interval;
+}
+
+/*
+ * The status window of a connection is created only while the user looks
+ * at it. What it shows is kept in the connection: the status text, icon
+ * and button states in c->status, and recent log lines in c->log. The
+ * setters below update that state and the window, if one is open.
+ */
+void
+SetStatusText(connection_t *c, UINT id)
+{
+    c->status.text = id;
+    SetDlgItemText(c->hwndStatus, ID_TXT_STATUS, LoadLocalizedString(id));
+}
+
+static void
+SetStatusIcon(connection_t *c, int icon)
+{
+    c->status.icon = icon;
+    if (c->hwndStatus)
+        SetStatusWinIcon(c->hwndStatus, icon);
+}
+
+static void
+SetStatusButton(connection_t *c, int id, BOOL enable)
+{
+    if (id == ID_DISCONNECT)
+        c->status.disconnect = enable;
+    else if (id == ID_RESTART)
+        c->status.restart = enable;
+    EnableWindow(GetDlgItem(c->hwndStatus, id), enable);
+}
+
+/* Show the assigned addresses while connected, else clear them */
+static void
+SetStatusIP(connection_t *c)
+{
+    WCHAR ip_txt[256] = L"";
+
+    if (c->state == connected)
+    {
+        WCHAR ip[64];
+        wcs_concat2(ip, _countof(ip), c->ip, c->ipv6, L", ");
+        LoadLocalizedStringBuf(ip_txt, _countof(ip_txt), IDS_NFO_ASSIGN_IP, ip);
+    }
+    SetDlgItemTextW(c->hwndStatus, ID_TXT_IP, ip_txt);
+}
+
+/* Lines of the status window log, kept while the window is not shown */
+struct status_log {
+    struct {
+        WCHAR *text;
+        COLORREF clr;           /* 0 for the default color */
+    } line[MAX_LOG_LINES];
+    unsigned int count;         /* number of lines ever added */
+    unsigned int shown;         /* number of lines added to the open status window */
+};
+
+static void
+AppendLogLine(HWND logWnd, const WCHAR *text, COLORREF clr)
+{
+    CHARFORMAT cfm = {
+        .cbSize = sizeof(CHARFORMAT),
+        .dwMask = CFM_COLOR|CFM_BOLD,
+        .dwEffects = clr ? 0 : CFE_AUTOCOLOR,
+        .crTextColor = clr,
+    };
+
+    /* Remove lines from log window if it is getting full */
+    if (SendMessage(logWnd, EM_GETLINECOUNT, 0, 0) > MAX_LOG_LINES)
+    {
+        int pos = SendMessage(logWnd, EM_LINEINDEX, DEL_LOG_LINES, 0);
+        SendMessage(logWnd, EM_SETSEL, 0, pos);
+        SendMessage(logWnd, EM_REPLACESEL, FALSE, (LPARAM) _T(""));
+    }
+
+    /* deselect current selection, if any */
+    SendMessage(logWnd, EM_SETSEL, (WPARAM) -1, (LPARAM) -1);
+    SendMessage(logWnd, EM_SETCHARFORMAT, SCF_SELECTION, (LPARAM) &cfm);
+
+    /* Append line to log window */
+    SendMessage(logWnd, EM_REPLACESEL, FALSE, (LPARAM) text);
+    SendMessage(logWnd, EM_REPLACESEL, FALSE, (LPARAM) L"\n");
+}
+
+/*
+ * Add the log lines not yet shown to the open status window, or all
+ * kept lines if reset is true. Runs on the worker hosting the connection.
+ */
+static void
+StatusLogShow(connection_t *c, BOOL reset)
+{
+    HWND logWnd = GetDlgItem(c->hwndStatus, ID_EDT_LOG);
+    if (!logWnd)
+        return;
+
+    AcquireSRWLockExclusive(&c->log_lock);
+    struct status_log *log = c->log;
+    if (log)
+    {
+        unsigned int i = reset ? 0 : log->shown;
+        if (log->count - i > MAX_LOG_LINES)
+            i = log->count - MAX_LOG_LINES;
+        for ( ; i < log->count; i++)
+            AppendLogLine(logWnd, log->line[i % MAX_LOG_LINES].text, log->line[i % MAX_LOG_LINES].clr);
+        log->shown = log->count;
+    }
+    ReleaseSRWLockExclusive(&c->log_lock);
+}
+
+/*
+ * Keep a heap allocated log line, which is taken over, and show it if
+ * the status window is open. Any thread.
+ */
+static void
+StatusLogKeep(connection_t *c, WCHAR *line, COLORREF clr)
+{
+    AcquireSRWLockExclusive(&c->log_lock);
+    if (!c->log)
+        c->log = calloc(1, sizeof(*c->log));
+    if (c->log)
+    {
+        unsigned int i = c->log->count++ % MAX_LOG_LINES;
+        free(c->log->line[i].text);
+        c->log->line[i].text = line;
+        c->log->line[i].clr = clr;
+        line = NULL;
+    }
+    ReleaseSRWLockExclusive(&c->log_lock);
+    free(line);
+
+    if (!c->hwndStatus)
+        return;
+    if (GetCurrentThreadId() == c->threadId)
+        StatusLogShow(c, FALSE);
+    else
+        PostMessage(c->hwndConn, WM_OVPN_STATUSLOG, 0, 0);
+}
+
+/* Keep a log line made of the given parts */
+static void
+StatusLogAdd(connection_t *c, const WCHAR *datetime, const WCHAR *prefix,
+             const WCHAR *text, COLORREF clr)
+{
+    size_t len = wcslen(datetime) + wcslen(prefix) + wcslen(text) + 1;
+    WCHAR *line = malloc(len * sizeof(WCHAR));
+    if (!line)
+        return;
+    swprintf(line, len, L"%ls%ls%ls", datetime, prefix, text);
+    StatusLogKeep(c, line, clr);
+}
+
+static void
+StatusLogFree(connection_t *c)
+{
+    AcquireSRWLockExclusive(&c->log_lock);
+    if (c->log)
+    {
+        for (int i = 0; i < MAX_LOG_LINES; i++)
+            free(c->log->line[i].text);
+        free(c->log);
+        c->log = NULL;
+    }
+    ReleaseSRWLockExclusive(&c->log_lock);
+}
+
 /*
  * Receive banner on connection to management interface
  * Format: <BANNER>
@@ -120,11 +306,16 @@ OnReady(connection_t *c, UNUSED char *msg)
     ManagementCommand(c, "state on", NULL, regular);
     ManagementCommand(c, "log on all", OnLogLine, combined);
     ManagementCommand(c, "echo on all", OnEcho, combined);
-    ManagementCommand(c, "bytecount 5", NULL, regular);
+
+    c->bytecount_interval = -1; /* force sending the bytecount command */
+    SetBytecountInterval(c, IsWindowVisible(c->hwndStatus));
 
     /* ask for the current state, especially useful when the daemon was prestarted */
     ManagementCommand(c, "state", OnStateChange, regular);
 
+    if (c->flags & FLAG_DAEMON_PERSISTENT)
+        c->attach_tick = GetTickCount64();
+
     if (c->flags & FLAG_DAEMON_PERSISTENT
         && o.enable_persistent == 2)
     {
@@ -139,20 +330,20 @@ OnReady(connection_t *c, UNUSED char *msg)
 void
 OnHold(connection_t *c, UNUSED char *msg)
 {
-    EnableWindow(GetDlgItem(c->hwndStatus, ID_RESTART), TRUE);
+    SetStatusButton(c, ID_RESTART, TRUE);
     if ((c->flags & FLAG_DAEMON_PERSISTENT)
         && (c->state == disconnecting || c->state == resuming))
     {
         /* retain the hold state if we are here while disconnecting  */
-        c->state = onhold;
+        SetConnState(c, onhold);
         SetMenuStatus(c, onhold);
-        SetDlgItemText(c->hwndStatus, ID_TXT_STATUS, LoadLocalizedString(IDS_NFO_STATE_ONHOLD));
-        SetStatusWinIcon(c->hwndStatus, ID_ICO_DISCONNECTED);
-        EnableWindow(GetDlgItem(c->hwndStatus, ID_DISCONNECT), FALSE);
+        SetStatusText(c, IDS_NFO_STATE_ONHOLD);
+        SetStatusIcon(c, ID_ICO_DISCONNECTED);
+        SetStatusButton(c, ID_DISCONNECT, FALSE);
         CheckAndSetTrayIcon();
         return;
     }
-    EnableWindow(GetDlgItem(c->hwndStatus, ID_DISCONNECT), TRUE);
+    SetStatusButton(c, ID_DISCONNECT, TRUE);
     ManagementCommand(c, "hold off", NULL, regular);
     ManagementCommand(c, "hold release", NULL, regular);
 }
@@ -164,14 +355,9 @@ OnHold(connection_t *c, UNUSED char *msg)
 void
 OnLogLine(connection_t *c, char *line)
 {
-    HWND logWnd = GetDlgItem(c->hwndStatus, ID_EDT_LOG);
     char *flags, *message;
     time_t timestamp;
     TCHAR *datetime;
-    const SETTEXTEX ste = {
-        .flags = ST_SELECTION,
-        .codepage = CP_UTF8
-    };
 
     flags = strchr(line, ',') + 1;
     if (flags - 1 == NULL)
@@ -182,21 +368,10 @@ OnLogLine(connection_t *c, char *line)
         return;
     size_t flag_size = message - flags - 1; /* message is always > flags */
 
-    /* Remove lines from log window if it is getting full */
-    if (SendMessage(logWnd, EM_GETLINECOUNT, 0, 0) > MAX_LOG_LINES)
-    {
-        int pos = SendMessage(logWnd, EM_LINEINDEX, DEL_LOG_LINES, 0);
-        SendMessage(logWnd, EM_SETSEL, 0, pos);
-        SendMessage(logWnd, EM_REPLACESEL, FALSE, (LPARAM) _T(""));
-    }
-
     timestamp = strtol(line, NULL, 10);
     datetime = _tctime(&timestamp);
     datetime[24] = _T(' ');
 
-    /* deselect current selection, if any */
-    SendMessage(logWnd, EM_SETSEL, (WPARAM) -1, (LPARAM) -1);
-
     /* change text color if Warning or Error */
     COLORREF text_clr = 0;
 
@@ -205,20 +380,17 @@ OnLogLine(connection_t *c, char *line)
     else if (memchr(flags, 'W', flag_size))
         text_clr = o.clr_warning;
 
-    if (text_clr != 0)
-    {
-        CHARFORMAT cfm = { .cbSize = sizeof(CHARFORMAT),
-                           .dwMask = CFM_COLOR|CFM_BOLD,
-                           .dwEffects = 0,
-                           .crTextColor = text_clr,
-                         };
-        SendMessage(logWnd, EM_SETCHARFORMAT, SCF_SELECTION, (LPARAM) &cfm);
-    }
-
-    /* Append line to log window */
-    SendMessage(logWnd, EM_REPLACESEL, FALSE, (LPARAM) datetime);
-    SendMessage(logWnd, EM_SETTEXTEX, (WPARAM) &ste, (LPARAM) message);
-    SendMessage(logWnd, EM_REPLACESEL, FALSE, (LPARAM) _T("\n"));
+    /* convert the message straight into the line that is kept: no temporary copy */
+    size_t n = wcslen(datetime);
+    size_t len = n + strlen(message) + 1; /* UTF-8 never needs more UTF-16 units than bytes */
+    WCHAR *text = malloc(len * sizeof(WCHAR));
+    if (!text)
+        return;
+    wcscpy(text, datetime);
+    if (WidenTo(CP_UTF8, message, text + n, (int) (len - n)) > 0)
+        StatusLogKeep(c, text, text_clr);
+    else
+        free(text);
 }
 
 /* expect ipv4,remote,port,,,ipv6 */
@@ -263,6 +435,94 @@ parse_assigned_ip(connection_t *c, const char *msg)
     }
 }
 
+/* Connection phases derived from the state timeline. Each phase
+ * extends from the first occurrence of the start state to that of
+ * the end state.
+ */
+static const struct {
+    const char *name;
+    const char *start;
+    const char *end;
+} state_phases[] = {
+    {"tls-handshake", "WAIT", "AUTH"},
+    {"auth", "AUTH", "GET_CONFIG"},
+    {"get-config", "GET_CONFIG", "ASSIGN_IP"},
+    {"assign-ip", "ASSIGN_IP", "ADD_ROUTES"},
+    {"add-routes", "ADD_ROUTES", "CONNECTED"},
+};
+
+/* Add a daemon state to the timeline of the current connection attempt */
+static void
+RecordStateChange(connection_t *c, const char *state)
+{
+    /* a new attempt starts with RECONNECTING: discard the previous one */
+    if (strcmp(state, "RECONNECTING") == 0)
+    {
+        c->timeline.count = 0;
+        c->reconnects++;
+    }
+
+    /* if full, keep overwriting the last entry */
+    int i = min(c->timeline.count, MAX_STATE_MARKS - 1);
+
+    strncpy_s(c->timeline.mark[i].state, _countof(c->timeline.mark[i].state), state, _TRUNCATE);
+    c->timeline.mark[i].tick = GetTickCount64();
+    c->timeline.count = i + 1;
+}
+
+/* Return the index of the first occurrence of state in the timeline or -1 */
+static int
+FindStateMark(const connection_t *c, const char *state)
+{
+    for (int i = 0; i < c->timeline.count; i++)
+    {
+        if (strcmp(c->timeline.mark[i].state, state) == 0)
+            return i;
+    }
+    return -1;
+}
+
+LONGLONG
+GetStatePhaseDuration(const connection_t *c, const char *start, const char *end)
+{
+    int i = start ? FindStateMark(c, start) : (c->timeline.count > 0 ? 0 : -1);
+    int j = FindStateMark(c, end);
+
+    if (i < 0 || j < i)
+        return -1;
+    return (LONGLONG) (c->timeline.mark[j].tick - c->timeline.mark[i].tick);
+}
+
+int
+FormatStatePhases(const connection_t *c, wchar_t *buf, size_t len)
+{
+    int n = 0;
+    LONGLONG total = GetStatePhaseDuration(c, NULL, "CONNECTED");
+
+    if (len == 0)
+        return 0;
+    buf[0] = L'\0';
+
+    /* nothing to report if we attached to an already connected daemon */
+    if (total <= 0)
+        return 0;
+
+    n = swprintf(buf, len, L"total %.3f s", total/1000.0);
+    for (size_t i = 0; i < _countof(state_phases) && n > 0 && (size_t) n < len; i++)
+    {
+        LONGLONG t = GetStatePhaseDuration(c, state_phases[i].start, state_phases[i].end);
+        if (t < 0)
+            continue;
+        int m = swprintf(buf + n, len - n, L", %hs %.3f s", state_phases[i].name, t/1000.0);
+        if (m < 0)
+            break;
+        n += m;
+    }
+    buf[len - 1] = L'\0';
+
+    return (n > 0) ? n : 0;
+}
+
 /*
  * Send a custom message to Window hwnd when state changes
  * hwnd : handle of the window to which the message is sent
@@ -309,7 +569,10 @@ OnStateChange(connection_t *c, char *data)
     /* notify the all windows in the thread of state change */
     EnumThreadWindows(GetCurrentThreadId(), NotifyStateChange, (LPARAM) state);
 
+    AcquireSRWLockExclusive(&c->stats_lock);
     strncpy_s(c->daemon_state, _countof(c->daemon_state), state, _TRUNCATE);
+    RecordStateChange(c, state);
+    ReleaseSRWLockExclusive(&c->stats_lock);
 
     if (strcmp(state, "CONNECTED") == 0)
     {
@@ -344,17 +607,24 @@ OnStateChange(connection_t *c, char *data)
         c->connected_since = atoi(data);
         c->failed_psw_attempts = 0;
         c->failed_auth_attempts = 0;
-        c->state = connected;
+        c->start_retry = false;
+        c->start_attempts = 0;
+        SetConnState(c, connected);
 
         SetMenuStatus(c, connected);
         SetTrayIcon(connected);
 
-        SetDlgItemText(c->hwndStatus, ID_TXT_STATUS, LoadLocalizedString(IDS_NFO_STATE_CONNECTED));
-        SetDlgItemTextW(c->hwndStatus, ID_TXT_IP, ip_txt);
-        SetStatusWinIcon(c->hwndStatus, ID_ICO_CONNECTED);
+        SetStatusText(c, IDS_NFO_STATE_CONNECTED);
+        SetStatusIP(c);
+        SetStatusIcon(c, ID_ICO_CONNECTED);
 
-        /* Hide Status Window */
-        ShowWindow(c->hwndStatus, SW_HIDE);
+        /* Show time spent in each phase of connection setup and save it in the log */
+        WCHAR phases[256];
+        if (FormatStatePhases(c, phases, _countof(phases)) > 0)
+            WriteStatusLog(c, L"GUI> Connection setup time: ", phases, true);
+
+        /* Close Status Window */
+        CloseStatusWindow(c);
     }
     else if (strcmp(state, "RECONNECTING") == 0)
     {
@@ -370,15 +640,15 @@ OnStateChange(connection_t *c, char *data)
         // We change the state to reconnecting only if there was a prior successful connection.
         if (c->state == connected)
         {
-            c->state = reconnecting;
+            SetConnState(c, reconnecting);
 
             // Update the tray icon
             CheckAndSetTrayIcon();
 
             // And the texts in the status window
-            SetDlgItemText(c->hwndStatus, ID_TXT_STATUS, LoadLocalizedString(IDS_NFO_STATE_RECONNECTING));
-            SetDlgItemTextW(c->hwndStatus, ID_TXT_IP, L"");
-            SetStatusWinIcon(c->hwndStatus, ID_ICO_CONNECTING);
+            SetStatusText(c, IDS_NFO_STATE_RECONNECTING);
+            SetStatusIP(c);
+            SetStatusIcon(c, ID_ICO_CONNECTING);
         }
     }
 }
@@ -771,13 +1041,9 @@ GenericPassDialogFunc(HWND hwndDlg, UINT msg, WPARAM wParam, LPARAM lParam)
             if (param->flags & FLAG_CR_TYPE_CRV1)
             {
                 /* send username */
-                template = "username \"Auth\" \"%s\"";
-                char *username = escape_string(param->user);
-                fmt = malloc(strlen(template) + strlen(username));
-
-                if (fmt && username)
+                fmt = format_escaped("username \"Auth\" \"%s\"", param->user);
+                if (fmt)
                 {
-                    sprintf(fmt, template, username);
                     ManagementCommand(param->c, fmt, NULL, regular);
                 }
                 else /* no memory? send an emty username and let it error out */
@@ -787,7 +1053,6 @@ GenericPassDialogFunc(HWND hwndDlg, UINT msg, WPARAM wParam, LPARAM lParam)
                     ManagementCommand(param->c, "username \"Auth\" \"user\"", NULL, regular);
                 }
                 free(fmt);
-                free(username);
 
                 /* password template */
                 template = "password \"Auth\" \"CRV1::%s::%%s\"";
@@ -968,161 +1233,6 @@ free_dynamic_cr (connection_t *c)
     c->dynamic_cr = NULL;
 }
 
-/*
- * Parse dynamic challenge string received from the server. Returns
- * true on success. The caller must free param->str and param->id
- * even on error.
- */
-BOOL
-parse_dynamic_cr (const char *str, auth_param_t *param)
-{
-    BOOL ret = FALSE;
-    char *token[4] = {0};
-    char *p = strdup (str);
-
-    int i;
-    char *p1;
-
-    if (!param || !p) goto out;
-
-    /* expected: str = "E,R:challenge_id:user_b64:challenge_str" */
-    const char *delim = ":";
-    for (i = 0, p1 = p; i < 4; ++i, p1 = NULL)
-    {
-        if (i == 3)
-            delim = "" ; /* take the entire trailing string as the challenge */
-        token[i] = strtok (p1, delim); /* strtok is thread-safe on Windows */
-        if (!token[i])
-        {
-            WriteStatusLog(param->c, L"GUI> ", L"Error parsing dynamic challenge string", false);
-            goto out;
-        }
-    }
-
-    if (Base64Decode(token[2], &param->user) < 0)
-    {
-        WriteStatusLog(param->c, L"GUI> ", L"Error decoding the username in dynamic challenge string", false);
-        goto out;
-    }
-
-    param->flags |= FLAG_CR_TYPE_CRV1;
-    param->flags |= strchr(token[0], 'E') ? FLAG_CR_ECHO : 0;
-    param->flags |= strchr(token[0], 'R') ? FLAG_CR_RESPONSE : 0;
-    param->id = strdup(token[1]);
-    param->str = strdup(token[3]);
-    if (!param->id || !param->str)
-        goto out;
-
-    ret = TRUE;
-
-out:
-    free (p);
-    return ret;
-}
-
-/*
- * Parse crtext string received from the server. Returns
- * true on success. The caller must free param->str even on error.
- */
-static BOOL
-parse_crtext (const char* str, auth_param_t* param)
-{
-    BOOL ret = FALSE;
-    char* token[2] = { 0 };
-    char* p = strdup(str);
-    char* p1;
-
-    if (!param || !p) goto out;
-
-    /* expected: str = "E,R:challenge_str" */
-    token[0] = p;
-    p1 = strchr(p, ':');
-    if (!p1)
-    {
-        WriteStatusLog(param->c, L"GUI> ", L"Error parsing crtext challenge string", false);
-        goto out;
-    }
-
-    *p1 = '\0';
-    token[1] = p1 + 1;
-
-    param->flags |= FLAG_CR_TYPE_CRTEXT;
-    param->flags |= strchr(token[0], 'E') ? FLAG_CR_ECHO : 0;
-    param->flags |= strchr(token[0], 'R') ? FLAG_CR_RESPONSE : 0;
-    param->str = strdup(token[1]);
-    if (!param->str)
-        goto out;
-
-    ret = TRUE;
-
-out:
-    free(p);
-    return ret;
-}
-
-/*
- * Parse password or string request of the form "Need 'What' password/string MSG:message"
- * and assign param->id = What, param->str = message. Also set param->flags if the type
- * of the requested info is known. If message is empty param->id is copied to param->str.
- * Return true on succsess. The caller must free param even when the function fails.
- */
-static BOOL
-parse_input_request (const char *msg, auth_param_t *param)
-{
-    BOOL ret = FALSE;
-    char *p = strdup (msg);
-    char *sep[4] = {" ", "'", " ", ""}; /* separators to use to break up msg */
-    char *token[4];
-
-    char *p1 = p;
-    for (int i = 0; i < 4; ++i, p1 = NULL)
-    {
-        token[i] = strtok (p1, sep[i]); /* strtok is thread-safe on Windows */
-        if (!token[i] && i < 3) /* first three tokens required */
-            goto out;
-    }
-    if (token[3] && strncmp(token[3], "MSG:", 4) == 0)
-        token[3] += 4;
-    if (!token[3] || !*token[3]) /* use id as the description if none provided */
-        token[3] = token[1];
-
-    PrintDebug (L"Tokens: '%hs' '%hs' '%hs' '%hs'", token[0], token[1],
-                token[2], token[3]);
-
-    if (strcmp (token[0], "Need") != 0)
-        goto out;
-
-    if ((param->id = strdup(token[1])) == NULL)
-        goto out;
-
-    if (strcmp(token[2], "password") == 0)
-    {
-        if (strcmp (param->id, "Private Key") == 0)
-            param->flags |= FLAG_PASS_PKEY;
-        else
-            param->flags |= FLAG_PASS_TOKEN;
-    }
-    else if (strcmp(token[2], "string") == 0
-             && strcmp (param->id, "pkcs11-id-request") == 0)
-    {
-        param->flags |= FLAG_STRING_PKCS11;
-    }
-
-    param->str = strdup (token[3]);
-    if (param->str == NULL)
-        goto out;
-
-    PrintDebug (L"parse_input_request: id = '%hs' str = '%hs' flags = %u",
-                param->id, param->str, param->flags);
-    ret = TRUE;
-
-out:
-    free (p);
-    if (!ret)
-        PrintDebug (L"Error parsing password/string request msg: <%hs>", msg);
-    return ret;
-}
-
 /*
  * Handle >ECHO: request from OpenVPN management interface
  * Expect msg = timestamp,message
@@ -1223,7 +1333,7 @@ OnPassword(connection_t *c, char *msg)
         {
             param->flags |= FLAG_CR_TYPE_SCRV1;
             param->flags |= (*(chstr + 3) != '0') ? FLAG_CR_ECHO : 0;
-            param->str = strdup(chstr + 5);
+            param->str = arena_strdup(&param->arena, chstr + 5);
             LocalizedDialogBoxParam(ID_DLG_AUTH_CHALLENGE, UserAuthDialogFunc, (LPARAM) param);
         }
         else
@@ -1274,14 +1384,11 @@ OnTimeout(connection_t *c, UNUSED char *msg)
      * The user can terminate by pressing disconnect.
      */
     if (o.silent_connection == 0)
-    {
-        SetForegroundWindow(c->hwndStatus);
-        ShowWindow(c->hwndStatus, SW_SHOW);
-    }
+        OpenStatusWindow(c);
     WriteStatusLog (c, L"GUI> ", LoadLocalizedString(IDS_NFO_CONN_TIMEOUT, c->log_path), false);
     WriteStatusLog (c, L"GUI> ", L"Retrying. Press disconnect to abort", false);
-    c->state = connecting;
-    if (!OpenManagement(c))
+    SetConnState(c, connecting);
+    if (c->manage.replay ? !mgmt_replay_open(c) : !OpenManagement(c))
     {
         MessageBoxEx(NULL, L"Failed to open management", _T(PACKAGE_NAME),
                      MB_OK|MB_SETFOREGROUND|MB_ICONERROR, GetGUILanguage());
@@ -1297,6 +1404,8 @@ void
 OnStop(connection_t *c, UNUSED char *msg)
 {
     UINT txt_id, msg_id;
+    BOOL retry = c->start_retry;
+    c->start_retry = false;
     SetMenuStatus(c, disconnected);
 
     switch (c->state)
@@ -1305,20 +1414,17 @@ OnStop(connection_t *c, UNUSED char *msg)
         /* OpenVPN process ended unexpectedly */
         c->failed_psw_attempts = 0;
         c->failed_auth_attempts = 0;
-        c->state = disconnected;
+        SetConnState(c, disconnected);
         CheckAndSetTrayIcon();
-        SetDlgItemText(c->hwndStatus, ID_TXT_STATUS, LoadLocalizedString(IDS_NFO_STATE_DISCONNECTED));
-        SetStatusWinIcon(c->hwndStatus, ID_ICO_DISCONNECTED);
-        EnableWindow(GetDlgItem(c->hwndStatus, ID_DISCONNECT), FALSE);
-        EnableWindow(GetDlgItem(c->hwndStatus, ID_RESTART), FALSE);
+        SetStatusText(c, IDS_NFO_STATE_DISCONNECTED);
+        SetStatusIcon(c, ID_ICO_DISCONNECTED);
+        SetStatusButton(c, ID_DISCONNECT, FALSE);
+        SetStatusButton(c, ID_RESTART, FALSE);
         if (o.silent_connection == 0)
-        {
-            SetForegroundWindow(c->hwndStatus);
-            ShowWindow(c->hwndStatus, SW_SHOW);
-        }
+            OpenStatusWindow(c);
         MessageBox(c->hwndStatus, LoadLocalizedString(IDS_NFO_CONN_TERMINATED, c->config_file),
                    _T(PACKAGE_NAME), MB_OK);
-        SendMessage(c->hwndStatus, WM_CLOSE, 0, 0);
+        SendMessage(c->hwndConn, WM_CLOSE, 0, 0);
         break;
 
     case resuming:
@@ -1328,49 +1434,51 @@ OnStop(connection_t *c, UNUSED char *msg)
         txt_id = c->state == reconnecting ? IDS_NFO_STATE_FAILED_RECONN : IDS_NFO_STATE_FAILED;
         msg_id = c->state == reconnecting ? IDS_NFO_RECONN_FAILED : IDS_NFO_CONN_FAILED;
 
-        c->state = disconnecting;
+        SetConnState(c, disconnecting);
         CheckAndSetTrayIcon();
-        c->state = disconnected;
-        EnableWindow(GetDlgItem(c->hwndStatus, ID_DISCONNECT), FALSE);
-        EnableWindow(GetDlgItem(c->hwndStatus, ID_RESTART), FALSE);
-        SetStatusWinIcon(c->hwndStatus, ID_ICO_DISCONNECTED);
-        SetDlgItemText(c->hwndStatus, ID_TXT_STATUS, LoadLocalizedString(txt_id));
+        SetConnState(c, disconnected);
+        SetStatusButton(c, ID_DISCONNECT, FALSE);
+        SetStatusButton(c, ID_RESTART, FALSE);
+        SetStatusIcon(c, ID_ICO_DISCONNECTED);
+        SetStatusText(c, txt_id);
+
+        /* queue it again if it was started from the start queue */
+        if (retry)
+            PostMessage(o.hWnd, WM_OVPN_START_FAILED, (WPARAM) (c - o.conn), 0);
+
         if (o.silent_connection == 0)
-        {
-            SetForegroundWindow(c->hwndStatus);
-            ShowWindow(c->hwndStatus, SW_SHOW);
-        }
+            OpenStatusWindow(c);
         MessageBox(c->hwndStatus, LoadLocalizedString(msg_id, c->config_name), _T(PACKAGE_NAME), MB_OK);
-        SendMessage(c->hwndStatus, WM_CLOSE, 0, 0);
+        SendMessage(c->hwndConn, WM_CLOSE, 0, 0);
         break;
 
     case disconnecting:
         /* Shutdown was initiated by us */
         c->failed_psw_attempts = 0;
         c->failed_auth_attempts = 0;
-        c->state = disconnected;
+        SetConnState(c, disconnected);
         if (c->flags & FLAG_DAEMON_PERSISTENT)
         {
             /* user initiated disconnection -- stay detached and do not auto-reconnect */
             c->auto_connect = false;
         }
         CheckAndSetTrayIcon();
-        SetDlgItemText(c->hwndStatus, ID_TXT_STATUS, LoadLocalizedString(IDS_NFO_STATE_DISCONNECTED));
-        SendMessage(c->hwndStatus, WM_CLOSE, 0, 0);
+        SetStatusText(c, IDS_NFO_STATE_DISCONNECTED);
+        SendMessage(c->hwndConn, WM_CLOSE, 0, 0);
         break;
 
     case onhold:
         /* stop triggered while on hold -- possibly the daemon exited. Treat same as detaching */
     case detaching:
-        c->state = disconnected;
+        SetConnState(c, disconnected);
         CheckAndSetTrayIcon();
-        SendMessage(c->hwndStatus, WM_CLOSE, 0, 0);
+        SendMessage(c->hwndConn, WM_CLOSE, 0, 0);
         break;
 
     case suspending:
-        c->state = suspended;
+        SetConnState(c, suspended);
         CheckAndSetTrayIcon();
-        SetDlgItemText(c->hwndStatus, ID_TXT_STATUS, LoadLocalizedString(IDS_NFO_STATE_SUSPENDED));
+        SetStatusText(c, IDS_NFO_STATE_SUSPENDED);
         break;
 
     default:
@@ -1408,19 +1516,34 @@ format_bytecount(wchar_t *buf, size_t len, unsigned long long c)
     return buf;
 }
 
+static void
+SetStatusByteCount(connection_t *c)
+{
+    wchar_t in[32], out[32];
+
+    if (!c->hwndStatus)
+        return;
+    format_bytecount(in, _countof(in), c->bytes_in);
+    format_bytecount(out, _countof(out), c->bytes_out);
+    SetDlgItemTextW(c->hwndStatus, ID_TXT_BYTECOUNT,
+            LoadLocalizedString(IDS_NFO_BYTECOUNT, in, out));
+}
+
 /*
  * Handle bytecount report from OpenVPN
  * Expect bytes-in,bytes-out
  */
 void OnByteCount(connection_t *c, char *msg)
 {
-    if (!msg || sscanf(msg, "%I64u,%I64u", &c->bytes_in, &c->bytes_out) != 2)
+    unsigned long long in, out;
+
+    if (!msg || sscanf(msg, "%I64u,%I64u", &in, &out) != 2)
         return;
-    wchar_t in[32], out[32];
-    format_bytecount(in, _countof(in), c->bytes_in);
-    format_bytecount(out, _countof(out), c->bytes_out);
-    SetDlgItemTextW(c->hwndStatus, ID_TXT_BYTECOUNT,
-            LoadLocalizedString(IDS_NFO_BYTECOUNT, in, out));
+    AcquireSRWLockExclusive(&c->stats_lock);
+    c->bytes_in = in;
+    c->bytes_out = out;
+    ReleaseSRWLockExclusive(&c->stats_lock);
+    SetStatusByteCount(c);
 }
 
 /*
@@ -1434,12 +1557,12 @@ void OnInfoMsg(connection_t* c, char* msg)
 
     if (strbegins(msg, "OPEN_URL:"))
     {
-        wchar_t* url = Widen(msg + 9);
-        if (!open_url(url))
+        widebuf_t url;
+        if (!open_url(WidenBuf(&url, CP_UTF8, msg + 9)))
         {
             WriteStatusLog(c, L"GUI> ", L"Error: failed to open url from info msg", false);
         }
-        free(url);
+        FreeWidebuf(&url);
     }
     else if (strbegins(msg, "CR_TEXT:"))
     {
@@ -1497,7 +1620,6 @@ WriteStatusLog (connection_t *c, const WCHAR *prefix, const WCHAR *line, BOOL fi
     /* this can be called without connection (AS profile import), so do nothing in this case */
     if (!c) return;
 
-    HWND logWnd = GetDlgItem(c->hwndStatus, ID_EDT_LOG);
     FILE *log_fd;
     time_t now;
     WCHAR datetime[26];
@@ -1507,19 +1629,7 @@ WriteStatusLog (connection_t *c, const WCHAR *prefix, const WCHAR *line, BOOL fi
     wcsncpy (datetime, _wctime(&now), _countof(datetime));
     datetime[24] = L' ';
 
-    /* Remove lines from log window if it is getting full */
-    if (SendMessage(logWnd, EM_GETLINECOUNT, 0, 0) > MAX_LOG_LINES)
-    {
-        int pos = SendMessage(logWnd, EM_LINEINDEX, DEL_LOG_LINES, 0);
-        SendMessage(logWnd, EM_SETSEL, 0, pos);
-        SendMessage(logWnd, EM_REPLACESEL, FALSE, (LPARAM) _T(""));
-    }
-    /* Append line to log window */
-    SendMessage(logWnd, EM_SETSEL, (WPARAM) -1, (LPARAM) -1);
-    SendMessage(logWnd, EM_REPLACESEL, FALSE, (LPARAM) datetime);
-    SendMessage(logWnd, EM_REPLACESEL, FALSE, (LPARAM) prefix);
-    SendMessage(logWnd, EM_REPLACESEL, FALSE, (LPARAM) line);
-    SendMessage(logWnd, EM_REPLACESEL, FALSE, (LPARAM) L"\n");
+    StatusLogAdd(c, datetime, prefix, line, 0);
 
     if (!fileio) return;
 
@@ -1532,10 +1642,24 @@ WriteStatusLog (connection_t *c, const WCHAR *prefix, const WCHAR *line, BOOL fi
 }
 
 #define IO_TIMEOUT 5000 /* milliseconds */
+#define IO_CANCEL_TIMEOUT 100 /* milliseconds */
 
 static void
 CloseServiceIO (service_io_t *s)
 {
+    if (s->pipe && s->pipe != INVALID_HANDLE_VALUE)
+    {
+        /*
+         * Cancel any pending read and let its completion routine run now.
+         * Cancelling a pipe read completes at once in practice: keep the
+         * wait short as the thread serves other connections. A completion
+         * that runs later is ignored by HandleServiceIO.
+         */
+        CancelIo(s->pipe);
+        for (int i = 0; i < IO_CANCEL_TIMEOUT && !HasOverlappedIoCompleted(&s->o); i++)
+            SleepEx(1, TRUE);
+        SleepEx(0, TRUE);
+    }
     if (s->hEvent)
         CloseHandle(s->hEvent);
     s->hEvent = NULL;
@@ -1588,6 +1712,10 @@ HandleServiceIO (DWORD err, DWORD bytes, LPOVERLAPPED lpo)
     service_io_t *s = (service_io_t *) lpo;
     int len, capacity;
 
+    /* cancelled by CloseServiceIO: s may already be in use by a later launch */
+    if (err == ERROR_OPERATION_ABORTED)
+        return;
+
     len = _countof(s->readbuf);
     capacity = (len-1)*sizeof(*(s->readbuf));
 
@@ -1741,6 +1869,7 @@ OnNeedOk (connection_t *c, char *msg)
 {
     char *resp = NULL;
     WCHAR *wstr = NULL;
+    arena_t tmp = { 0 };
     auth_param_t *param = (auth_param_t *) calloc(1, sizeof(auth_param_t));
 
     if (!param)
@@ -1753,8 +1882,8 @@ OnNeedOk (connection_t *c, char *msg)
         goto out;
 
     /* allocate space for response : "needok param->id cancel/ok" */
-    resp = malloc (strlen(param->id) + strlen("needok \' \' cancel"));
-    wstr = Widen(param->str);
+    resp = arena_alloc (&tmp, strlen(param->id) + strlen("needok \' \' cancel"));
+    wstr = WidenArena(&tmp, CP_UTF8, param->str);
 
     if (!wstr || !resp)
     {
@@ -1779,8 +1908,7 @@ OnNeedOk (connection_t *c, char *msg)
 
 out:
     free_auth_param (param);
-    free(wstr);
-    free(resp);
+    arena_free(&tmp);
 }
 
 /*
@@ -1821,7 +1949,7 @@ DisconnectDaemon(connection_t *c)
     else
     {
         SetEvent(c->exit_event);
-        SetTimer(c->hwndStatus, IDT_STOP_TIMER, 15000, NULL);
+        SetTimer(c->hwndConn, IDT_STOP_TIMER, 15000, NULL);
     }
 }
 
@@ -1834,7 +1962,7 @@ Cleanup (connection_t *c)
     CloseManagement (c);
 
     free_dynamic_cr (c);
-    env_item_del_all(c->es);
+    env_set_free(c->es);
     c->es = NULL;
     echo_msg_clear(c, true); /* clear history */
     pkcs11_list_clear(&c->pkcs11_list);
@@ -1849,7 +1977,10 @@ Cleanup (connection_t *c)
     if (c->exit_event)
         CloseHandle (c->exit_event);
     c->exit_event = NULL;
+    AcquireSRWLockExclusive(&c->stats_lock);
     c->daemon_state[0] = '\0';
+    c->timeline.count = 0;
+    ReleaseSRWLockExclusive(&c->stats_lock);
 }
 /*
  * Helper to position and scale widgets in status window using current dpi
@@ -1879,17 +2010,9 @@ StatusDialogFunc(HWND hwndDlg, UINT msg, WPARAM wParam, LPARAM lParam)
 
     switch (msg)
     {
-    case WM_MANAGEMENT:
-        /* Management interface related event */
-        OnManagement(wParam, lParam);
-        return TRUE;
-
     case WM_INITDIALOG:
         c = (connection_t *) lParam;
 
-        /* Set window icon "disconnected" */
-        SetStatusWinIcon(hwndDlg, ID_ICO_CONNECTING);
-
         /* Set connection for this dialog */
         SetProp(hwndDlg, cfgProp, (HANDLE) c);
 
@@ -1915,6 +2038,12 @@ StatusDialogFunc(HWND hwndDlg, UINT msg, WPARAM wParam, LPARAM lParam)
         if (SendMessage(hLogWnd, EM_SETCHARFORMAT, SCF_DEFAULT, (LPARAM) &cfm) == 0)
             ShowLocalizedMsg(IDS_ERR_SET_SIZE);
 
+        /* Title is the config filename without extension */
+        TCHAR conn_name[200];
+        _tcsncpy(conn_name, c->config_file, _countof(conn_name));
+        conn_name[_tcslen(conn_name) - _tcslen(o.ext_string) - 1] = _T('\0');
+        SetWindowText(hwndDlg, LoadLocalizedString(IDS_NFO_CONNECTION_XXX, conn_name));
+
         /* display version string as "OpenVPN GUI gui_version/core_version" */
         wchar_t version[256];
         _sntprintf_0(version, L"%hs %hs/%hs", PACKAGE_NAME, PACKAGE_VERSION_RESOURCE_STR, o.ovpn_version)
@@ -1930,7 +2059,13 @@ StatusDialogFunc(HWND hwndDlg, UINT msg, WPARAM wParam, LPARAM lParam)
                      rect.top + rand()%100, 0, 0, SWP_NOSIZE);
         GetClientRect(hwndDlg, &rect);
         RenderStatusWindow(hwndDlg, rect.right, rect.bottom);
-        if (c->flags & FLAG_DAEMON_PERSISTENT && o.enable_persistent > 0)
+        if (c->status.plap)
+        {
+            /* PLAP shows its own progress: no detach or disconnect here */
+            ShowWindow(GetDlgItem(hwndDlg, ID_DETACH), SW_HIDE);
+            ShowWindow(GetDlgItem(hwndDlg, ID_DISCONNECT), SW_HIDE);
+        }
+        else if (c->flags & FLAG_DAEMON_PERSISTENT && o.enable_persistent > 0)
         {
             EnableWindow(GetDlgItem(hwndDlg, ID_DETACH), TRUE);
         }
@@ -1959,168 +2094,418 @@ StatusDialogFunc(HWND hwndDlg, UINT msg, WPARAM wParam, LPARAM lParam)
         switch (LOWORD(wParam))
         {
         case ID_DISCONNECT:
-            SetFocus(GetDlgItem(c->hwndStatus, ID_EDT_LOG));
+            SetFocus(GetDlgItem(hwndDlg, ID_EDT_LOG));
             StopOpenVPN(c);
             return TRUE;
 
         case ID_HIDE:
-            if (c->state != disconnected)
-                ShowWindow(hwndDlg, SW_HIDE);
-            else
-                DestroyWindow(hwndDlg);
+            SendMessage(c->hwndConn, WM_CLOSE, 0, 0);
             return TRUE;
 
         case ID_RESTART:
-            SetFocus(GetDlgItem(c->hwndStatus, ID_EDT_LOG));
+            SetFocus(GetDlgItem(hwndDlg, ID_EDT_LOG));
             RestartOpenVPN(c);
             return TRUE;
 
         case ID_DETACH:
-            SetFocus(GetDlgItem(c->hwndStatus, ID_EDT_LOG));
+            SetFocus(GetDlgItem(hwndDlg, ID_EDT_LOG));
             DetachOpenVPN(c);
             return TRUE;
         }
         break;
 
     case WM_SHOWWINDOW:
+        c = (connection_t *) GetProp(hwndDlg, cfgProp);
         if (wParam == TRUE)
-        {
-            c = (connection_t *) GetProp(hwndDlg, cfgProp);
-            if (c->hwndStatus)
-                SetFocus(GetDlgItem(c->hwndStatus, ID_EDT_LOG));
-        }
+            SetFocus(GetDlgItem(hwndDlg, ID_EDT_LOG));
+        /* bytecount is displayed only in the status window: adjust its update rate */
+        SetBytecountInterval(c, (BOOL) wParam);
         return FALSE;
 
     case WM_CLOSE:
         c = (connection_t *) GetProp(hwndDlg, cfgProp);
-        if (c->state != disconnected && c->state != detached)
-            ShowWindow(hwndDlg, SW_HIDE);
-        else
-            DestroyWindow(hwndDlg);
+        SendMessage(c->hwndConn, WM_CLOSE, 0, 0);
         return TRUE;
 
     case WM_NCDESTROY:
+        c = (connection_t *) GetProp(hwndDlg, cfgProp);
         RemoveProp(hwndDlg, cfgProp);
+        if (c)
+        {
+            c->hwndStatus = NULL;
+            SetBytecountInterval(c, FALSE);
+        }
         break;
+    }
+    return FALSE;
+}
+
+/*
+ * Create the status window of a connection unless it is open and bring
+ * it to the front. Runs on the worker hosting the connection.
+ */
+static void
+OpenStatusWindow(connection_t *c)
+{
+    if (!c->hwndStatus)
+    {
+        c->hwndStatus = CreateLocalizedDialogParam(ID_DLG_STATUS, StatusDialogFunc, (LPARAM) c);
+        if (!c->hwndStatus)
+        {
+            PrintDebug(L"Failed to create the status window of <%ls>", c->config_name);
+            return;
+        }
+        SetStatusText(c, c->status.text);
+        SetStatusIcon(c, c->status.icon);
+        SetStatusButton(c, ID_DISCONNECT, c->status.disconnect);
+        SetStatusButton(c, ID_RESTART, c->status.restart);
+        SetStatusIP(c);
+        if (c->bytes_in || c->bytes_out)
+            SetStatusByteCount(c);
+        StatusLogShow(c, TRUE);
+    }
+    SetForegroundWindow(c->hwndStatus);
+    ShowWindow(c->hwndStatus, SW_SHOW);
+}
+
+/* Close the status window of a connection, if open. Runs on its worker. */
+static void
+CloseStatusWindow(connection_t *c)
+{
+    if (c->hwndStatus)
+        DestroyWindow(c->hwndStatus);
+}
+
+/* Ask the worker hosting c to open or close its status window */
+BOOL
+ShowStatusWindowAsync(connection_t *c, BOOL show)
+{
+    return c->hwndConn && PostMessage(c->hwndConn, WM_OVPN_SHOWSTATUS, (WPARAM) show, 0);
+}
+
+/*
+ * Window procedure of the message-only window of a connection. It receives
+ * the management socket events, the requests from other threads and the
+ * timers of the connection, and lives as long as the worker hosts it.
+ */
+static LRESULT CALLBACK
+ConnWindowProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
+{
+    connection_t *c = (connection_t *) GetProp(hwnd, cfgProp);
+
+    switch (msg)
+    {
+    case WM_CREATE:
+        c = (connection_t *) ((CREATESTRUCT *) lParam)->lpCreateParams;
+        SetProp(hwnd, cfgProp, (HANDLE) c);
+        return 0;
+
+    case WM_MANAGEMENT:
+        /* Management interface related event */
+        OnManagement(wParam, lParam);
+        return 0;
+
+    case WM_OVPN_SHOWSTATUS:
+        if (wParam)
+            OpenStatusWindow(c);
+        else
+            CloseStatusWindow(c);
+        return 0;
+
+    case WM_OVPN_STATUSLOG:
+        StatusLogShow(c, FALSE);
+        return 0;
+
+    case WM_CLOSE:
+        /* the connection ends once it is down, else only its status window closes */
+        if (c->state != disconnected && c->state != detached)
+            CloseStatusWindow(c);
+        else
+            DestroyWindow(hwnd);
+        return 0;
 
     case WM_DESTROY:
-        PostQuitMessage(0);
-        break;
+        CloseStatusWindow(c);
+        return 0;
+
+    case WM_NCDESTROY:
+        RemoveProp(hwnd, cfgProp);
+        if (c)
+            ConnectionDone(c);
+        return 0;
+
+    case WM_OVPN_WAIT:
+        if (c->iserv.hEvent)
+            OnService(c, NULL);
+        else if (c->hProcess)
+            OnProcess(c, NULL);
+        return 0;
 
     case WM_OVPN_RELEASE:
-        c = (connection_t *) GetProp(hwndDlg, cfgProp);
-        c->state = reconnecting;
-        SetDlgItemText(c->hwndStatus, ID_TXT_STATUS, LoadLocalizedString(IDS_NFO_STATE_RECONNECTING));
-        SetDlgItemTextW(c->hwndStatus, ID_TXT_IP, L"");
-        SetStatusWinIcon(c->hwndStatus, ID_ICO_CONNECTING);
+        SetConnState(c, reconnecting);
+        SetStatusText(c, IDS_NFO_STATE_RECONNECTING);
+        SetStatusIP(c);
+        SetStatusIcon(c, ID_ICO_CONNECTING);
         OnHold(c, "");
-        break;
+        return 0;
 
     case WM_OVPN_STOP:
-        c = (connection_t *) GetProp(hwndDlg, cfgProp);
         /* external messages can trigger when we are not ready -- check the state */
-        if (!IsWindowEnabled(GetDlgItem(c->hwndStatus, ID_DISCONNECT))
-            || c->state == onhold)
-        {
-            break;
-        }
-        c->state = disconnecting;
+        if (!c->status.disconnect || c->state == onhold)
+            return 0;
+        SetConnState(c, disconnecting);
         if (!(c->flags & FLAG_DAEMON_PERSISTENT))
         {
             RunDisconnectScript(c, false);
         }
-        EnableWindow(GetDlgItem(c->hwndStatus, ID_DISCONNECT), FALSE);
-        EnableWindow(GetDlgItem(c->hwndStatus, ID_RESTART), FALSE);
+        SetStatusButton(c, ID_DISCONNECT, FALSE);
+        SetStatusButton(c, ID_RESTART, FALSE);
         SetMenuStatus(c, disconnecting);
-        SetDlgItemText(c->hwndStatus, ID_TXT_STATUS, LoadLocalizedString(IDS_NFO_STATE_WAIT_TERM));
+        SetStatusText(c, IDS_NFO_STATE_WAIT_TERM);
         DisconnectDaemon(c);
-        break;
+        return 0;
 
     case WM_OVPN_DETACH:
-        c = (connection_t *) GetProp(hwndDlg, cfgProp);
         /* just stop the thread keeping openvpn.exe running */
-        c->state = detaching;
-        EnableWindow(GetDlgItem(c->hwndStatus, ID_DISCONNECT), FALSE);
-        EnableWindow(GetDlgItem(c->hwndStatus, ID_RESTART), FALSE);
+        SetConnState(c, detaching);
+        SetStatusButton(c, ID_DISCONNECT, FALSE);
+        SetStatusButton(c, ID_RESTART, FALSE);
         OnStop(c, NULL);
-        break;
+        return 0;
 
     case WM_OVPN_SUSPEND:
-        c = (connection_t *) GetProp(hwndDlg, cfgProp);
-        c->state = suspending;
-        EnableWindow(GetDlgItem(c->hwndStatus, ID_DISCONNECT), FALSE);
-        EnableWindow(GetDlgItem(c->hwndStatus, ID_RESTART), FALSE);
+        SetConnState(c, suspending);
+        SetStatusButton(c, ID_DISCONNECT, FALSE);
+        SetStatusButton(c, ID_RESTART, FALSE);
         SetMenuStatus(c, disconnecting);
-        SetDlgItemText(c->hwndStatus, ID_TXT_STATUS, LoadLocalizedString(IDS_NFO_STATE_WAIT_TERM));
+        SetStatusText(c, IDS_NFO_STATE_WAIT_TERM);
         SetEvent(c->exit_event);
-        SetTimer(hwndDlg, IDT_STOP_TIMER, 15000, NULL);
-        break;
+        SetTimer(hwnd, IDT_STOP_TIMER, 15000, NULL);
+        return 0;
 
     case WM_TIMER:
         PrintDebug(L"WM_TIMER message with wParam = %lu", wParam);
-        c = (connection_t *) GetProp(hwndDlg, cfgProp);
         if (wParam == IDT_STOP_TIMER)
         {
             /* openvpn failed to respond to stop signal -- terminate */
             TerminateOpenVPN(c);
-            KillTimer (hwndDlg, IDT_STOP_TIMER);
+            KillTimer (hwnd, IDT_STOP_TIMER);
         }
-        break;
+        return 0;
 
     case WM_OVPN_RESTART:
-        c = (connection_t *) GetProp(hwndDlg, cfgProp);
         /* external messages can trigger when we are not ready -- check the state */
-        if (IsWindowEnabled(GetDlgItem(c->hwndStatus, ID_RESTART)))
+        if (c->status.restart)
         {
-            c->state = reconnecting;
+            SetConnState(c, reconnecting);
             ManagementCommand(c, "signal SIGHUP", NULL, regular);
-            SetDlgItemText(c->hwndStatus, ID_TXT_STATUS, LoadLocalizedString(IDS_NFO_STATE_RECONNECTING));
-            SetDlgItemTextW(c->hwndStatus, ID_TXT_IP, L"");
-            SetStatusWinIcon(c->hwndStatus, ID_ICO_CONNECTING);
+            SetStatusText(c, IDS_NFO_STATE_RECONNECTING);
+            SetStatusIP(c);
+            SetStatusIcon(c, ID_ICO_CONNECTING);
         }
         if (!o.silent_connection)
-        {
-            SetForegroundWindow(c->hwndStatus);
-            ShowWindow(c->hwndStatus, SW_SHOW);
-        }
-        break;
+            OpenStatusWindow(c);
+        return 0;
     }
-    return FALSE;
+    return DefWindowProc(hwnd, msg, wParam, lParam);
 }
 
 /*
- * ThreadProc for OpenVPN status dialog windows
+ * Connections are run by a small pool of worker threads instead of a
+ * thread each. A worker hosts a message-only window for each connection
+ * assigned to it, and its status window while open, and dispatches their
+ * messages. Waits on the daemon process or service pipe are registered
+ * with the system thread pool and reported to the connection window as
+ * WM_OVPN_WAIT. A connection goes
+ * to the least loaded worker: a new worker is added while all are busy
+ * until the pool is full, so that a modal dialog of one connection
+ * rarely holds up another.
  */
+#define CONN_WORKERS_MAX 8
+
+struct conn_worker {
+    DWORD id;
+    HWND hwnd;              /* message-only window: receives WM_OVPN_CONN_START */
+    HANDLE ready;           /* set once hwnd is created or has failed */
+    LONG load;              /* number of connections hosted */
+};
+
+static struct conn_worker conn_workers[CONN_WORKERS_MAX];
+static int conn_workers_count;
+static SRWLOCK conn_workers_lock = SRWLOCK_INIT;
+
+static const WCHAR conn_worker_class[] = L"OpenVPN-GUI-ConnWorker";
+static const WCHAR conn_window_class[] = L"OpenVPN-GUI-Conn";
+
+static void ConnectionStart(connection_t *c);
+
+static LRESULT CALLBACK
+ConnWorkerWndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
+{
+    if (msg == WM_OVPN_CONN_START)
+    {
+        ConnectionStart((connection_t *) lParam);
+        return 0;
+    }
+    return DefWindowProc(hwnd, msg, wParam, lParam);
+}
+
 static DWORD WINAPI
-ThreadOpenVPNStatus(void *p)
+ConnWorkerThread(void *p)
 {
-    connection_t *c = p;
-    TCHAR conn_name[200];
+    struct conn_worker *w = p;
     MSG msg;
-    HANDLE wait_event;
 
-    CLEAR (msg);
-    srand(c->threadId);
+    srand(GetCurrentThreadId());
 
-    /* Cut of extention from config filename. */
-    _tcsncpy(conn_name, c->config_file, _countof(conn_name));
-    conn_name[_tcslen(conn_name) - _tcslen(o.ext_string) - 1] = _T('\0');
+    w->hwnd = CreateWindowEx(0, conn_worker_class, NULL, 0, 0, 0, 0, 0,
+                             HWND_MESSAGE, NULL, o.hInstance, NULL);
+    SetEvent(w->ready);
+    if (!w->hwnd)
+        return 1;
 
-    /* Create and Show Status Dialog */
-    c->hwndStatus = CreateLocalizedDialogParam(ID_DLG_STATUS, StatusDialogFunc, (LPARAM) c);
-    if (!c->hwndStatus)
+    /* Run the message loop for the windows of all hosted connections */
+    while (TRUE)
+    {
+        if (!PeekMessage(&msg, NULL, 0, 0, PM_REMOVE))
+        {
+            /* alertable: completion routines of service pipe reads run here */
+            MsgWaitForMultipleObjectsEx(0, NULL, INFINITE, QS_ALLINPUT, MWMO_ALERTABLE);
+            continue;
+        }
+        if (msg.message == WM_QUIT)
+            break;
+
+        /* dialog keyboard handling for the visible status windows */
+        HWND root = msg.hwnd ? GetAncestor(msg.hwnd, GA_ROOT) : NULL;
+        if (!root || !IsWindowVisible(root) || IsDialogMessage(root, &msg) == 0)
+        {
+            TranslateMessage(&msg);
+            DispatchMessage(&msg);
+        }
+    }
+    return 0;
+}
+
+/* Start a new worker thread in w. Call with conn_workers_lock held. */
+static BOOL
+ConnWorkerCreate(struct conn_worker *w)
+{
+    WNDCLASSEX wc = {
+        .cbSize = sizeof(wc),
+        .lpfnWndProc = ConnWorkerWndProc,
+        .hInstance = o.hInstance,
+        .lpszClassName = conn_worker_class
+    };
+    WNDCLASSEX cc = {
+        .cbSize = sizeof(cc),
+        .lpfnWndProc = ConnWindowProc,
+        .hInstance = o.hInstance,
+        .lpszClassName = conn_window_class
+    };
+    if (conn_workers_count == 0
+        && ((!RegisterClassEx(&wc) && GetLastError() != ERROR_CLASS_ALREADY_EXISTS)
+            || (!RegisterClassEx(&cc) && GetLastError() != ERROR_CLASS_ALREADY_EXISTS)))
+    {
+        return FALSE;
+    }
+
+    w->ready = CreateEvent(NULL, TRUE, FALSE, NULL);
+    if (!w->ready)
+        return FALSE;
+
+    w->hwnd = NULL;
+    w->load = 0;
+    HANDLE thread = CreateThread(NULL, 0, ConnWorkerThread, w, 0, &w->id);
+    if (thread)
+    {
+        WaitForSingleObject(w->ready, INFINITE);
+        CloseHandle(thread);
+    }
+    CloseHandle(w->ready);
+    w->ready = NULL;
+
+    return (w->hwnd != NULL);
+}
+
+/* Choose a worker for a new connection and count it as hosted there */
+static struct conn_worker *
+ConnWorkerGet(void)
+{
+    struct conn_worker *best = NULL;
+
+    AcquireSRWLockExclusive(&conn_workers_lock);
+    for (int i = 0; i < conn_workers_count; i++)
+    {
+        struct conn_worker *w = &conn_workers[i];
+        if (IsWindow(w->hwnd) && (!best || w->load < best->load))
+            best = w;
+    }
+    if ((!best || best->load > 0) && conn_workers_count < CONN_WORKERS_MAX
+        && ConnWorkerCreate(&conn_workers[conn_workers_count]))
+    {
+        best = &conn_workers[conn_workers_count++];
+    }
+    if (best)
+        best->load++;
+    ReleaseSRWLockExclusive(&conn_workers_lock);
+
+    return best;
+}
+
+/* Remove a connection from the load of the worker with thread id tid */
+static void
+ConnWorkerRelease(DWORD tid)
+{
+    AcquireSRWLockExclusive(&conn_workers_lock);
+    for (int i = 0; i < conn_workers_count; i++)
+    {
+        if (conn_workers[i].id == tid && conn_workers[i].load > 0)
+        {
+            conn_workers[i].load--;
+            break;
+        }
+    }
+    ReleaseSRWLockExclusive(&conn_workers_lock);
+}
+
+/* Thread pool callback for a signalled process handle or service event */
+static void CALLBACK
+ConnWaitCallback(void *ctx, UNUSED BOOLEAN timeout)
+{
+    PostMessage((HWND) ctx, WM_OVPN_WAIT, 0, 0);
+}
+
+/*
+ * Create the window of a connection and start monitoring it. The status
+ * window is opened only when it is to be shown. Runs on the worker
+ * thread that hosts the connection.
+ */
+static void
+ConnectionStart(connection_t *c)
+{
+    HANDLE wait_event;
+
+    c->status.text = IDS_NFO_STATE_CONNECTING;
+    c->status.icon = ID_ICO_CONNECTING;
+    c->status.disconnect = TRUE;
+    c->status.restart = TRUE;
+
+    c->hwndConn = CreateWindowEx(0, conn_window_class, NULL, 0, 0, 0, 0, 0,
+                                 HWND_MESSAGE, NULL, o.hInstance, c);
+    if (!c->hwndConn)
     {
         /* kill daemon process if we started it */
         SetEvent(c->exit_event);
         Cleanup(c);
-        c->state = disconnected;
-        return 1;
+        SetConnState(c, disconnected);
+        ConnWorkerRelease(GetCurrentThreadId());
+        SetEvent(c->done_event);
+        return;
     }
 
     CheckAndSetTrayIcon();
     SetMenuStatus(c, connecting);
-    SetDlgItemText(c->hwndStatus, ID_TXT_STATUS, LoadLocalizedString(IDS_NFO_STATE_CONNECTING));
-    SetWindowText(c->hwndStatus, LoadLocalizedString(IDS_NFO_CONNECTION_XXX, conn_name));
 
     if (!OpenManagement(c))
     {
@@ -2140,59 +2525,48 @@ ThreadOpenVPNStatus(void *p)
         wait_event = c->hProcess;
     }
 
+    /* for persistent connections there is no wait_event */
+    if (wait_event
+        && !RegisterWaitForSingleObject(&c->wait_handle, wait_event, ConnWaitCallback, c->hwndConn,
+                                        INFINITE, (wait_event == c->hProcess) ? WT_EXECUTEONLYONCE : 0))
+    {
+        MsgToEventLog(EVENTLOG_ERROR_TYPE, L"Failed to register wait for <%ls> (error = %lu)",
+                      c->config_name, GetLastError());
+        c->wait_handle = NULL;
+    }
+
     /* For persistent connections, popup the status win only if we're connecting manually */
     BOOL show_status_win = (o.silent_connection == 0);
     if ((c->flags & FLAG_DAEMON_PERSISTENT) && c->state == resuming)
     {
        show_status_win = false;
     }
-    ShowWindow(c->hwndStatus, show_status_win ? SW_SHOW : SW_HIDE);
+    if (show_status_win)
+        OpenStatusWindow(c);
 
     /* Load echo msg histroy from registry */
     echo_msg_load(c);
+}
 
-    /* Run the message loop for the status window */
-    while (WM_QUIT != msg.message)
+/* Release handles etc. once the window of a connection is gone */
+static void
+ConnectionDone(connection_t *c)
+{
+    if (c->wait_handle)
     {
-        DWORD res;
-        if (wait_event == NULL) /* for persistent connections there is no wait_event */
-        {
-            res = GetMessage(&msg, NULL, 0, 0);
-            if (res == (DWORD) -1)  /* log the error and continue */
-            {
-                MsgToEventLog(EVENTLOG_WARNING_TYPE, L"GetMessage for <%ls> returned error (status=%lu)",
-                              c->config_name, GetLastError());
-                continue;
-            }
-            else if (res == 0) /* WM_QUIT */
-            {
-                break;
-            }
-        }
-        else if (!PeekMessage(&msg, NULL, 0, 0, PM_REMOVE))
-        {
-            if ((res = MsgWaitForMultipleObjectsEx (1, &wait_event, INFINITE, QS_ALLINPUT,
-                                         MWMO_ALERTABLE)) == WAIT_OBJECT_0)
-            {
-                if (wait_event == c->hProcess)
-                    OnProcess (c, NULL);
-                else if (wait_event == c->iserv.hEvent)
-                    OnService (c, NULL);
-            }
-            continue;
-        }
-
-        if (IsDialogMessage(c->hwndStatus, &msg) == 0)
-        {
-            TranslateMessage(&msg);
-            DispatchMessage(&msg);
-        }
+        /* waits for a running callback to complete */
+        UnregisterWaitEx(c->wait_handle, INVALID_HANDLE_VALUE);
+        c->wait_handle = NULL;
     }
-
-    /* release handles etc.*/
     Cleanup (c);
-    c->hwndStatus = NULL;
-    return 0;
+    StatusLogFree(c);
+    c->hwndConn = NULL;
+    ConnWorkerRelease(GetCurrentThreadId());
+    SetEvent(c->done_event);
+
+    /* let the main window decide whether to re-attach */
+    if (c->flags & FLAG_DAEMON_PERSISTENT)
+        PostMessage(o.hWnd, WM_OVPN_PERSISTENT, (WPARAM) (c - o.conn), 0);
 }
 
 /*
@@ -2280,7 +2654,7 @@ ReleaseOpenVPN(connection_t *c)
     {
         return;
     }
-    PostMessage(c->hwndStatus, WM_OVPN_RELEASE, 0, 0);
+    PostMessage(c->hwndConn, WM_OVPN_RELEASE, 0, 0);
 }
 
 /* Start a thread to monitor a connection and launch openvpn.exe if required */
@@ -2289,7 +2663,7 @@ StartOpenVPN(connection_t *c)
 {
     CLEAR(c->ip);
 
-    if (c->hwndStatus)
+    if (c->hwndConn)
     {
         if (c->state == onhold)
         {
@@ -2302,10 +2676,7 @@ StartOpenVPN(connection_t *c)
             WriteStatusLog(c, L"OpenVPN GUI> ",
                        L"Complete any pending dialog before starting a new connection", false);
         if (!o.silent_connection)
-        {
-           SetForegroundWindow(c->hwndStatus);
-           ShowWindow(c->hwndStatus, SW_SHOW);
-        }
+            ShowStatusWindowAsync(c, TRUE);
         return FALSE;
     }
     else if (c->state != disconnected && c->state != detached)
@@ -2314,16 +2685,34 @@ StartOpenVPN(connection_t *c)
     }
 
     PrintDebug(L"Starting openvpn on config %ls", c->config_name);
+    TRACE_BEGIN("StartOpenVPN");
 
-    /* Create thread to show the connection's status dialog */
-    HANDLE hThread = CreateThread(NULL, 0, ThreadOpenVPNStatus, c, CREATE_SUSPENDED, &c->threadId);
-    if (hThread == NULL)
+    /* signalled while no worker hosts the connection */
+    if (!c->done_event)
+        c->done_event = CreateEvent(NULL, TRUE, TRUE, NULL);
+    if (!c->done_event)
     {
         ShowLocalizedMsg(IDS_ERR_CREATE_THREAD_STATUS);
+        TRACE_END("StartOpenVPN");
         return false;
     }
+    StatusLogFree(c);
 
-    if (c->flags & FLAG_DAEMON_PERSISTENT)
+    /* Choose the worker thread to host the connection */
+    struct conn_worker *w = ConnWorkerGet();
+    if (w == NULL)
+    {
+        ShowLocalizedMsg(IDS_ERR_CREATE_THREAD_STATUS);
+        TRACE_END("StartOpenVPN");
+        return false;
+    }
+    c->threadId = w->id;
+
+    if (c->manage.replay)
+    {
+        /* management data is read from a recording: no daemon to launch */
+    }
+    else if (c->flags & FLAG_DAEMON_PERSISTENT)
     {
         if (!ParseManagementAddress(c))
         {
@@ -2332,26 +2721,39 @@ StartOpenVPN(connection_t *c)
                 ShowLocalizedMsgEx(MB_OK|MB_ICONERROR, o.hWnd, TEXT(PACKAGE_NAME), IDS_ERR_PARSE_MGMT_OPTION,
                                    c->config_dir, c->config_file);
             else
-                c->state = disconnected;
-            TerminateThread(hThread, 1);
+                SetConnState(c, disconnected);
+            ConnWorkerRelease(w->id);
+            TRACE_END("StartOpenVPN");
             return false;
         }
     }
     /* Launch openvpn.exe using the service or directly */
     else if (!LaunchOpenVPN(c))
     {
-        TerminateThread(hThread, 1);
+        ConnWorkerRelease(w->id);
+        TRACE_END("StartOpenVPN");
         return false;
     }
 
-    c->state = (c->state == suspended || c->state == detached) ? resuming : connecting;
+    SetConnState(c, (c->state == suspended || c->state == detached) ? resuming : connecting);
 
-    /* Start the status dialog thread */
-    ResumeThread(hThread);
-
-    if (hThread && hThread != INVALID_HANDLE_VALUE)
-        CloseHandle(hThread);
+    /* Have the worker start hosting the connection */
+    ResetEvent(c->done_event);
+    if (!PostMessage(w->hwnd, WM_OVPN_CONN_START, 0, (LPARAM) c))
+    {
+        SetEvent(c->done_event);
+        ShowLocalizedMsg(IDS_ERR_CREATE_THREAD_STATUS);
+        /* kill daemon process if we started it and close what LaunchOpenVPN opened */
+        if (c->exit_event)
+            SetEvent(c->exit_event);
+        Cleanup(c);
+        SetConnState(c, disconnected);
+        ConnWorkerRelease(w->id);
+        TRACE_END("StartOpenVPN");
+        return false;
+    }
 
+    TRACE_END("StartOpenVPN");
     return true;
 }
 
@@ -2371,8 +2773,10 @@ LaunchOpenVPN(connection_t *c)
 
     RunPreconnectScript(c);
 
-    /* Create an event object to signal OpenVPN to exit */
-    _sntprintf_0(exit_event_name, _T("%x%08x"), GetCurrentProcessId(), c->threadId);
+    /* Create an event object to signal OpenVPN to exit: unique per launch */
+    static volatile LONG launch_count;
+    _sntprintf_0(exit_event_name, _T("%x%08x"), GetCurrentProcessId(),
+                 (DWORD) InterlockedIncrement(&launch_count));
     c->exit_event = CreateEvent(NULL, TRUE, FALSE, exit_event_name);
     if (c->exit_event == NULL)
     {
@@ -2563,14 +2967,16 @@ DetachOpenVPN(connection_t *c)
     if (c->flags & FLAG_DAEMON_PERSISTENT)
     {
         c->auto_connect = false;
-        PostMessage(c->hwndStatus, WM_OVPN_DETACH, 0, 0);
+        if (c->hwndConn)
+            PostMessage(c->hwndConn, WM_OVPN_DETACH, 0, 0);
     }
 }
 
 void
 StopOpenVPN(connection_t *c)
 {
-    PostMessage(c->hwndStatus, WM_OVPN_STOP, 0, 0);
+    if (c->hwndConn)
+        PostMessage(c->hwndConn, WM_OVPN_STOP, 0, 0);
 }
 
 /* force-kill as a last resort */
@@ -2604,7 +3010,8 @@ TerminateOpenVPN (connection_t *c)
 void
 SuspendOpenVPN(int config)
 {
-    PostMessage(o.conn[config].hwndStatus, WM_OVPN_SUSPEND, 0, 0);
+    if (o.conn[config].hwndConn)
+        PostMessage(o.conn[config].hwndConn, WM_OVPN_SUSPEND, 0, 0);
 }
 
 void
@@ -2614,9 +3021,9 @@ RestartOpenVPN(connection_t *c)
     {
         ReleaseOpenVPN(c);
     }
-    else if (c->hwndStatus)
+    else if (c->hwndConn)
     {
-        PostMessage(c->hwndStatus, WM_OVPN_RESTART, 0, 0);
+        PostMessage(c->hwndConn, WM_OVPN_RESTART, 0, 0);
     }
     else /* Not started: treat this as a request to connect */
     {
@@ -2639,52 +3046,98 @@ SetStatusWinIcon(HWND hwndDlg, int iconId)
 
 
 /*
- * Read one line from OpenVPN's stdout.
+ * Read the first line from OpenVPN's stdout. Anything after it
+ * is discarded. The reads block until data arrives or the process
+ * exits, as we do not hold the write end of the pipe.
  */
 static BOOL
 ReadLineFromStdOut(HANDLE hStdOut, char *line, DWORD size)
 {
-    DWORD len, read;
+    DWORD len = 0, read;
 
-    while (TRUE)
+    while (len < size - 1)
     {
-        if (!PeekNamedPipe(hStdOut, line, size, &read, NULL, NULL))
+        if (!ReadFile(hStdOut, line + len, size - 1 - len, &read, NULL))
         {
             if (GetLastError() != ERROR_BROKEN_PIPE)
                 ShowLocalizedMsg(IDS_ERR_READ_STDOUT_PIPE);
             return FALSE;
         }
 
-        char *pos = memchr(line, '\r', read);
+        char *pos = memchr(line + len, '\r', read);
         if (pos)
         {
-            len = pos - line + 2;
-            if (len > size)
-                return FALSE;
-            break;
+            *pos = '\0';
+            return TRUE;
         }
+        len += read;
+    }
 
-        /* Line doesn't fit into the buffer */
-        if (read == size)
-            return FALSE;
+    /* Line doesn't fit into the buffer */
+    return FALSE;
+}
 
-        Sleep(100);
-    }
+/* Version of openvpn.exe saved with what identifies the executable */
+struct version_cache {
+    WCHAR path[MAX_PATH];
+    ULONGLONG size;
+    FILETIME mtime;
+    char version[16];
+};
 
-    if (!ReadFile(hStdOut, line, len, &read, NULL) || read != len)
-    {
-        if (GetLastError() != ERROR_BROKEN_PIPE)
-            ShowLocalizedMsg(IDS_ERR_READ_STDOUT_PIPE);
+/* Fill in path, size and modification time of openvpn.exe */
+static BOOL
+GetVersionCacheKey(struct version_cache *key)
+{
+    WIN32_FILE_ATTRIBUTE_DATA fad;
+
+    CLEAR(*key);
+    if (wcslen(o.exe_path) >= _countof(key->path)
+        || !GetFileAttributesExW(o.exe_path, GetFileExInfoStandard, &fad))
         return FALSE;
-    }
 
-    line[read - 2] = '\0';
+    wcscpy(key->path, o.exe_path);
+    key->size = ((ULONGLONG) fad.nFileSizeHigh << 32) | fad.nFileSizeLow;
+    key->mtime = fad.ftLastWriteTime;
     return TRUE;
 }
 
+/* Get the saved version if the executable has not changed since */
+static BOOL
+LoadVersionCache(const struct version_cache *key)
+{
+    struct version_cache cache;
+    DWORD len = sizeof(cache);
 
-BOOL
-CheckVersion()
+    if (RegGetValueW(HKEY_CURRENT_USER, GUI_REGKEY_HKCU, L"ovpn_version_cache", RRF_RT_REG_BINARY,
+                     NULL, &cache, &len) != ERROR_SUCCESS
+        || len != sizeof(cache))
+        return FALSE;
+
+    cache.path[_countof(cache.path)-1] = L'\0';
+    cache.version[_countof(cache.version)-1] = '\0';
+    if (_wcsicmp(cache.path, key->path) != 0
+        || cache.size != key->size
+        || CompareFileTime(&cache.mtime, &key->mtime) != 0
+        || cache.version[0] == '\0')
+        return FALSE;
+
+    strcpy(o.ovpn_version, cache.version);
+    return TRUE;
+}
+
+static void
+SaveVersionCache(struct version_cache *key)
+{
+    strncpy(key->version, o.ovpn_version, _countof(key->version)-1);
+    if (RegSetKeyValueW(HKEY_CURRENT_USER, GUI_REGKEY_HKCU, L"ovpn_version_cache", REG_BINARY,
+                        key, sizeof(*key)) != ERROR_SUCCESS)
+        PrintDebug(L"Failed to save the OpenVPN version in the registry");
+}
+
+/* Run openvpn --version and parse the version string into o.ovpn_version */
+static BOOL
+ProbeVersion(void)
 {
     HANDLE hStdOutRead = NULL;
     HANDLE hStdOutWrite = NULL;
@@ -2778,6 +3231,42 @@ out:
     return retval;
 }
 
+/*
+ * Set o.ovpn_version. Running openvpn --version is slow, so the result
+ * is saved in the registry and reused until the path, size or time stamp
+ * of the executable changes. *cached is set to whether the saved result
+ * was used. The time taken is shown in the debug log and as a
+ * "CheckVersion" span in the trace.
+ */
+BOOL
+CheckVersion(BOOL *cached)
+{
+    struct version_cache key;
+    ULONGLONG start = GetTickCount64();
+    BOOL retval;
+
+    *cached = FALSE;
+
+    TRACE_BEGIN("CheckVersion");
+
+    BOOL have_key = GetVersionCacheKey(&key);
+    if (have_key && LoadVersionCache(&key))
+    {
+        retval = *cached = TRUE;
+    }
+    else
+    {
+        retval = ProbeVersion();
+        if (retval && have_key)
+            SaveVersionCache(&key);
+    }
+
+    TRACE_END("CheckVersion");
+    PrintDebug(L"OpenVPN version %hs %ls in %I64u msec", o.ovpn_version,
+               *cached ? L"read from cache" : L"probed", GetTickCount64() - start);
+    return retval;
+}
+
 /* Delete saved passwords and reset the checkboxes to default */
 void
 ResetSavePasswords(connection_t *c)
@@ -24,6 +24,8 @@
 #define OPENVPN_H
 
 #include "options.h"
+#include "misc.h"
+#include "auth_param.h"
 
 BOOL StartOpenVPN(connection_t *);
 void StopOpenVPN(connection_t *);
@@ -31,8 +33,10 @@ void DetachOpenVPN(connection_t *);
 void SuspendOpenVPN(int config);
 void RestartOpenVPN(connection_t *);
 void ReleaseOpenVPN(connection_t *);
-BOOL CheckVersion();
+BOOL CheckVersion(BOOL *cached);
 void SetStatusWinIcon(HWND hwndDlg, int IconID);
+void SetStatusText(connection_t *c, UINT id);
+BOOL ShowStatusWindowAsync(connection_t *c, BOOL show);
 
 void OnReady(connection_t *, char *);
 void OnHold(connection_t *, char *);
@@ -60,33 +64,19 @@ extern const TCHAR *cfgProp;
 /* Write a line to status window and optionally to the log file */
 void WriteStatusLog (connection_t *c, const WCHAR *prefix, const WCHAR *line, BOOL fileio);
 
-#define FLAG_CR_TYPE_SCRV1  0x1    /* static challenege */
-#define FLAG_CR_TYPE_CRV1   0x2    /* dynamic challenege */
-#define FLAG_CR_ECHO        0x4    /* echo the response */
-#define FLAG_CR_RESPONSE    0x8    /* response needed */
-#define FLAG_PASS_TOKEN     0x10   /* PKCS11 token password needed */
-#define FLAG_STRING_PKCS11  0x20   /* PKCS11 id needed */
-#define FLAG_PASS_PKEY      0x40   /* Private key password needed */
-#define FLAG_CR_TYPE_CRTEXT 0x80   /* crtext */
-
-typedef struct {
-    connection_t* c;
-    unsigned int flags;
-    char* str;
-    char* id;
-    char* user;
-    char* cr_response;
-} auth_param_t;
-
 /*
- * Parse dynamic challenge string received from the server. Returns
- * true on success. The caller must free param->str and param->id
- * even on error.
+ * Return the time in msec spent between the first occurrence of daemon
+ * state start and that of end in the state timeline of the connection.
+ * If start is NULL the earliest recorded state is used. Returns -1 if
+ * either state has not been seen in the current connection attempt.
  */
-BOOL
-parse_dynamic_cr(const char* str, auth_param_t* param);
+LONGLONG GetStatePhaseDuration(const connection_t *c, const char *start, const char *end);
 
-void
-free_auth_param(auth_param_t* param);
+/*
+ * Format the durations of connection phases as a string of the form
+ * "total 2.310 s, tls-handshake 0.802 s, auth 0.414 s ..." into buf.
+ * Returns the number of characters written, 0 if no timing is available.
+ */
+int FormatStatePhases(const connection_t *c, wchar_t *buf, size_t len);
 
 #endif
@@ -34,6 +34,7 @@
 #include "save_pass.h"
 #include "misc.h"
 #include "passphrase.h"
+#include "trace.h"
 
 typedef enum
 {
@@ -75,22 +76,42 @@ CheckReadAccess (const TCHAR *dir, const TCHAR *file)
     return CheckFileAccess (path, GENERIC_READ);
 }
 
+/*
+ * Configs and groups found by a scan. They are built without holding
+ * o.conn_lock and moved into o.conn and o.groups once the scan is done.
+ */
+struct config_list {
+    int kept;                   /* number of entries of o.conn retained */
+    connection_t *conn;         /* configs found, to follow the kept ones */
+    int num_configs;
+    int max_configs;
+    config_group_t *groups;     /* new groups, if the groups are rebuilt */
+    int num_groups;
+    int max_groups;
+};
+
 static int
-ConfigAlreadyExists(TCHAR *newconfig)
+ConfigAlreadyExists(const struct config_list *l, TCHAR *newconfig)
 {
     int i;
-    for (i = 0; i < o.num_configs; ++i)
+    for (i = 0; i < l->kept; ++i)
     {
         if (_tcsicmp(o.conn[i].config_file, newconfig) == 0)
             return true;
     }
+    for (i = 0; i < l->num_configs; ++i)
+    {
+        if (_tcsicmp(l->conn[i].config_file, newconfig) == 0)
+            return true;
+    }
     return false;
 }
 
 static void
-AddConfigFileToList(int config, const TCHAR *filename, const TCHAR *config_dir)
+AddConfigFileToList(struct config_list *l, const TCHAR *filename, const TCHAR *config_dir)
 {
-    connection_t *c = &o.conn[config];
+    connection_t *c = &l->conn[l->num_configs];
+    int config = l->kept + l->num_configs; /* index in o.conn once moved there */
     int i;
 
     memset(c, 0, sizeof(*c));
@@ -160,30 +181,30 @@ AddConfigFileToList(int config, const TCHAR *filename, const TCHAR *config_dir)
  * parent itself.
  */
 static int
-NewConfigGroup(const wchar_t *name, int parent, int flags)
+NewConfigGroup(struct config_list *l, const wchar_t *name, int parent, int flags)
 {
     if (!(flags & FLAG_ADD_CONFIG_GROUPS))
     {
         return parent;
     }
 
-    if (!o.groups || o.num_groups == o.max_groups)
+    if (!l->groups || l->num_groups == l->max_groups)
     {
-        o.max_groups += 10;
-        void *tmp = realloc(o.groups, sizeof(*o.groups)*o.max_groups);
+        l->max_groups += 10;
+        void *tmp = realloc(l->groups, sizeof(*l->groups)*l->max_groups);
         if (!tmp)
         {
-            o.max_groups -= 10;
+            l->max_groups -= 10;
             ErrorExit(1, L"Out of memory while grouping configs");
         }
-        o.groups = tmp;
+        l->groups = tmp;
     }
 
-    config_group_t *cg = &o.groups[o.num_groups];
+    config_group_t *cg = &l->groups[l->num_groups];
     memset(cg, 0, sizeof(*cg));
 
     _sntprintf_0(cg->name, L"%ls", name);
-    cg->id = o.num_groups++;
+    cg->id = l->num_groups++;
     cg->parent = parent;
     cg->active = false; /* activated later if not empty */
 
@@ -266,12 +287,12 @@ ActivateConfigGroups(void)
  *        flags      -- enable warnings, use directory based
  *                      grouping of configs etc.
  * Currently configs in a directory are grouped together and group is
- * the id of the current group in the global group array |o.groups|
+ * the id of the current group in the groups of the list being built
  * This may be recursively called until depth becomes 1 and each time
  * the group is changed to that of the directory being recursed into.
  */
 static void
-BuildFileList0(const TCHAR *config_dir, int recurse_depth, int group, int flags)
+BuildFileList0(struct config_list *l, const TCHAR *config_dir, int recurse_depth, int group, int flags)
 {
     WIN32_FIND_DATA find_obj;
     HANDLE find_handle;
@@ -286,23 +307,23 @@ BuildFileList0(const TCHAR *config_dir, int recurse_depth, int group, int flags)
     /* Loop over each config file in config dir */
     do
     {
-        if (!o.conn || o.num_configs == o.max_configs)
+        if (!l->conn || l->num_configs == l->max_configs)
         {
-            o.max_configs += 50;
-            void *tmp = realloc(o.conn, sizeof(*o.conn)*o.max_configs);
+            l->max_configs += 50;
+            void *tmp = realloc(l->conn, sizeof(*l->conn)*l->max_configs);
             if (!tmp)
             {
-                o.max_configs -= 50;
+                l->max_configs -= 50;
                 FindClose(find_handle);
                 ErrorExit(1, L"Out of memory while scanning configs");
             }
-            o.conn = tmp;
+            l->conn = tmp;
         }
 
         match_t match_type = match(&find_obj, o.ext_string);
         if (match_type == match_file)
         {
-            if (ConfigAlreadyExists(find_obj.cFileName))
+            if (ConfigAlreadyExists(l, find_obj.cFileName))
             {
                 if (flags & FLAG_WARN_DUPLICATES)
                     ShowLocalizedMsg(IDS_ERR_CONFIG_EXIST, find_obj.cFileName);
@@ -311,8 +332,8 @@ BuildFileList0(const TCHAR *config_dir, int recurse_depth, int group, int flags)
 
             if (CheckReadAccess (config_dir, find_obj.cFileName))
             {
-                AddConfigFileToList(o.num_configs, find_obj.cFileName, config_dir);
-                o.conn[o.num_configs++].group = group;
+                AddConfigFileToList(l, find_obj.cFileName, config_dir);
+                l->conn[l->num_configs++].group = group;
             }
         }
     } while (FindNextFile(find_handle, &find_obj));
@@ -337,9 +358,9 @@ BuildFileList0(const TCHAR *config_dir, int recurse_depth, int group, int flags)
             {
                 /* recurse into subdirectory */
                 _sntprintf_0(subdir_name, _T("%ls\\%ls"), config_dir, find_obj.cFileName);
-                int sub_group = NewConfigGroup(find_obj.cFileName, group, flags);
+                int sub_group = NewConfigGroup(l, find_obj.cFileName, group, flags);
 
-                BuildFileList0(subdir_name, recurse_depth - 1, sub_group, flags);
+                BuildFileList0(l, subdir_name, recurse_depth - 1, sub_group, flags);
             }
         }
     } while (FindNextFile(find_handle, &find_obj));
@@ -406,6 +427,139 @@ IsSamePath(const wchar_t *path1, const wchar_t *path2)
     return ret;
 }
 
+/*
+ * Config folders are watched for changes so that the list is rescanned
+ * only when required. A scan is also due when any of the settings that
+ * determine what is scanned or how the menu is laid out change.
+ */
+static volatile LONG config_dirs_changed = 1;
+static HANDLE watch_thread;
+static HANDLE watch_stop;
+
+static struct {
+    TCHAR config_dir[MAX_PATH];
+    TCHAR global_config_dir[MAX_PATH];
+    TCHAR config_auto_dir[MAX_PATH];
+    service_state_t service_state;
+    DWORD enable_persistent;
+    DWORD config_menu_view;
+    LANGID language;
+} scanned;
+
+static DWORD WINAPI
+ConfigWatchThread(LPVOID arg)
+{
+    HANDLE *h = arg;  /* h[0] is the stop event, followed by change handles */
+    DWORD n = 1;
+
+    while (n < 4 && h[n])
+        n++;
+
+    while (1)
+    {
+        DWORD r = WaitForMultipleObjects(n, h, FALSE, INFINITE);
+        if (r <= WAIT_OBJECT_0 || r >= WAIT_OBJECT_0 + n)
+            break;
+        InterlockedExchange(&config_dirs_changed, 1);
+        if (!FindNextChangeNotification(h[r - WAIT_OBJECT_0]))
+            break;
+    }
+
+    for (DWORD i = 1; i < n; i++)
+        FindCloseChangeNotification(h[i]);
+    free(h);
+    return 0;
+}
+
+/* Watch dir and its subdirectories for added, removed or modified files */
+static HANDLE
+WatchConfigDir(const TCHAR *dir)
+{
+    DWORD filter = FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME
+                   | FILE_NOTIFY_CHANGE_LAST_WRITE;
+    HANDLE h = FindFirstChangeNotification(dir, TRUE, filter);
+    if (h != INVALID_HANDLE_VALUE)
+        return h;
+
+    /* the folder may not exist yet: watch its parent for it to appear */
+    TCHAR parent[MAX_PATH];
+    _tcsncpy(parent, dir, _countof(parent) - 1);
+    parent[_countof(parent) - 1] = _T('\0');
+    TCHAR *sep = _tcsrchr(parent, _T('\\'));
+    if (!sep)
+        return NULL;
+    *sep = _T('\0');
+    h = FindFirstChangeNotification(parent, FALSE, FILE_NOTIFY_CHANGE_DIR_NAME);
+    return (h != INVALID_HANDLE_VALUE) ? h : NULL;
+}
+
+/*
+ * (Re)start watching the config folders. Called before a scan so that
+ * changes made while scanning trigger another one.
+ */
+static void
+ConfigWatchRestart(void)
+{
+    if (watch_thread)
+    {
+        SetEvent(watch_stop);
+        WaitForSingleObject(watch_thread, INFINITE);
+        CloseHandle(watch_thread);
+        watch_thread = NULL;
+    }
+    if (!watch_stop && !(watch_stop = CreateEvent(NULL, TRUE, FALSE, NULL)))
+        return;
+    ResetEvent(watch_stop);
+
+    InterlockedExchange(&config_dirs_changed, 0);
+
+    HANDLE *h = calloc(4, sizeof(HANDLE));
+    if (!h)
+    {
+        InterlockedExchange(&config_dirs_changed, 1);
+        return;
+    }
+    h[0] = watch_stop;
+
+    const TCHAR *dirs[] = {o.config_dir, o.global_config_dir, o.config_auto_dir};
+    int n = 1;
+    for (int i = 0; i < 3; i++)
+    {
+        if ((h[n] = WatchConfigDir(dirs[i])) != NULL)
+            n++;
+        else /* cannot tell when this changes: keep rescanning on demand */
+            InterlockedExchange(&config_dirs_changed, 1);
+    }
+
+    watch_thread = CreateThread(NULL, 0, ConfigWatchThread, h, 0, NULL);
+    if (!watch_thread)
+    {
+        for (int i = 1; i < n; i++)
+            FindCloseChangeNotification(h[i]);
+        free(h);
+        InterlockedExchange(&config_dirs_changed, 1);
+    }
+}
+
+/*
+ * Return true if the config list may be out of date: a config folder
+ * has changed or a setting that affects the scan or the menu layout
+ * is different from that of the last scan. Does not access the file
+ * system.
+ */
+BOOL
+ConfigListChanged(void)
+{
+    return config_dirs_changed
+           || _tcscmp(scanned.config_dir, o.config_dir)
+           || _tcscmp(scanned.global_config_dir, o.global_config_dir)
+           || _tcscmp(scanned.config_auto_dir, o.config_auto_dir)
+           || scanned.service_state != o.service_state
+           || scanned.enable_persistent != o.enable_persistent
+           || scanned.config_menu_view != o.config_menu_view
+           || scanned.language != GetGUILanguage();
+}
+
 void
 BuildFileList()
 {
@@ -418,6 +572,19 @@ BuildFileList()
     if (o.silent_connection)
         issue_warnings = false;
 
+    TRACE_BEGIN("BuildFileList");
+
+    ConfigWatchRestart();
+    _tcsncpy(scanned.config_dir, o.config_dir, _countof(scanned.config_dir));
+    _tcsncpy(scanned.global_config_dir, o.global_config_dir, _countof(scanned.global_config_dir));
+    _tcsncpy(scanned.config_auto_dir, o.config_auto_dir, _countof(scanned.config_auto_dir));
+    scanned.service_state = o.service_state;
+    scanned.enable_persistent = o.enable_persistent;
+    scanned.config_menu_view = o.config_menu_view;
+    scanned.language = GetGUILanguage();
+
+    struct config_list l = { .kept = o.num_configs };
+
     /*
      * If no connections are active reset num_configs and rescan
      * to make a new list. Else we keep all current configs and
@@ -429,10 +596,9 @@ BuildFileList()
     if (!o.num_groups
         || (CountConnState(disconnected) == o.num_configs && o.enable_persistent != 2))
     {
-        o.num_configs = 0;
-        o.num_groups = 0;
+        l.kept = 0;
         flags |= FLAG_ADD_CONFIG_GROUPS;
-        root0 = NewConfigGroup(L"ROOT", -1, flags); /* -1 indicates no parent */
+        root0 = NewConfigGroup(&l, L"ROOT", -1, flags); /* -1 indicates no parent */
     }
     else
         root0 = 0;
@@ -442,40 +608,87 @@ BuildFileList()
         flags |= FLAG_WARN_DUPLICATES | FLAG_WARN_MAX_CONFIGS;
     }
 
-    BuildFileList0 (o.config_dir, recurse_depth, root0, flags);
+    BuildFileList0 (&l, o.config_dir, recurse_depth, root0, flags);
 
-    int root1 = NewConfigGroup(L"System Profiles", root0, flags);
+    int root1 = NewConfigGroup(&l, L"System Profiles", root0, flags);
     if (!IsSamePath(o.global_config_dir, o.config_dir))
     {
-        BuildFileList0 (o.global_config_dir, recurse_depth, root1, flags);
+        BuildFileList0 (&l, o.global_config_dir, recurse_depth, root1, flags);
     }
 
     if (o.service_state == service_connected
         && o.enable_persistent)
     {
-        root1 = NewConfigGroup(L"Persistent Profiles", root0, flags);
+        root1 = NewConfigGroup(&l, L"Persistent Profiles", root0, flags);
         if (!IsSamePath(o.config_auto_dir, o.config_dir))
         {
-            BuildFileList0 (o.config_auto_dir, recurse_depth, root1, flags);
+            BuildFileList0 (&l, o.config_auto_dir, recurse_depth, root1, flags);
         }
     }
 
-    if (o.num_configs == 0 && issue_warnings)
-        ShowLocalizedMsg(IDS_NFO_NO_CONFIGS, o.config_dir, o.global_config_dir);
-
     /* More than max_configs are ignored in the menu listing */
-    if (o.num_configs > max_configs)
+    int num_configs = l.kept + l.num_configs;
+    BOOL too_many = (num_configs > max_configs);
+    if (too_many)
+    {
+        num_configs = max_configs; /* management-port cant handle more -- ignore the rest */
+        l.num_configs = num_configs - l.kept;
+    }
+
+    /* allocate a larger array before taking the lock, if needed */
+    connection_t *conn = o.conn;
+    int capacity = o.max_configs;
+    if (!conn || num_configs > capacity)
+    {
+        capacity = num_configs + 50;
+        conn = malloc(sizeof(*conn)*capacity);
+        if (!conn)
+            ErrorExit(1, L"Out of memory while scanning configs");
+    }
+
+    /* o.conn may move: keep readers on other threads out while the lists are swapped */
+    AcquireSRWLockExclusive(&o.conn_lock);
+
+    connection_t *old_conn = NULL;
+    config_group_t *old_groups = NULL;
+    if (conn != o.conn)
     {
-        if (issue_warnings)
-            ShowLocalizedMsg(IDS_ERR_MANY_CONFIGS, max_configs);
-        o.num_configs = max_configs; /* management-port cant handle more -- ignore the rest */
+        if (l.kept)
+            memcpy(conn, o.conn, sizeof(*conn)*l.kept);
+        old_conn = o.conn;
+        o.conn = conn;
+        o.max_configs = capacity;
     }
+    if (l.num_configs > 0)
+        memcpy(&o.conn[l.kept], l.conn, sizeof(*l.conn)*l.num_configs);
+    o.num_configs = num_configs;
 
-    /* if adding groups, activate non-empty ones */
-    if (flags &FLAG_ADD_CONFIG_GROUPS)
+    /* if adding groups, swap them in and activate non-empty ones */
+    if (flags & FLAG_ADD_CONFIG_GROUPS)
     {
+        old_groups = o.groups;
+        o.groups = l.groups;
+        o.num_groups = l.num_groups;
+        o.max_groups = l.max_groups;
+        l.groups = NULL;
         ActivateConfigGroups();
     }
 
+    ResetConnStates();
+
+    ReleaseSRWLockExclusive(&o.conn_lock);
+
+    free(old_conn);
+    free(old_groups);
+    free(l.conn);
+    free(l.groups);
+
+    /* popups only once the lock is released */
+    if (o.num_configs == 0 && issue_warnings)
+        ShowLocalizedMsg(IDS_NFO_NO_CONFIGS, o.config_dir, o.global_config_dir);
+    if (too_many && issue_warnings)
+        ShowLocalizedMsg(IDS_ERR_MANY_CONFIGS, max_configs);
+
     issue_warnings = false;
+    TRACE_END("BuildFileList");
 }
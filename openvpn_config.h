@@ -25,6 +25,7 @@
 #include "main.h"
 
 void BuildFileList();
+BOOL ConfigListChanged(void);
 bool ConfigFileOptionExist(int, const char *);
 
 #endif
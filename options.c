@@ -297,6 +297,12 @@ add_option(options_t *options, int i, TCHAR **p)
         {
             options->action = WM_OVPN_RESCAN;
         }
+        else if (streq(p[1], _T("trace")) && p[2])
+        {
+            ++i;
+            options->action = WM_OVPN_TRACE;
+            options->action_arg = p[2];
+        }
         else
         {
             ShowLocalizedMsg(IDS_ERR_BAD_OPTION, p[0]);
@@ -312,6 +318,27 @@ add_option(options_t *options, int i, TCHAR **p)
     {
         options->disable_popup_messages = 1;
     }
+    else if (streq(p[0], _T("trace")))
+    {
+        options->trace = 1;
+    }
+    else if (streq(p[0], _T("profile_startup")))
+    {
+        options->profile_startup = 1;
+    }
+    else if (streq(p[0], _T("mgmt_record")))
+    {
+        options->mgmt_record = 1;
+    }
+    else if (streq(p[0], _T("mgmt_replay")) && p[1])
+    {
+        ++i;
+        options->mgmt_replay = p[1];
+    }
+    else if (streq(p[0], _T("mgmt_replay_fast")))
+    {
+        options->mgmt_replay_fast = 1;
+    }
     else if (streq(p[0], _T("management_port_offset")) && p[1])
     {
         ++i;
@@ -325,6 +352,32 @@ add_option(options_t *options, int i, TCHAR **p)
             options->mgmt_port_offset = tmp;
         }
     }
+    else if (streq(p[0], _T("metrics_port")) && p[1])
+    {
+        ++i;
+        int tmp = _wtoi(p[1]);
+        if (tmp < 0  || tmp > 65535)
+        {
+            MsgToEventLog(EVENTLOG_ERROR_TYPE, L"Specified metrics port is not valid (must be in the range 0 to 65535). Ignored.");
+        }
+        else
+        {
+            options->metrics_port = tmp;
+        }
+    }
+    else if (streq(p[0], _T("start_concurrency")) && p[1])
+    {
+        ++i;
+        int tmp = _wtoi(p[1]);
+        if (tmp < 0)
+        {
+            MsgToEventLog(EVENTLOG_ERROR_TYPE, L"Specified start concurrency is not valid (must be 0 or more). Ignored.");
+        }
+        else
+        {
+            options->start_concurrency = tmp;
+        }
+    }
 
     else
     {
@@ -449,20 +502,129 @@ ProcessCommandLine(options_t *options, TCHAR *command_line)
 }
 
 
-/* Return num of connections with state = check */
-int
-CountConnState(conn_state_t check)
+/*
+ * Connection state bookkeeping: the number of connections in each state
+ * and a list, in config order, of connections that are not disconnected.
+ * Kept current by SetConnState() so that neither requires a scan of all
+ * configs.
+ */
+static SRWLOCK state_lock = SRWLOCK_INIT;
+static volatile LONG state_count[detached + 1]; /* disconnected is not counted */
+static volatile LONG active_count;
+static int active_head = -1;
+
+static void
+ActiveListInsert(int i)
 {
-    int i;
-    int count = 0;
+    int prev = -1, next = active_head;
 
-    for (i = 0; i < o.num_configs; ++i)
+    while (next >= 0 && next < i)
     {
-        if (o.conn[i].state == check)
-            ++count;
+        prev = next;
+        next = o.conn[next].active_next;
     }
+    o.conn[i].active_prev = prev;
+    o.conn[i].active_next = next;
+    if (prev >= 0)
+        o.conn[prev].active_next = i;
+    else
+        active_head = i;
+    if (next >= 0)
+        o.conn[next].active_prev = i;
+}
+
+static void
+ActiveListRemove(int i)
+{
+    int prev = o.conn[i].active_prev, next = o.conn[i].active_next;
+
+    if (prev >= 0)
+        o.conn[prev].active_next = next;
+    else
+        active_head = next;
+    if (next >= 0)
+        o.conn[next].active_prev = prev;
+}
+
+/* Change the state of a connection. All state changes go through here. */
+void
+SetConnState(connection_t *c, conn_state_t state)
+{
+    int i = (int) (c - o.conn);
+
+    AcquireSRWLockExclusive(&state_lock);
+    if (c->state != state)
+    {
+        if (c->state == disconnected)
+        {
+            ActiveListInsert(i);
+            InterlockedIncrement(&active_count);
+        }
+        else
+        {
+            InterlockedDecrement(&state_count[c->state]);
+        }
+
+        if (state == disconnected)
+        {
+            ActiveListRemove(i);
+            InterlockedDecrement(&active_count);
+        }
+        else
+        {
+            InterlockedIncrement(&state_count[state]);
+        }
+        c->state = state;
+    }
+    ReleaseSRWLockExclusive(&state_lock);
+}
 
-    return count;
+/* Recompute counts and the active list after the config list is rebuilt */
+void
+ResetConnStates(void)
+{
+    AcquireSRWLockExclusive(&state_lock);
+    for (size_t s = 0; s < _countof(state_count); s++)
+        state_count[s] = 0;
+    active_count = 0;
+    active_head = -1;
+
+    /* appending in config order keeps the list sorted */
+    int tail = -1;
+    for (int i = 0; i < o.num_configs; ++i)
+    {
+        if (o.conn[i].state == disconnected)
+            continue;
+        state_count[o.conn[i].state]++;
+        active_count++;
+        o.conn[i].active_prev = tail;
+        o.conn[i].active_next = -1;
+        if (tail >= 0)
+            o.conn[tail].active_next = i;
+        else
+            active_head = i;
+        tail = i;
+    }
+    ReleaseSRWLockExclusive(&state_lock);
+}
+
+/* Call func for each connection that is not disconnected, in config order */
+void
+ForEachActiveConn(void (*func)(connection_t *, void *), void *arg)
+{
+    AcquireSRWLockShared(&state_lock);
+    for (int i = active_head; i >= 0; i = o.conn[i].active_next)
+        func(&o.conn[i], arg);
+    ReleaseSRWLockShared(&state_lock);
+}
+
+/* Return num of connections with state = check */
+int
+CountConnState(conn_state_t check)
+{
+    if (check == disconnected)
+        return o.num_configs - active_count;
+    return state_count[check];
 }
 
 connection_t*
@@ -33,6 +33,7 @@ typedef struct connection connection_t;
 #include <lmcons.h>
 
 #include "manage.h"
+#include "mgmt_redact.h"
 #include "echo.h"
 #include "pkcs11.h"
 
@@ -120,6 +121,17 @@ typedef struct config_group {
     HMENU menu;                  /* Handle to menu entry for this group */
 } config_group_t;
 
+/* Max number of daemon state transitions recorded per connection attempt */
+#define MAX_STATE_MARKS 16
+
+/* A daemon state (CONNECTING, WAIT, AUTH etc.) and the monotonic
+ * time in msec (GetTickCount64) at which it was received.
+ */
+typedef struct {
+    char state[20];
+    ULONGLONG tick;
+} state_mark_t;
+
 /* short hand for pointer to the group a config belongs to */
 #define CONFIG_GROUP(c) (&o.groups[(c)->group])
 #define PARENT_GROUP(cg) ((cg)->parent < 0 ? NULL : &o.groups[(cg)->parent])
@@ -133,9 +145,17 @@ struct connection {
     TCHAR ip[16];                   /* Assigned IP address for this connection */
     TCHAR ipv6[46];                 /* Assigned IPv6 address */
     BOOL auto_connect;              /* AutoConnect at startup id TRUE */
-    conn_state_t state;             /* State the connection currently is in */
+    ULONGLONG attach_tick;          /* Time of last attach to a persistent daemon, 0 if none */
+    int attach_drops;               /* Consecutive attaches lost soon after */
+    BOOL start_retry;               /* Started from the start queue: retry if it fails to connect, reset by OnStop */
+    int start_kind;                 /* start_kind_t of that queued start */
+    int start_attempts;             /* Consecutive failed starts from the queue */
+    conn_state_t state;             /* State the connection currently is in -- change using SetConnState() */
+    int active_prev;                /* Links in the list of connections not disconnected, -1 terminated */
+    int active_next;
     int failed_psw_attempts;        /* # of failed attempts entering password(s) */
     int failed_auth_attempts;       /* # of failed user-auth attempts */
+    int reconnects;                 /* # of reconnects reported by the daemon */
     time_t connected_since;         /* Time when the connection was established */
     proxy_t proxy_type;             /* Set during querying proxy credentials */
     int group;                      /* ID of the group this config belongs to */
@@ -150,22 +170,45 @@ struct connection {
         size_t saved_size;
         mgmt_cmd_t *cmd_queue;
         DWORD connected;             /* 1: management interface connected, 2: connected and ready */
+        FILE *record;                /* recording of received data, if enabled */
+        ULONGLONG record_tick;       /* time of the last recorded chunk */
+        mgmt_redact_t record_redact; /* masking of secrets in the recording */
+        struct mgmt_replay *replay;  /* set when data is replayed from a recording */
     } manage;
 
     HANDLE hProcess;                /* Handle of openvpn process if directly started */
     service_io_t iserv;
 
     HANDLE exit_event;
-    DWORD threadId;
-    HWND hwndStatus;
+    DWORD threadId;                /* Worker thread hosting the connection */
+    HANDLE wait_handle;            /* Registered wait on hProcess or iserv.hEvent */
+    HANDLE done_event;             /* Set when the connection is no longer hosted by a worker */
+    HWND hwndConn;                 /* Message-only window of the connection on its worker */
+    HWND hwndStatus;               /* Status window, only created while it is shown */
+    struct {
+        UINT text;                 /* Resource id of the status text */
+        int icon;                  /* ID_ICO_* of the status window */
+        BOOL disconnect;           /* Disconnect button enabled */
+        BOOL restart;              /* Restart button enabled */
+        BOOL plap;                 /* Hide the detach and disconnect buttons */
+    } status;                      /* Status window contents, kept while it is not shown */
+    struct status_log *log;        /* Recent lines of the status window log */
+    SRWLOCK log_lock;
     int flags;
     char *dynamic_cr;              /* Pointer to buffer for dynamic challenge string received */
     unsigned long long int bytes_in;
     unsigned long long int bytes_out;
-    struct env_item *es;           /* Pointer to the head of config-specific env variables list */
+    int bytecount_interval;        /* Interval (sec) of bytecount reports currently requested from daemon */
+    struct env_set *es;            /* Config-specific env variables set by the server */
     struct echo_msg echo_msg;      /* Message echo-ed from server or client config and related data */
     struct pkcs11_list pkcs11_list;
     char daemon_state[20];         /* state of openvpn.ex: WAIT, AUTH, GET_CONFIG etc.. */
+    struct {
+        state_mark_t mark[MAX_STATE_MARKS];
+        int count;
+    } timeline;                    /* daemon state transitions of the current connection attempt */
+    SRWLOCK stats_lock;            /* held exclusive while daemon_state, bytes_in/out or timeline
+                                    * change: readers on other threads take it shared */
 };
 
 /* All options used within OpenVPN GUI */
@@ -223,6 +266,18 @@ typedef struct {
 
     DWORD ovpn_engine;                  /* 0 - openvpn2, 1 - openvpn3 */
     DWORD enable_persistent;            /* 0 - disabled, 1 - enabled, 2 - enabled & auto attach */
+    DWORD metrics_port;                 /* loopback port of the metrics endpoint, 0 = disabled */
+    DWORD start_concurrency;            /* max connections being started at once, 0 = no limit */
+    DWORD trace;                        /* record trace events from startup */
+    DWORD profile_startup;              /* log durations of startup phases */
+    /*
+     * Recordings are plaintext and readable by anyone with access to
+     * log_dir. Pushed auth-tokens, dynamic challenge states and web auth
+     * URLs are masked, everything else received is kept as is.
+     */
+    DWORD mgmt_record;                  /* record management sessions to log_dir */
+    const WCHAR *mgmt_replay;           /* recording to replay at startup */
+    DWORD mgmt_replay_fast;             /* replay without the recorded delays */
 #ifdef DEBUG
     FILE *debug_fp;
 #endif
@@ -240,11 +295,15 @@ typedef struct {
     TCHAR *action_arg;
     HANDLE session_semaphore;
     HANDLE event_log;
+    SRWLOCK conn_lock;     /* held exclusive while conn[] is rebuilt */
 } options_t;
 
 void InitOptions(options_t *);
 void ProcessCommandLine(options_t *, TCHAR *);
 int CountConnState(conn_state_t);
+void SetConnState(connection_t *, conn_state_t);
+void ResetConnStates(void);
+void ForEachActiveConn(void (*func)(connection_t *, void *), void *arg);
 connection_t* GetConnByManagement(SOCKET);
 connection_t* GetConnByName(const WCHAR *config_name);
 INT_PTR CALLBACK ScriptSettingsDlgProc(HWND hwndDlg, UINT msg, WPARAM wParam, LPARAM lParam);
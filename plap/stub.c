@@ -152,7 +152,11 @@ BOOL IsKeyPassSaved(UNUSED const WCHAR *config_name)
 {
     return 0;
 }
-void env_item_del_all(UNUSED struct env_item *head)
+void env_set_free(UNUSED struct env_set *es)
+{
+    return;
+}
+void env_process_changed(void)
 {
     return;
 }
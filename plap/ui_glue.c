@@ -61,10 +61,9 @@ OnStop_(connection_t *c, UNUSED char *msg)
     dmsg(L"profile: %ls with state = %d", c->config_name, c->state);
 
     /* do not show any popup error messages */
-    c->state = disconnected;
-    SetDlgItemText(c->hwndStatus, ID_TXT_STATUS, LoadLocalizedString(IDS_NFO_STATE_DISCONNECTED));
-    SetStatusWinIcon(c->hwndStatus, ID_ICO_DISCONNECTED);
-    SendMessage(c->hwndStatus, WM_CLOSE, 0, 0);
+    SetConnState(c, disconnected);
+    SetStatusText(c, IDS_NFO_STATE_DISCONNECTED);
+    SendMessage(c->hwndConn, WM_CLOSE, 0, 0);
 }
 
 /* Override OnInfoMsg: We filter out anything other
@@ -156,7 +155,7 @@ OnStateChange_(connection_t *c, char *msg)
          * let disconnect process continue. This is required to
          * retain the hold state after SIGHUP restart.
          */
-        c->state = disconnecting;
+        SetConnState(c, disconnecting);
     }
 }
 
@@ -300,36 +299,36 @@ FindPLAPConnections(connection_t *conn[], size_t max_count)
     return count;
 }
 
+#define CLOSE_TIMEOUT 2000 /* msec */
+
+/* Wait for the worker thread to stop hosting the connection, else ask it to close */
 static void
 WaitOnThread (connection_t *c, DWORD timeout)
 {
-    HANDLE h = OpenThread(THREAD_ALL_ACCESS, FALSE, c->threadId);
-    if (!h)
+    /* done_event is set while the connection is not hosted by a worker */
+    if (!c->done_event || WaitForSingleObject(c->done_event, timeout) == WAIT_OBJECT_0)
     {
-        dmsg(L"Failed to get handle to the connection thread");
-        goto out;
+        dmsg(L"Connection closed");
+        return;
     }
 
-    DWORD exit_code;
-    if (WaitForSingleObject(h, timeout) == WAIT_OBJECT_0 &&
-        GetExitCodeThread(h, &exit_code) && exit_code != STILL_ACTIVE)
+    /* The worker is shared with other connections: never terminate it.
+     * Close the connection if it is down, else stop it first.
+     */
+    dmsg(L"Connection still open -- closing it");
+    if (c->state == disconnected || c->state == detached)
     {
-        dmsg(L"Connection thread closed");
-        goto out;
+        if (c->hwndConn)
+            PostMessage(c->hwndConn, WM_CLOSE, 0, 0);
     }
-
-    /* Kill the thread */
-    dmsg(L"Force terminating a connection thread");
-    TerminateThread (h, 1);
-    c->hwndStatus = NULL;
-    c->threadId = 0;
-
-out:
-    if (h && h != INVALID_HANDLE_VALUE)
+    else
     {
-        CloseHandle(h);
+        StopOpenVPN(c);
+    }
+    if (WaitForSingleObject(c->done_event, CLOSE_TIMEOUT) != WAIT_OBJECT_0)
+    {
+        dmsg(L"Connection not closed in %d msec", CLOSE_TIMEOUT);
     }
-    return;
 }
 
 void
@@ -343,17 +342,24 @@ GetConnectionStatusText(connection_t *c, wchar_t *status, DWORD len)
         *status = '\0';
     }
 
-    if (c->hwndStatus)
+    if (c->hwndConn)
     {
-        GetDlgItemText(c->hwndStatus, ID_TXT_STATUS, status_text, _countof(status_text));
+        char daemon_state[sizeof(c->daemon_state)];
+
+        AcquireSRWLockShared(&c->stats_lock);
+        strncpy_s(daemon_state, _countof(daemon_state), c->daemon_state, _TRUNCATE);
+        ReleaseSRWLockShared(&c->stats_lock);
+
+        if (c->status.text)
+            LoadLocalizedStringBuf(status_text, _countof(status_text), c->status.text);
         /* showing RECONNECTING while on hold is confusing, use status text */
-        if ((strcmp(c->daemon_state, "RECONNECTING") == 0) && c->state == onhold && *status_text)
+        if ((strcmp(daemon_state, "RECONNECTING") == 0) && c->state == onhold && *status_text)
         {
             wcsncpy_s(status, len, status_text, _TRUNCATE);
         }
-        else if (*c->daemon_state) /* this is more fine-grained and thus preferred */
+        else if (*daemon_state) /* this is more fine-grained and thus preferred */
         {
-            __sntprintf_0(status, len, L"%hs", c->daemon_state);
+            __sntprintf_0(status, len, L"%hs", daemon_state);
         }
         else if (*status_text)
         {
@@ -371,16 +377,12 @@ SetParentWindow(HWND hwnd)
 void
 ShowStatusWindow(connection_t *c, BOOL show)
 {
-    if (c->hwndStatus)
-    {
-        /* Do not enable detach button in the PLAP mode */
-        ShowWindowAsync(GetDlgItem(c->hwndStatus, ID_DETACH), SW_HIDE);
-        /* Disconnecting from status Window gives no feedback to progress dialog.
-         * Do not show the disconnect button.
-         */
-        ShowWindowAsync(GetDlgItem(c->hwndStatus, ID_DISCONNECT), SW_HIDE);
-        ShowWindowAsync(c->hwndStatus, show ? SW_SHOW : SW_HIDE);
-    }
+    /* Do not enable detach button in the PLAP mode. Disconnecting from
+     * status Window gives no feedback to progress dialog: do not show the
+     * disconnect button either.
+     */
+    c->status.plap = TRUE;
+    ShowStatusWindowAsync(c, show);
 }
 
 
@@ -410,11 +412,8 @@ DetachAllOpenVPN()
 
     for (i = 0; i < o.num_configs; i++)
     {
-        if (o.conn[i].hwndStatus)
-        {
-            /* Status thread still running? kill it */
-            WaitOnThread(&o.conn[i], 0);
-        }
+        /* Connection still hosted by a worker? close it */
+        WaitOnThread(&o.conn[i], 0);
     }
 }
 
@@ -467,11 +466,6 @@ DisconnectHelper(connection_t *c)
         return;
     }
 
-    /* disconnect will not work if disconnect button is disabled on the status
-     * window -- enable it until out of here.
-     */
-    ShowWindowAsync(GetDlgItem(c->hwndStatus, ID_DISCONNECT), SW_SHOW);
-
     dmsg(L"sending stop");
     StopOpenVPN(c);
 
@@ -482,8 +476,6 @@ DisconnectHelper(connection_t *c)
         Sleep(100);
     }
 
-    ShowWindowAsync(GetDlgItem(c->hwndStatus, ID_DISCONNECT), SW_HIDE);
-
     dmsg(L"profile: %ls state = %d", c->config_name, c->state);
 }
 
@@ -0,0 +1,293 @@
+/*
+ *  OpenVPN-GUI -- A Windows GUI for OpenVPN.
+ *
+ *  Copyright (C) 2026 OpenVPN GUI contributors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program (see the file COPYING included with this
+ *  distribution); if not, write to the Free Software Foundation, Inc.,
+ *  59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <windows.h>
+#include <commctrl.h>
+#include <stdlib.h>
+#include <wchar.h>
+
+#include "main.h"
+#include "options.h"
+#include "openvpn.h"
+#include "openvpn-gui-res.h"
+#include "localization.h"
+#include "misc.h"
+#include "quickconnect.h"
+#include "quickconnect_index.h"
+
+extern options_t o;
+
+#define QC_MAX_SHOWN  100    /* max number of results listed */
+#define QC_MRU_MAX    32     /* number of recently used configs ranked higher */
+
+static struct {
+    qc_index_t index;   /* one entry per config, same order as o.conn */
+    HWND dialog;
+} qc;
+
+/* Names of recently used configs, most recent first */
+static WCHAR mru[QC_MRU_MAX][MAX_PATH];
+static int mru_count;
+
+/*
+ * Write the group path of c to buf as "outer/inner/". The root group
+ * is not included. Returns the length of the path.
+ */
+static int
+GroupPath(const connection_t *c, WCHAR *buf, int size)
+{
+    const config_group_t *chain[32];
+    int depth = 0;
+    int len = 0;
+
+    for (const config_group_t *g = CONFIG_GROUP(c); g && g != &o.groups[0]; g = PARENT_GROUP(g))
+    {
+        if (depth == _countof(chain))
+            break;
+        chain[depth++] = g;
+    }
+
+    buf[0] = L'\0';
+    while (depth-- > 0)
+    {
+        int n = _snwprintf(buf + len, size - len - 1, L"%ls/", chain[depth]->name);
+        if (n < 0)
+            break;
+        len += n;
+    }
+    buf[len] = L'\0';
+    return len;
+}
+
+/* Set the ranking bonus of recently used configs */
+static void
+RankRecent(void)
+{
+    for (int i = 0; i < qc.index.count; i++)
+        qc.index.entries[i].recent = 0;
+
+    for (int r = 0; r < mru_count; r++)
+    {
+        for (int i = 0; i < qc.index.count; i++)
+        {
+            if (wcscmp(o.conn[i].config_name, mru[r]) == 0)
+            {
+                qc.index.entries[i].recent = QC_MRU_MAX - r;
+                break;
+            }
+        }
+    }
+}
+
+static void QuickConnectRefresh(HWND hwndDlg);
+
+void
+QuickConnectIndexBuild(void)
+{
+    WCHAR path[MAX_PATH];
+
+    if (!qc_index_reset(&qc.index, o.num_configs))
+    {
+        MsgToEventLog(EVENTLOG_ERROR_TYPE, L"Out of memory while building the quick connect index");
+        goto out;
+    }
+
+    for (int i = 0; i < o.num_configs; i++)
+    {
+        GroupPath(&o.conn[i], path, _countof(path));
+        if (!qc_index_add(&qc.index, path, o.conn[i].config_name))
+        {
+            MsgToEventLog(EVENTLOG_ERROR_TYPE, L"Out of memory while building the quick connect index");
+            goto out;
+        }
+    }
+    RankRecent();
+
+out:
+    /* result list holds config indices that may have changed */
+    if (qc.dialog)
+        QuickConnectRefresh(qc.dialog);
+}
+
+void
+QuickConnectNoteUse(const connection_t *c)
+{
+    int r;
+
+    for (r = 0; r < mru_count; r++)
+    {
+        if (wcscmp(mru[r], c->config_name) == 0)
+            break;
+    }
+    if (r == mru_count && mru_count < QC_MRU_MAX)
+        mru_count++;
+    if (r == QC_MRU_MAX)
+        r--; /* drop the oldest */
+
+    memmove(mru[1], mru[0], r*sizeof(mru[0]));
+    wcsncpy_s(mru[0], _countof(mru[0]), c->config_name, _TRUNCATE);
+
+    RankRecent();
+}
+
+/* Fill the result list of the dialog from the current query */
+static void
+QuickConnectRefresh(HWND hwndDlg)
+{
+    WCHAR query[_countof(qc.index.last_query)];
+    WCHAR path[MAX_PATH];
+    WCHAR item[2*MAX_PATH];
+    struct qc_result results[QC_MAX_SHOWN];
+    HWND list = GetDlgItem(hwndDlg, ID_LST_QUICKCONNECT);
+
+    GetDlgItemTextW(hwndDlg, ID_EDT_QUICKCONNECT, query, _countof(query));
+    int n = qc_index_query(&qc.index, query, results, _countof(results));
+
+    SendMessage(list, WM_SETREDRAW, FALSE, 0);
+    SendMessage(list, LB_RESETCONTENT, 0, 0);
+    for (int k = 0; k < n; k++)
+    {
+        const connection_t *c = &o.conn[results[k].index];
+        int len = GroupPath(c, path, _countof(path));
+
+        if (len > 0)
+        {
+            path[len - 1] = L'\0'; /* trailing '/' */
+            _sntprintf_0(item, L"%ls  (%ls)", c->config_name, path);
+        }
+        else
+        {
+            _sntprintf_0(item, L"%ls", c->config_name);
+        }
+        LRESULT pos = SendMessage(list, LB_ADDSTRING, 0, (LPARAM) item);
+        SendMessage(list, LB_SETITEMDATA, pos, results[k].index);
+    }
+    if (n > 0)
+        SendMessage(list, LB_SETCURSEL, 0, 0);
+    SendMessage(list, WM_SETREDRAW, TRUE, 0);
+    InvalidateRect(list, NULL, TRUE);
+
+    EnableWindow(GetDlgItem(hwndDlg, IDOK), n > 0);
+}
+
+/* Connect the selected config, or show its status if already started */
+static void
+QuickConnectSelected(HWND hwndDlg)
+{
+    HWND list = GetDlgItem(hwndDlg, ID_LST_QUICKCONNECT);
+    LRESULT sel = SendMessage(list, LB_GETCURSEL, 0, 0);
+
+    if (sel == LB_ERR)
+        return;
+    int i = (int) SendMessage(list, LB_GETITEMDATA, sel, 0);
+    if (i < 0 || i >= o.num_configs)
+        return;
+
+    connection_t *c = &o.conn[i];
+    EndDialog(hwndDlg, IDOK);
+
+    if (c->state == disconnected)
+    {
+        QuickConnectNoteUse(c);
+        StartOpenVPN(c);
+    }
+    else
+    {
+        ShowStatusWindowAsync(c, TRUE);
+    }
+}
+
+/* Let the arrow and page keys move the list selection while typing */
+static LRESULT CALLBACK
+QueryEditProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam, UINT_PTR id, DWORD_PTR list)
+{
+    if (msg == WM_KEYDOWN
+        && (wParam == VK_UP || wParam == VK_DOWN || wParam == VK_PRIOR || wParam == VK_NEXT))
+    {
+        SendMessage((HWND) list, msg, wParam, lParam);
+        return 0;
+    }
+    return DefSubclassProc(hwnd, msg, wParam, lParam);
+}
+
+static INT_PTR CALLBACK
+QuickConnectDialogFunc(HWND hwndDlg, UINT msg, WPARAM wParam, UNUSED LPARAM lParam)
+{
+    HWND edit = GetDlgItem(hwndDlg, ID_EDT_QUICKCONNECT);
+
+    switch (msg)
+    {
+    case WM_INITDIALOG:
+        qc.dialog = hwndDlg;
+        qc.index.have_matches = FALSE;
+        SetStatusWinIcon(hwndDlg, ID_ICO_APP);
+        SetWindowSubclass(edit, QueryEditProc, 0,
+                          (DWORD_PTR) GetDlgItem(hwndDlg, ID_LST_QUICKCONNECT));
+        QuickConnectRefresh(hwndDlg);
+        SetFocus(edit);
+        return FALSE;
+
+    case WM_COMMAND:
+        switch (LOWORD(wParam))
+        {
+        case ID_EDT_QUICKCONNECT:
+            if (HIWORD(wParam) == EN_CHANGE)
+                QuickConnectRefresh(hwndDlg);
+            break;
+
+        case ID_LST_QUICKCONNECT:
+            if (HIWORD(wParam) == LBN_DBLCLK)
+                QuickConnectSelected(hwndDlg);
+            break;
+
+        case IDOK:
+            QuickConnectSelected(hwndDlg);
+            return TRUE;
+
+        case IDCANCEL:
+            EndDialog(hwndDlg, IDCANCEL);
+            return TRUE;
+        }
+        break;
+
+    case WM_DESTROY:
+        RemoveWindowSubclass(edit, QueryEditProc, 0);
+        qc.dialog = NULL;
+        qc.index.have_matches = FALSE;
+        break;
+    }
+    return FALSE;
+}
+
+void
+ShowQuickConnectDialog(void)
+{
+    if (qc.dialog)
+    {
+        SetForegroundWindow(qc.dialog);
+        return;
+    }
+    LocalizedDialogBoxParam(ID_DLG_QUICKCONNECT, QuickConnectDialogFunc, 0);
+}
@@ -0,0 +1,39 @@
+/*
+ *  OpenVPN-GUI -- A Windows GUI for OpenVPN.
+ *
+ *  Copyright (C) 2026 OpenVPN GUI contributors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program (see the file COPYING included with this
+ *  distribution); if not, write to the Free Software Foundation, Inc.,
+ *  59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef QUICKCONNECT_H
+#define QUICKCONNECT_H
+
+#include "options.h"
+
+/*
+ * Rebuild the search index of the quick connect dialog. Call after
+ * BuildFileList() has changed the config list.
+ */
+void QuickConnectIndexBuild(void);
+
+/* Record that a connection was started by the user, for ranking */
+void QuickConnectNoteUse(const connection_t *c);
+
+/* Show the quick connect dialog or bring it to the front if open */
+void ShowQuickConnectDialog(void);
+
+#endif
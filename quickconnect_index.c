@@ -0,0 +1,261 @@
+/*
+ *  OpenVPN-GUI -- A Windows GUI for OpenVPN.
+ *
+ *  Copyright (C) 2026 OpenVPN GUI contributors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program (see the file COPYING included with this
+ *  distribution); if not, write to the Free Software Foundation, Inc.,
+ *  59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <windows.h>
+#include <stdlib.h>
+#include <wchar.h>
+#include <wctype.h>
+
+#include "quickconnect_index.h"
+
+static ULONGLONG
+CharBit(WCHAR ch)
+{
+    return 1ULL << (((UINT) ch * 0x9E3779B1u) >> 26);
+}
+
+BOOL
+qc_index_reset(qc_index_t *idx, int capacity)
+{
+    int n = max(capacity, 1);
+
+    free(idx->entries);
+    free(idx->matches);
+    idx->entries = calloc(n, sizeof(*idx->entries));
+    idx->matches = calloc(n, sizeof(*idx->matches));
+    idx->count = 0;
+    idx->capacity = n;
+    idx->pool_used = 0;
+    idx->have_matches = FALSE;
+
+    if (!idx->entries || !idx->matches)
+    {
+        free(idx->entries);
+        free(idx->matches);
+        idx->entries = NULL;
+        idx->matches = NULL;
+        idx->capacity = 0;
+        return FALSE;
+    }
+    return TRUE;
+}
+
+BOOL
+qc_index_add(qc_index_t *idx, const WCHAR *path, const WCHAR *name)
+{
+    int plen = (int) wcslen(path);
+    int nlen = (int) wcslen(name);
+    size_t need = idx->pool_used + plen + nlen + 1;
+
+    if (idx->count >= idx->capacity)
+        return FALSE;
+
+    if (need > idx->pool_size)
+    {
+        size_t size = max(max(need, 2*idx->pool_size), 4096);
+        WCHAR *tmp = realloc(idx->pool, size*sizeof(WCHAR));
+        if (!tmp)
+            return FALSE;
+        idx->pool = tmp;
+        idx->pool_size = size;
+    }
+
+    struct qc_entry *e = &idx->entries[idx->count];
+    WCHAR *text = idx->pool + idx->pool_used;
+    wmemcpy(text, path, plen);
+    wmemcpy(text + plen, name, nlen);
+    text[plen + nlen] = L'\0';
+    CharLowerBuffW(text, plen + nlen);
+
+    e->text = (int) idx->pool_used;
+    e->len = plen + nlen;
+    e->name = plen;
+    e->recent = 0;
+    e->sig = 0;
+    for (int k = 0; k < e->len; k++)
+        e->sig |= CharBit(text[k]);
+
+    idx->pool_used = need;
+    idx->count++;
+    idx->have_matches = FALSE;
+    return TRUE;
+}
+
+/*
+ * Score a fuzzy match of the query q against text: all characters of q
+ * must appear in text in order. Matches at the start of words and runs
+ * of consecutive matches score higher. Returns -1 if there is no match.
+ */
+static int
+MatchScore(const WCHAR *text, int len, const WCHAR *q, int qlen)
+{
+    int score = 0;
+    int run = 0;
+    int pos = 0;
+
+    for (int k = 0; k < qlen; k++)
+    {
+        while (pos < len && text[pos] != q[k])
+        {
+            pos++;
+            run = 0;
+        }
+        if (pos == len)
+            return -1;
+
+        score += 1 + 3*run;
+        if (pos == 0 || wcschr(L"/ -_.", text[pos-1]))
+            score += 8;
+        run = min(run + 1, 4);
+        pos++;
+    }
+    return score;
+}
+
+static int
+EntryScore(const qc_index_t *idx, const struct qc_entry *e, const WCHAR *q, int qlen)
+{
+    const WCHAR *text = idx->pool + e->text;
+    int score;
+
+    if (qlen == 0)
+        return e->recent;
+
+    /* prefer matches within the config name over those spanning the path */
+    score = MatchScore(text + e->name, e->len - e->name, q, qlen);
+    if (score >= 0)
+        score += 16;
+    else
+        score = MatchScore(text, e->len, q, qlen);
+
+    if (score < 0)
+        return -1;
+    return score + e->recent - e->len/16;
+}
+
+/* true if result a ranks below result b */
+static BOOL
+RanksBelow(const struct qc_result *a, const struct qc_result *b)
+{
+    return a->score < b->score || (a->score == b->score && a->index > b->index);
+}
+
+/* Add r to a min-heap of the best results holding at most max entries */
+static void
+KeepBest(struct qc_result *heap, int *n, int max, struct qc_result r)
+{
+    int i;
+
+    if (*n < max)
+    {
+        /* sift up */
+        for (i = (*n)++; i > 0 && RanksBelow(&r, &heap[(i-1)/2]); i = (i-1)/2)
+            heap[i] = heap[(i-1)/2];
+        heap[i] = r;
+        return;
+    }
+    if (!RanksBelow(&heap[0], &r))
+        return;
+
+    /* replace the worst and sift down */
+    for (i = 0; 2*i + 1 < *n; )
+    {
+        int child = 2*i + 1;
+        if (child + 1 < *n && RanksBelow(&heap[child+1], &heap[child]))
+            child++;
+        if (!RanksBelow(&heap[child], &r))
+            break;
+        heap[i] = heap[child];
+        i = child;
+    }
+    heap[i] = r;
+}
+
+static int
+CompareResults(const void *a, const void *b)
+{
+    const struct qc_result *ra = a;
+    const struct qc_result *rb = b;
+
+    if (ra->score != rb->score)
+        return rb->score - ra->score;
+    return ra->index - rb->index;
+}
+
+int
+qc_index_query(qc_index_t *idx, const WCHAR *query, struct qc_result *results, int max)
+{
+    WCHAR q[_countof(idx->last_query)];
+    int qlen = 0;
+    ULONGLONG sig = 0;
+    int nresults = 0;
+    int nmatches = 0;
+
+    for (; *query && qlen < _countof(q) - 1; query++)
+    {
+        if (!iswspace(*query))
+            q[qlen++] = *query;
+    }
+    q[qlen] = L'\0';
+    CharLowerBuffW(q, qlen);
+    for (int k = 0; k < qlen; k++)
+        sig |= CharBit(q[k]);
+
+    /* anything that matches the query also matches its prefixes */
+    BOOL narrow = idx->have_matches
+                  && wcsncmp(q, idx->last_query, wcslen(idx->last_query)) == 0;
+    int ncandidates = narrow ? idx->nmatches : idx->count;
+
+    for (int j = 0; j < ncandidates; j++)
+    {
+        int i = narrow ? idx->matches[j] : j;
+        const struct qc_entry *e = &idx->entries[i];
+
+        if ((e->sig & sig) != sig)
+            continue;
+        int score = EntryScore(idx, e, q, qlen);
+        if (score < 0)
+            continue;
+
+        idx->matches[nmatches++] = i; /* never overtakes j */
+        KeepBest(results, &nresults, max, (struct qc_result) {score, i});
+    }
+
+    idx->nmatches = nmatches;
+    idx->have_matches = (idx->count > 0);
+    wmemcpy(idx->last_query, q, qlen + 1);
+
+    qsort(results, nresults, sizeof(*results), CompareResults);
+    return nresults;
+}
+
+void
+qc_index_free(qc_index_t *idx)
+{
+    free(idx->entries);
+    free(idx->matches);
+    free(idx->pool);
+    memset(idx, 0, sizeof(*idx));
+}
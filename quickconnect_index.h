@@ -0,0 +1,90 @@
+/*
+ *  OpenVPN-GUI -- A Windows GUI for OpenVPN.
+ *
+ *  Copyright (C) 2026 OpenVPN GUI contributors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program (see the file COPYING included with this
+ *  distribution); if not, write to the Free Software Foundation, Inc.,
+ *  59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef QUICKCONNECT_INDEX_H
+#define QUICKCONNECT_INDEX_H
+
+/*
+ * Search index of the quick connect dialog. Entries are scanned
+ * linearly: a 64-bit signature of the characters in each entry rules
+ * out most non-matching entries before the fuzzy match is scored, and
+ * a query that extends the previous one only looks at its matches.
+ * Uses no Windows API beyond CharLowerBuffW so that it can be tested
+ * on any host (see tests/).
+ */
+
+#include <windows.h>
+
+/*
+ * Search entry of a config: the text is the group path and config name
+ * joined by '/' and lower-cased. The signature has a bit set for each
+ * character in the text: only entries that have all bits of the query
+ * set can match it.
+ */
+struct qc_entry {
+    ULONGLONG sig;
+    int text;           /* offset of the text in the pool */
+    int len;            /* length of the text */
+    int name;           /* offset of the config name in the text */
+    int recent;         /* ranking bonus for recent use */
+};
+
+struct qc_result {
+    int score;
+    int index;
+};
+
+typedef struct {
+    struct qc_entry *entries;
+    int count;
+    int capacity;
+    WCHAR *pool;
+    size_t pool_size;
+    size_t pool_used;
+
+    /* entries matching the last query: an extended query only looks at these */
+    WCHAR last_query[256];
+    int *matches;
+    int nmatches;
+    BOOL have_matches;
+} qc_index_t;
+
+/* Empty the index and make room for capacity entries. Returns false on error */
+BOOL qc_index_reset(qc_index_t *idx, int capacity);
+
+/*
+ * Add an entry for config name in the group path ("outer/inner/" or
+ * empty). Entries are numbered in the order added. Returns false on
+ * error or if the index is full.
+ */
+BOOL qc_index_add(qc_index_t *idx, const WCHAR *path, const WCHAR *name);
+
+/*
+ * Find entries matching query and return up to max of them in results,
+ * best first. White space in the query is ignored. Returns the number
+ * of results.
+ */
+int qc_index_query(qc_index_t *idx, const WCHAR *query, struct qc_result *results, int max);
+
+/* Release all memory of the index */
+void qc_index_free(qc_index_t *idx);
+
+#endif
@@ -66,6 +66,9 @@ struct regkey_int {
       {L"disable_popup_messages", &o.disable_popup_messages, 0},
       {L"management_port_offset", &o.mgmt_port_offset, 25340},
       {L"enable_peristent_connections", &o.enable_persistent, 2},
+      {L"metrics_port", &o.metrics_port, 0},
+      {L"start_concurrency", &o.start_concurrency, 4},
+      {L"mgmt_record", &o.mgmt_record, 0},
       {L"ovpn_engine", &o.ovpn_engine, OPENVPN_ENGINE_OVPN2}
     };
 
@@ -210,6 +213,10 @@ GetRegistryKeys ()
     {
         o.mgmt_port_offset = 25340;
     }
+    if (o.metrics_port > 65535)
+    {
+        o.metrics_port = 0;
+    }
 
     ExpandOptions ();
     return true;
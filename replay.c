@@ -0,0 +1,327 @@
+/*
+ *  OpenVPN-GUI -- A Windows GUI for OpenVPN.
+ *
+ *  Copyright (C) 2026 OpenVPN GUI contributors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program (see the file COPYING included with this
+ *  distribution); if not, write to the Free Software Foundation, Inc.,
+ *  59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <windows.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "main.h"
+#include "options.h"
+#include "manage.h"
+#include "openvpn.h"
+#include "openvpn-gui-res.h"
+#include "misc.h"
+#include "replay.h"
+
+extern options_t o;
+
+/*
+ * File format: the magic, a WORD giving the length of the UTF-8
+ * profile name and the name itself, followed by chunks. Each chunk
+ * is a DWORD delay in msec since the previous chunk, a DWORD length
+ * and the data. A chunk of zero length marks the close of the socket.
+ * Numbers are in host (little endian) byte order.
+ */
+static const char record_magic[8] = "OVMREC01";
+
+#define MAX_CHUNK_SIZE (16*1024*1024) /* sanity limit when reading a recording */
+
+struct mgmt_replay {
+    FILE *fp;
+    BOOL fast;
+    BOOL have_chunk;            /* a chunk has been read and is waiting to be fed */
+    DWORD delay;
+    DWORD len;
+    char *data;
+    DWORD chunks;
+    ULONGLONG bytes;
+    LARGE_INTEGER start;
+};
+
+void
+mgmt_record_open(connection_t *c)
+{
+    WCHAR path[MAX_PATH];
+    char name[3*MAX_PATH];
+
+    if (c->manage.record)
+        return;
+
+    _sntprintf_0(path, L"%ls\\%ls-%lld.mgmtrec", o.log_dir, c->config_name, (long long) time(NULL));
+    c->manage.record = _wfopen(path, L"wb");
+    if (!c->manage.record)
+    {
+        MsgToEventLog(EVENTLOG_ERROR_TYPE, L"Failed to open management recording %ls", path);
+        return;
+    }
+
+    WORD len = (WORD) WideCharToMultiByte(CP_UTF8, 0, c->config_name, -1, name, sizeof(name), NULL, NULL);
+    len = len ? len - 1 : 0; /* exclude nul */
+    fwrite(record_magic, sizeof(record_magic), 1, c->manage.record);
+    fwrite(&len, sizeof(len), 1, c->manage.record);
+    fwrite(name, 1, len, c->manage.record);
+
+    c->manage.record_tick = GetTickCount64();
+    memset(&c->manage.record_redact, 0, sizeof(c->manage.record_redact));
+    PrintDebug(L"Recording management session of %ls to %ls", c->config_name, path);
+}
+
+void
+mgmt_record_data(connection_t *c, const char *data, size_t len)
+{
+    ULONGLONG now = GetTickCount64();
+    DWORD hdr[2];
+    char *buf = NULL;
+
+    /* the data is still to be parsed: mask secrets in a copy */
+    if (len && (buf = malloc(len)) == NULL)
+    {
+        MsgToEventLog(EVENTLOG_ERROR_TYPE, L"Out of memory recording management session of %ls -- stopped",
+                      c->config_name);
+        mgmt_record_close(c);
+        return;
+    }
+    if (len)
+    {
+        memcpy(buf, data, len);
+        mgmt_redact(&c->manage.record_redact, buf, len);
+    }
+
+    hdr[0] = (DWORD) min(now - c->manage.record_tick, MAXDWORD);
+    hdr[1] = (DWORD) len;
+    c->manage.record_tick = now;
+
+    if (fwrite(hdr, sizeof(hdr), 1, c->manage.record) != 1
+        || (len && fwrite(buf, 1, len, c->manage.record) != len))
+    {
+        MsgToEventLog(EVENTLOG_ERROR_TYPE, L"Error writing management recording of %ls -- stopped",
+                      c->config_name);
+        mgmt_record_close(c);
+    }
+    free(buf);
+}
+
+void
+mgmt_record_close(connection_t *c)
+{
+    if (c->manage.record)
+        fclose(c->manage.record);
+    c->manage.record = NULL;
+}
+
+/* Read the next chunk. Returns 1 on success, 0 at end of file, -1 on error */
+static int
+read_chunk(struct mgmt_replay *r)
+{
+    DWORD hdr[2];
+
+    if (fread(hdr, sizeof(hdr), 1, r->fp) != 1)
+        return feof(r->fp) ? 0 : -1;
+    if (hdr[1] > MAX_CHUNK_SIZE)
+        return -1;
+
+    char *data = realloc(r->data, max(hdr[1], 1));
+    if (!data)
+        return -1;
+    r->data = data;
+
+    if (hdr[1] && fread(r->data, 1, hdr[1], r->fp) != hdr[1])
+        return -1;
+
+    r->delay = hdr[0];
+    r->len = hdr[1];
+    r->have_chunk = true;
+    return 1;
+}
+
+/* Report the number of chunks processed and, in fast mode, the time taken */
+static void
+replay_report(connection_t *c, BOOL ok)
+{
+    struct mgmt_replay *r = c->manage.replay;
+    WCHAR msg[256];
+    LARGE_INTEGER now, freq;
+
+    QueryPerformanceCounter(&now);
+    QueryPerformanceFrequency(&freq);
+    double msec = (now.QuadPart - r->start.QuadPart)*1000.0/freq.QuadPart;
+
+    if (r->fast)
+        _sntprintf_0(msg, L"Replay %ls: %lu chunks, %llu bytes in %.1f ms",
+                     ok ? L"finished" : L"aborted", r->chunks, r->bytes, msec);
+    else
+        _sntprintf_0(msg, L"Replay %ls: %lu chunks, %llu bytes",
+                     ok ? L"finished" : L"aborted", r->chunks, r->bytes);
+    WriteStatusLog(c, L"GUI> ", msg, false);
+    MsgToEventLog(EVENTLOG_INFORMATION_TYPE, L"%ls: %ls", c->config_name, msg);
+}
+
+static void CALLBACK ReplayTimer(HWND hwnd, UINT msg, UINT_PTR id, DWORD time);
+
+/* Feed chunks to the parser until one is not yet due or the recording ends */
+static void
+replay_step(connection_t *c)
+{
+    struct mgmt_replay *r = c->manage.replay;
+
+    while (r && c->manage.replay == r)
+    {
+        if (!r->have_chunk)
+        {
+            int res = read_chunk(r);
+            if (res <= 0)
+            {
+                replay_report(c, res == 0);
+                CloseManagement(c);
+                return;
+            }
+            if (!r->fast && r->delay)
+            {
+                SetTimer(c->hwndConn, IDT_MGMT_REPLAY, r->delay, ReplayTimer);
+                return;
+            }
+        }
+        r->have_chunk = false;
+        r->chunks++;
+        r->bytes += r->len;
+
+        if (r->len == 0)
+        {
+            /* the daemon closed the connection -- also ends the replay */
+            replay_report(c, true);
+            ManagementClosed(c);
+            return;
+        }
+        /* handlers may end the replay, in which case r is gone */
+        FeedManagementData(c, r->data, r->len);
+    }
+}
+
+static void CALLBACK
+ReplayTimer(HWND hwnd, UNUSED UINT msg, UINT_PTR id, UNUSED DWORD time)
+{
+    KillTimer(hwnd, id);
+
+    connection_t *c = (connection_t *) GetProp(hwnd, cfgProp);
+    if (c && c->manage.replay)
+        replay_step(c);
+}
+
+BOOL
+mgmt_replay_start(const WCHAR *path, BOOL fast)
+{
+    char magic[sizeof(record_magic)];
+    char name[3*MAX_PATH];
+    WCHAR *wname = NULL;
+    WORD len;
+    connection_t *c = NULL;
+
+    FILE *fp = _wfopen(path, L"rb");
+    if (!fp)
+    {
+        MsgToEventLog(EVENTLOG_ERROR_TYPE, L"Failed to open management recording %ls", path);
+        return false;
+    }
+
+    if (fread(magic, sizeof(magic), 1, fp) != 1
+        || memcmp(magic, record_magic, sizeof(magic)) != 0
+        || fread(&len, sizeof(len), 1, fp) != 1
+        || len >= sizeof(name)
+        || fread(name, 1, len, fp) != len)
+    {
+        MsgToEventLog(EVENTLOG_ERROR_TYPE, L"%ls is not a valid management recording", path);
+        goto err;
+    }
+    name[len] = '\0';
+
+    wname = Widen(name);
+    if (wname)
+        c = GetConnByName(wname);
+    if (!c || c->state != disconnected)
+    {
+        MsgToEventLog(EVENTLOG_ERROR_TYPE, L"Replay of %ls: no disconnected profile named %ls",
+                      path, wname ? wname : L"");
+        goto err;
+    }
+
+    struct mgmt_replay *r = calloc(1, sizeof(*r));
+    if (!r)
+        goto err;
+    r->fp = fp;
+    r->fast = fast;
+    c->manage.replay = r;
+
+    if (!StartOpenVPN(c))
+    {
+        mgmt_replay_close(c);
+        free(wname);
+        return false;
+    }
+    free(wname);
+    return true;
+
+err:
+    free(wname);
+    fclose(fp);
+    return false;
+}
+
+BOOL
+mgmt_replay_open(connection_t *c)
+{
+    struct mgmt_replay *r = c->manage.replay;
+
+    if (!r)
+        return false;
+
+    /* same as a successful connect to a daemon */
+    c->manage.connected = 1;
+    QueryPerformanceCounter(&r->start);
+
+    /* start feeding once the worker gets back to its message loop */
+    return SetTimer(c->hwndConn, IDT_MGMT_REPLAY, 0, ReplayTimer) != 0;
+}
+
+void
+mgmt_replay_close(connection_t *c)
+{
+    struct mgmt_replay *r = c->manage.replay;
+
+    if (!r)
+        return;
+
+    if (c->hwndConn)
+        KillTimer(c->hwndConn, IDT_MGMT_REPLAY);
+    c->manage.replay = NULL;
+    c->manage.connected = 0;
+
+    free(c->manage.saved_data);
+    c->manage.saved_data = NULL;
+    c->manage.saved_size = 0;
+
+    fclose(r->fp);
+    free(r->data);
+    free(r);
+}
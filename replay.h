@@ -0,0 +1,56 @@
+/*
+ *  OpenVPN-GUI -- A Windows GUI for OpenVPN.
+ *
+ *  Copyright (C) 2026 OpenVPN GUI contributors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program (see the file COPYING included with this
+ *  distribution); if not, write to the Free Software Foundation, Inc.,
+ *  59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include "options.h"
+
+/*
+ * Recording of the raw data received on the management interface.
+ * A recording starts with a header naming the connection profile,
+ * followed by chunks of data as returned by recv() along with the
+ * time elapsed since the previous chunk.
+ */
+
+/* Start recording the management session of c to a new file in log_dir */
+void mgmt_record_open(connection_t *c);
+
+/* Append data received from the daemon. len = 0 records a close of the socket */
+void mgmt_record_data(connection_t *c, const char *data, size_t len);
+
+void mgmt_record_close(connection_t *c);
+
+/*
+ * Load a recording and start its connection profile with the management
+ * data fed from the file instead of a daemon. If fast is true the
+ * recorded delays are skipped and the time taken to process the whole
+ * session is reported. Returns false on error.
+ */
+BOOL mgmt_replay_start(const WCHAR *path, BOOL fast);
+
+/* Called from the status thread in place of OpenManagement() */
+BOOL mgmt_replay_open(connection_t *c);
+
+void mgmt_replay_close(connection_t *c);
+
+#endif
@@ -0,0 +1,332 @@
+/*
+ *  OpenVPN-GUI -- A Windows GUI for OpenVPN.
+ *
+ *  Copyright (C) 2026 OpenVPN GUI contributors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program (see the file COPYING included with this
+ *  distribution); if not, write to the Free Software Foundation, Inc.,
+ *  59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <windows.h>
+#include <stdlib.h>
+#include <limits.h>
+
+#include "main.h"
+#include "options.h"
+#include "openvpn.h"
+#include "misc.h"
+#include "scheduler.h"
+
+extern options_t o;
+
+#define IDT_SCHEDULER       2       /* timer id on the main window */
+#define SCHEDULE_POLL       500     /* msec between checks for a free slot */
+#define BACKOFF_BASE        2000    /* msec before the first retry */
+#define BACKOFF_MAX         300000  /* upper limit of the retry delay */
+#define MAX_START_ATTEMPTS  6
+
+struct start_entry {
+    WCHAR name[MAX_PATH];   /* config name: the index may change on rescan */
+    int index;              /* index of the connection when queued */
+    start_kind_t kind;
+    int attempts;           /* failed attempts so far */
+    ULONGLONG due;          /* tick count at which it may start */
+    ULONGLONG seq;          /* keeps queue order within a kind */
+};
+
+static struct {
+    struct start_entry *entries;
+    int count;
+    int size;
+    ULONGLONG seq;
+    SRWLOCK lock;           /* held when changing the queue */
+} queue = {.lock = SRWLOCK_INIT};
+
+static void CALLBACK ScheduleTimer(HWND hwnd, UINT msg, UINT_PTR id, DWORD now);
+
+/* Find the connection of a queued entry, NULL if it is gone */
+static connection_t *
+EntryConn(const struct start_entry *e)
+{
+    if (e->index < o.num_configs && wcscmp(o.conn[e->index].config_name, e->name) == 0)
+        return &o.conn[e->index];
+    return GetConnByName(e->name);
+}
+
+/* Delay before retry number n (1, 2, ...) with +/- 25% jitter */
+static DWORD
+Backoff(int n)
+{
+    DWORD delay = BACKOFF_BASE;
+
+    while (--n > 0 && delay < BACKOFF_MAX)
+        delay *= 2;
+    delay = min(delay, BACKOFF_MAX);
+    return delay - delay/4 + (DWORD) (rand() % (delay/2 + 1));
+}
+
+/* Arm the timer for the next time anything may be started */
+static void
+ScheduleArm(ULONGLONG now)
+{
+    ULONGLONG next = ULLONG_MAX;
+
+    for (int i = 0; i < queue.count; i++)
+        next = min(next, queue.entries[i].due);
+
+    if (next == ULLONG_MAX)
+    {
+        KillTimer(o.hWnd, IDT_SCHEDULER);
+        return;
+    }
+    /* when a start is due but all slots are in use, poll for a free one */
+    UINT delay = (next > now) ? (UINT) min(next - now, BACKOFF_MAX) : SCHEDULE_POLL;
+    SetTimer(o.hWnd, IDT_SCHEDULER, delay, ScheduleTimer);
+}
+
+/* Add an entry at the end of the queue and return it, NULL on error */
+static struct start_entry *
+AppendEntry(const WCHAR *name)
+{
+    struct start_entry *e = NULL;
+
+    AcquireSRWLockExclusive(&queue.lock);
+    if (queue.count == queue.size)
+    {
+        int size = queue.size ? 2*queue.size : 16;
+        void *tmp = realloc(queue.entries, size*sizeof(*queue.entries));
+        if (!tmp)
+            goto out;
+        queue.entries = tmp;
+        queue.size = size;
+    }
+    e = &queue.entries[queue.count++];
+    CLEAR(*e);
+    wcsncpy_s(e->name, _countof(e->name), name, _TRUNCATE);
+    e->seq = queue.seq++;
+
+out:
+    ReleaseSRWLockExclusive(&queue.lock);
+    if (!e)
+        MsgToEventLog(EVENTLOG_ERROR_TYPE, L"Out of memory while queuing <%ls> for start", name);
+    return e;
+}
+
+static void
+RemoveEntry(int i)
+{
+    AcquireSRWLockExclusive(&queue.lock);
+    queue.entries[i] = queue.entries[--queue.count];
+    ReleaseSRWLockExclusive(&queue.lock);
+}
+
+/* Return the index of the due entry to start next, or -1 */
+static int
+NextDue(ULONGLONG now)
+{
+    int best = -1;
+
+    for (int i = 0; i < queue.count; i++)
+    {
+        const struct start_entry *e = &queue.entries[i];
+        if (e->due > now)
+            continue;
+        if (best < 0 || e->kind < queue.entries[best].kind
+            || (e->kind == queue.entries[best].kind && e->seq < queue.entries[best].seq))
+        {
+            best = i;
+        }
+    }
+    return best;
+}
+
+/* Number of connections still being brought up */
+static int
+InFlight(void)
+{
+    return CountConnState(connecting) + CountConnState(resuming);
+}
+
+/* True if the connection of a queued start is still in a state to start it */
+static BOOL
+CanStart(const connection_t *c, const struct start_entry *e)
+{
+    /* a resume that failed to connect is retried from the disconnected state */
+    if (e->kind == start_resume && (c->state == suspended || e->attempts == 0))
+        return c->state == suspended;
+    if (c->state != disconnected && c->state != detached)
+        return FALSE;
+    if (e->kind == start_persistent)
+        return !o.session_locked && o.service_state == service_connected;
+    return TRUE;
+}
+
+/* Queue a failed start of c again after a backoff delay, unless given up */
+static void
+ScheduleRetry(connection_t *c, start_kind_t kind)
+{
+    if (++c->start_attempts >= MAX_START_ATTEMPTS)
+    {
+        MsgToEventLog(EVENTLOG_WARNING_TYPE, L"Giving up starting <%ls> after %d attempts",
+                      c->config_name, c->start_attempts);
+        c->start_attempts = 0;
+        return;
+    }
+    DWORD delay = Backoff(c->start_attempts);
+    PrintDebug(L"Start of <%ls> failed: retry %d in %lu msec", c->config_name, c->start_attempts, delay);
+    ScheduleStartAfter(c, kind, delay);
+}
+
+/* Start queued connections while slots are free */
+static void
+ScheduleRun(void)
+{
+    static BOOL running;
+    ULONGLONG now = GetTickCount64();
+    int limit = (int) o.start_concurrency;
+    int busy = InFlight();
+    int i;
+
+    /* prompts shown while starting run a message loop that may call us */
+    if (running)
+        return;
+    running = TRUE;
+
+    while ((limit == 0 || busy < limit) && (i = NextDue(now)) >= 0)
+    {
+        struct start_entry e = queue.entries[i];
+        connection_t *c = EntryConn(&e);
+        RemoveEntry(i);
+
+        /* skip if gone, started by other means or not to be attached now */
+        if (!c || !CanStart(c, &e))
+            continue;
+
+        if (e.kind == start_persistent)
+        {
+            /* disable auto-connect to avoid repeated re-connect
+             * after unrecoverable errors. Re-enabled on successful
+             * connect.
+             */
+            c->auto_connect = false;
+            SetConnState(c, detached); /* this is required to retain management-hold on re-attach */
+        }
+
+        /* auto and resume starts are retried if they fail to connect */
+        c->start_retry = (e.kind == start_auto || e.kind == start_resume);
+        c->start_kind = e.kind;
+        if (StartOpenVPN(c))
+        {
+            busy++;
+            continue;
+        }
+
+        /* failed to launch: retry later unless given up */
+        c->start_retry = FALSE;
+        ScheduleRetry(c, e.kind);
+    }
+
+    running = FALSE;
+    ScheduleArm(now);
+}
+
+static void CALLBACK
+ScheduleTimer(UNUSED HWND hwnd, UNUSED UINT msg, UNUSED UINT_PTR id, UNUSED DWORD now)
+{
+    ScheduleRun();
+}
+
+BOOL
+ScheduleIsQueued(const connection_t *c)
+{
+    for (int i = 0; i < queue.count; i++)
+    {
+        if (wcscmp(queue.entries[i].name, c->config_name) == 0)
+            return TRUE;
+    }
+    return FALSE;
+}
+
+BOOL
+ScheduleStartAfter(connection_t *c, start_kind_t kind, DWORD delay)
+{
+    ULONGLONG now = GetTickCount64();
+
+    if (ScheduleIsQueued(c))
+        return FALSE;
+
+    struct start_entry *e = AppendEntry(c->config_name);
+    if (!e)
+        return FALSE;
+    e->index = (int) (c - o.conn);
+    e->kind = kind;
+    e->attempts = c->start_attempts;
+    e->due = now + delay;
+
+    /* start from the message loop so that callers can queue a batch first */
+    if (delay == 0)
+    {
+        SetTimer(o.hWnd, IDT_SCHEDULER, 0, ScheduleTimer);
+        return TRUE;
+    }
+    /* the timer is armed for earlier entries: re-arm only if this one is due first */
+    for (int i = 0; i < queue.count - 1; i++)
+    {
+        if (queue.entries[i].due <= e->due)
+            return TRUE;
+    }
+    ScheduleArm(now);
+    return TRUE;
+}
+
+BOOL
+ScheduleStart(connection_t *c, start_kind_t kind)
+{
+    return ScheduleStartAfter(c, kind, 0);
+}
+
+void
+ScheduleStartFailed(connection_t *c)
+{
+    ScheduleRetry(c, (start_kind_t) c->start_kind);
+}
+
+void
+ScheduleClear(void)
+{
+    AcquireSRWLockExclusive(&queue.lock);
+    queue.count = 0;
+    ReleaseSRWLockExclusive(&queue.lock);
+    KillTimer(o.hWnd, IDT_SCHEDULER);
+}
+
+void
+ScheduleForEach(void (*func)(const WCHAR *name, start_kind_t kind, int attempts,
+                             LONGLONG due_in, void *arg), void *arg)
+{
+    ULONGLONG now = GetTickCount64();
+
+    AcquireSRWLockShared(&queue.lock);
+    for (int i = 0; i < queue.count; i++)
+    {
+        const struct start_entry *e = &queue.entries[i];
+        func(e->name, e->kind, e->attempts, (LONGLONG) (e->due - now), arg);
+    }
+    ReleaseSRWLockShared(&queue.lock);
+}
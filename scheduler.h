@@ -0,0 +1,69 @@
+/*
+ *  OpenVPN-GUI -- A Windows GUI for OpenVPN.
+ *
+ *  Copyright (C) 2026 OpenVPN GUI contributors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program (see the file COPYING included with this
+ *  distribution); if not, write to the Free Software Foundation, Inc.,
+ *  59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include "options.h"
+
+/* Kinds of queued starts in the order they are served */
+typedef enum {
+    start_resume,       /* restart a suspended connection */
+    start_auto,         /* connection listed for auto-start */
+    start_persistent    /* attach to a persistent connection */
+} start_kind_t;
+
+/*
+ * Queue a connection to be started. Queued connections are started
+ * in order of kind, at most o.start_concurrency at a time counting
+ * all connections still in connecting or resuming state. A start
+ * that fails to launch, or an auto or resume start that fails to
+ * connect, is retried with exponential backoff counting attempts per
+ * connection. Returns false if
+ * the connection is already queued or memory is exhausted.
+ * Call from the main thread only.
+ */
+BOOL ScheduleStart(connection_t *c, start_kind_t kind);
+
+/* Same as ScheduleStart but the start is not due before delay msec */
+BOOL ScheduleStartAfter(connection_t *c, start_kind_t kind, DWORD delay);
+
+/*
+ * Called when a connection started from the queue failed to connect:
+ * queue it again with backoff unless too many attempts have failed.
+ */
+void ScheduleStartFailed(connection_t *c);
+
+/* Drop all queued starts */
+void ScheduleClear(void);
+
+/* True if the connection is waiting in the start queue */
+BOOL ScheduleIsQueued(const connection_t *c);
+
+/*
+ * Call func for each queued start with the name of the config, its kind,
+ * the number of failed attempts and msec until it is due. Safe to call
+ * from any thread: used for diagnostics.
+ */
+void ScheduleForEach(void (*func)(const WCHAR *name, start_kind_t kind, int attempts,
+                                  LONGLONG due_in, void *arg), void *arg);
+
+#endif
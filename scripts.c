@@ -35,6 +35,7 @@
 #include "openvpn-gui-res.h"
 #include "options.h"
 #include "misc.h"
+#include "openvpn.h"
 #include "localization.h"
 #include "env_set.h"
 
@@ -131,7 +132,7 @@ RunConnectScript(connection_t *c, int run_as_service)
         return;
 
     if (!run_as_service)
-        SetDlgItemText(c->hwndStatus, ID_TXT_STATUS, LoadLocalizedString(IDS_NFO_STATE_CONN_SCRIPT));
+        SetStatusText(c, IDS_NFO_STATE_CONN_SCRIPT);
 
     // Create the filename of the logfile
     TCHAR script_log_filename[MAX_PATH];
@@ -160,16 +161,15 @@ RunConnectScript(connection_t *c, int run_as_service)
     si.hStdError = logfile_handle;
 
     /* make an env array with confg specific env appended to the process's env */
-    WCHAR *env = c->es ? merge_env_block(c->es) : NULL;
+    const WCHAR *env = get_env_block(c->es);
     DWORD flags = CREATE_UNICODE_ENVIRONMENT;
 
     if (!CreateProcess(NULL, cmdline, NULL, NULL, TRUE,
                        (o.show_script_window ? flags|CREATE_NEW_CONSOLE : flags|CREATE_NO_WINDOW),
-                       env, c->config_dir, &si, &pi))
+                       (void *) env, c->config_dir, &si, &pi))
     {
         PrintDebug(L"CreateProcess: error = %lu", GetLastError());
         ShowLocalizedMsg(IDS_ERR_RUN_CONN_SCRIPT, cmdline);
-        free(env);
         return;
     }
 
@@ -197,7 +197,6 @@ RunConnectScript(connection_t *c, int run_as_service)
     ShowLocalizedMsg(IDS_ERR_RUN_CONN_SCRIPT_TIMEOUT, o.connectscript_timeout);
 
 out:
-    free(env);
     CloseHandle(pi.hThread);
     CloseHandle(pi.hProcess);
     if (logfile_handle != NULL)
@@ -224,7 +223,7 @@ RunDisconnectScript(connection_t *c, int run_as_service)
         return;
 
     if (!run_as_service)
-        SetDlgItemText(c->hwndStatus, ID_TXT_STATUS, LoadLocalizedString(IDS_NFO_STATE_DISCONN_SCRIPT));
+        SetStatusText(c, IDS_NFO_STATE_DISCONN_SCRIPT);
 
     // Create the filename of the logfile
     TCHAR script_log_filename[MAX_PATH];
@@ -253,14 +252,13 @@ RunDisconnectScript(connection_t *c, int run_as_service)
     si.hStdError = logfile_handle;
 
     /* make an env array with confg specific env appended to the process's env */
-    WCHAR *env = c->es ? merge_env_block(c->es) : NULL;
+    const WCHAR *env = get_env_block(c->es);
     DWORD flags = CREATE_UNICODE_ENVIRONMENT;
 
     if (!CreateProcess(NULL, cmdline, NULL, NULL, TRUE,
                        (o.show_script_window ? flags|CREATE_NEW_CONSOLE : flags|CREATE_NO_WINDOW),
                        NULL, c->config_dir, &si, &pi))
     {
-        free(env);
         return;
     }
 
@@ -275,7 +273,6 @@ RunDisconnectScript(connection_t *c, int run_as_service)
         Sleep(1000);
     }
 out:
-    free(env);
     CloseHandle(pi.hThread);
     CloseHandle(pi.hProcess);
     if (logfile_handle != NULL)
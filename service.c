@@ -164,3 +164,112 @@ void StartAutomaticService(void)
     }
     return;
 }
+
+#define SERVICE_WATCH_RETRY 60000   /* msec between attempts to open the service */
+
+static struct {
+    HANDLE thread;
+    HANDLE stop;
+    HWND hwnd;
+    UINT msg;
+} watch;
+
+static VOID CALLBACK
+ServiceNotifyCallback(UNUSED PVOID arg)
+{
+    /* nothing to do: the APC completes the alertable wait of the watch thread */
+}
+
+/*
+ * Wait for the automatic service to start or stop and post a message
+ * for each such change. Only the transition away from the current state
+ * is requested: the notification fires at once for a state the service
+ * is already in. If the service cannot be opened, e.g. it is not
+ * installed, retry after a delay. A message is also posted each time
+ * the service is opened so that the state is checked right away.
+ */
+static DWORD WINAPI
+ServiceWatchThread(UNUSED void *arg)
+{
+    DWORD wait = 0;
+
+    while (WaitForSingleObject(watch.stop, wait) == WAIT_TIMEOUT)
+    {
+        wait = SERVICE_WATCH_RETRY;
+
+        SC_HANDLE scm = OpenSCManager(NULL, NULL, SC_MANAGER_CONNECT);
+        SC_HANDLE svc = scm ? OpenService(scm, L"OpenVPNService", SERVICE_QUERY_STATUS) : NULL;
+        int running = -1; /* last state reported, -1 if none */
+
+        while (svc)
+        {
+            SERVICE_STATUS_PROCESS status;
+            DWORD needed;
+
+            if (!QueryServiceStatusEx(svc, SC_STATUS_PROCESS_INFO, (BYTE *) &status,
+                                      sizeof(status), &needed))
+                break;
+
+            int now = (status.dwCurrentState == SERVICE_RUNNING);
+            if (now != running)
+                PostMessage(watch.hwnd, watch.msg, 0, 0);
+            running = now;
+
+            SERVICE_NOTIFY notify = {
+                .dwVersion = SERVICE_NOTIFY_STATUS_CHANGE,
+                .pfnNotifyCallback = ServiceNotifyCallback
+            };
+            DWORD mask = (running ? SERVICE_NOTIFY_STOPPED : SERVICE_NOTIFY_RUNNING)
+                         | SERVICE_NOTIFY_DELETE_PENDING;
+
+            if (NotifyServiceStatusChange(svc, mask, &notify) != ERROR_SUCCESS
+                || WaitForSingleObjectEx(watch.stop, INFINITE, TRUE) != WAIT_IO_COMPLETION)
+                break;
+
+            /* the handle is of no more use if the service is going away */
+            if (notify.dwNotificationStatus != ERROR_SUCCESS
+                || (notify.dwNotificationTriggered & SERVICE_NOTIFY_DELETE_PENDING))
+            {
+                PostMessage(watch.hwnd, watch.msg, 0, 0);
+                break;
+            }
+        }
+
+        /* closing the handle cancels any pending notification */
+        if (svc)
+            CloseServiceHandle(svc);
+        if (scm)
+            CloseServiceHandle(scm);
+    }
+    return 0;
+}
+
+void
+ServiceWatchStart(HWND hwnd, UINT msg)
+{
+    watch.hwnd = hwnd;
+    watch.msg = msg;
+    watch.stop = CreateEvent(NULL, TRUE, FALSE, NULL);
+    if (watch.stop)
+        watch.thread = CreateThread(NULL, 0, ServiceWatchThread, NULL, 0, NULL);
+    if (!watch.thread)
+        MsgToEventLog(EVENTLOG_ERROR_TYPE, L"Failed to start watching the automatic service (error = %lu)",
+                      GetLastError());
+}
+
+void
+ServiceWatchStop(void)
+{
+    if (watch.thread)
+    {
+        SetEvent(watch.stop);
+        WaitForSingleObject(watch.thread, 1000);
+        CloseHandle(watch.thread);
+        watch.thread = NULL;
+    }
+    if (watch.stop)
+    {
+        CloseHandle(watch.stop);
+        watch.stop = NULL;
+    }
+}
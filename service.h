@@ -23,3 +23,6 @@ VOID CheckServiceStatus();
 BOOL CheckIServiceStatus(BOOL warn);
 /* Attempt to start OpenVPN Automatc Service */
 void StartAutomaticService(void);
+/* Post msg to hwnd when the automatic service starts or stops */
+void ServiceWatchStart(HWND hwnd, UINT msg);
+void ServiceWatchStop(void);
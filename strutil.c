@@ -0,0 +1,373 @@
+/*
+ *  OpenVPN-GUI -- A Windows GUI for OpenVPN.
+ *
+ *  Copyright (C) 2026 OpenVPN GUI contributors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program (see the file COPYING included with this
+ *  distribution); if not, write to the Free Software Foundation, Inc.,
+ *  59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <windows.h>
+#include <string.h>
+#include <stdlib.h>
+#include <limits.h>
+
+#include "main.h"
+#include "strutil.h"
+
+static const char base64_chars[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+/* Value of each base64 character, or one of the codes below */
+#define B64_SPACE 0x40  /* whitespace: ignored */
+#define B64_PAD   0x41  /* '=' */
+#define B64_BAD   0xff
+static const unsigned char base64_values[256] = {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x40, 0x40, 0xff, 0xff, 0x40, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0x40, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x3e, 0xff, 0xff, 0xff, 0x3f,
+    0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x3b, 0x3c, 0x3d, 0xff, 0xff, 0xff, 0x41, 0xff, 0xff,
+    0xff, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e,
+    0x0f, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28,
+    0x29, 0x2a, 0x2b, 0x2c, 0x2d, 0x2e, 0x2f, 0x30, 0x31, 0x32, 0x33, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+};
+
+/*
+ * Helper function to do base64 conversion without line breaks.
+ * Returns TRUE on success, FALSE on error. Caller must free *output.
+ */
+BOOL
+Base64Encode(const char *input, int input_len, char **output)
+{
+    const unsigned char *in = (const unsigned char *) input;
+
+    if (input_len == 0)
+    {
+        /* set output to empty string  -- matches the behavior in openvpn */
+        *output = calloc (1, sizeof(char));
+        return TRUE;
+    }
+    if (input_len < 0 || input_len > (INT_MAX/4)*3 - 3)
+    {
+        *output = NULL;
+        return FALSE;
+    }
+
+    size_t output_len = ((size_t) input_len + 2)/3*4;
+    char *out = malloc(output_len + 1);
+    *output = out;
+    if (out == NULL)
+        return FALSE;
+
+    int i = 0;
+    for ( ; i + 2 < input_len; i += 3)
+    {
+        DWORD v = (in[i] << 16) | (in[i+1] << 8) | in[i+2];
+        *out++ = base64_chars[(v >> 18) & 0x3f];
+        *out++ = base64_chars[(v >> 12) & 0x3f];
+        *out++ = base64_chars[(v >> 6) & 0x3f];
+        *out++ = base64_chars[v & 0x3f];
+    }
+    if (i < input_len) /* 1 or 2 bytes left */
+    {
+        DWORD v = in[i] << 16;
+        if (i + 1 < input_len)
+            v |= in[i+1] << 8;
+        *out++ = base64_chars[(v >> 18) & 0x3f];
+        *out++ = base64_chars[(v >> 12) & 0x3f];
+        *out++ = (i + 1 < input_len) ? base64_chars[(v >> 6) & 0x3f] : '=';
+        *out++ = '=';
+    }
+    *out = '\0';
+
+    return TRUE;
+}
+/*
+ * Decode a nul-terminated base64 encoded input into a caller supplied
+ * buffer of size bytes that must be at least Base64DecodedSize(input).
+ * The decoded output is nul-terminated. Whitespace in the input is
+ * ignored and trailing padding is optional.
+ *
+ * Return the length of the decoded result (excluding nul) or -1 on
+ * error. The buffer contents are undefined on error.
+ */
+int
+Base64DecodeTo(const char *input, char *output, size_t size)
+{
+    size_t input_len = strlen(input);
+    if (input_len > (size_t) (INT_MAX/3)*4 || size < Base64DecodedSize(input))
+        return -1;
+
+    unsigned char *out = (unsigned char *) output;
+    const unsigned char *in = (const unsigned char *) input;
+    DWORD v = 0;
+    int n = 0;          /* number of sextets in v */
+    int pad = 0;
+    size_t len = 0;
+
+    for ( ; *in; in++)
+    {
+        /*
+         * Fast path for a whole group of four sextets, i.e., anywhere but
+         * at line breaks and padding. A NUL is not a sextet, so the reads
+         * stop at the end of the input.
+         */
+        unsigned int s0, s1, s2, s3;
+        if (n == 0 && !pad
+            && (s0 = base64_values[in[0]]) < 64 && (s1 = base64_values[in[1]]) < 64
+            && (s2 = base64_values[in[2]]) < 64 && (s3 = base64_values[in[3]]) < 64)
+        {
+            DWORD q = (s0 << 18) | (s1 << 12) | (s2 << 6) | s3;
+            out[len++] = (unsigned char) (q >> 16);
+            out[len++] = (unsigned char) (q >> 8);
+            out[len++] = (unsigned char) q;
+            in += 3;
+            continue;
+        }
+
+        unsigned char d = base64_values[*in];
+        if (d == B64_SPACE)
+            continue;
+        if (d == B64_PAD)
+        {
+            pad++;
+            continue;
+        }
+        if (d == B64_BAD || pad) /* invalid char or data after padding */
+            return -1;
+
+        v = (v << 6) | d;
+        if (++n == 4)
+        {
+            out[len++] = (unsigned char) (v >> 16);
+            out[len++] = (unsigned char) (v >> 8);
+            out[len++] = (unsigned char) v;
+            v = 0;
+            n = 0;
+        }
+    }
+
+    /* a group of 2 or 3 sextets gives 1 or 2 bytes, 1 is invalid */
+    if (n == 1 || (pad && n + pad != 4) || pad > 2)
+        return -1;
+    if (n == 2)
+    {
+        out[len++] = (unsigned char) (v >> 4);
+    }
+    else if (n == 3)
+    {
+        out[len++] = (unsigned char) (v >> 10);
+        out[len++] = (unsigned char) (v >> 2);
+    }
+
+    /* NUL terminate output */
+    out[len] = '\0';
+    return (int) len;
+}
+
+/* Buffer size sufficient to hold the decoded input and a nul */
+size_t
+Base64DecodedSize(const char *input)
+{
+    /* output is at most 3 bytes for every 4 input chars */
+    return strlen(input)/4*3 + 3 + 1;
+}
+
+/*
+ * Decode a nul-terminated base64 encoded input and save the result in
+ * an allocated buffer *output. The caller must free *output after use.
+ * The decoded output is nul-terminated so that the caller may treat
+ * it as a string when appropriate.
+ *
+ * Return the length of the decoded result (excluding nul) or -1 on
+ * error.
+ */
+int
+Base64Decode(const char *input, char **output)
+{
+    PrintDebug (L"decoding %hs", input);
+
+    *output = NULL;
+
+    size_t size = Base64DecodedSize(input);
+    char *out = malloc(size);
+    if (out == NULL)
+        return -1;
+
+    int len = Base64DecodeTo(input, out, size);
+    if (len <= 0)
+    {
+        free(out);
+        return -1;
+    }
+
+    *output = out;
+    PrintDebug (L"Decoded output %hs", *output);
+
+    return len;
+}
+
+/* Characters that need a backslash in management command arguments */
+static inline BOOL
+needs_escape(char ch)
+{
+    return (ch == '"' || ch == '\\' || ch == ' ');
+}
+
+/**
+ * Length of a string after escaping with escape_string_buf()
+ * @param input  Pointer to the string to escape
+ * @returns      The escaped length excluding the terminating nul
+ */
+size_t
+escape_string_len(const char *input)
+{
+    size_t len = 0;
+    for (const char *p = input; *p; ++p)
+        len += needs_escape(*p) ? 2 : 1;
+    return len;
+}
+
+/**
+ * Escape backslash, space and double-quote in a string into a caller
+ * supplied buffer.
+ * @param out    Output buffer
+ * @param size   Size of the output buffer in bytes including space for nul
+ * @param input  Pointer to the string to escape
+ * @returns      Length of the result excluding nul, or -1 if the buffer
+ *               is too small. The buffer is not modified in that case.
+ */
+int
+escape_string_buf(char *out, size_t size, const char *input)
+{
+    size_t len = escape_string_len(input);
+    if (len >= size || len > INT_MAX)
+        return -1;
+
+    for (const char *p = input; *p; ++p)
+    {
+        if (needs_escape(*p))
+            *out++ = '\\';
+        *out++ = *p;
+    }
+    *out = '\0';
+
+    return (int) len;
+}
+
+/**
+ * Format a string from a template with a single %s that is replaced by
+ * the escaped input. The escaped copy is built in the tail of the same
+ * allocation and wiped before returning.
+ * @param fmt    printf style template with one %s
+ * @param input  String to escape and substitute
+ * @returns      A newly allocated string or NULL on error. Caller must
+ *               free it after use.
+ */
+char *
+format_escaped(const char *fmt, const char *input)
+{
+    size_t esc_len = escape_string_len(input);
+    size_t cmd_len = strlen(fmt) + esc_len + 1;
+    char *cmd = malloc(cmd_len + esc_len + 1);
+
+    if (!cmd)
+        return NULL;
+
+    char *esc = cmd + cmd_len;
+    escape_string_buf(esc, esc_len + 1, input);
+    snprintf(cmd, cmd_len, fmt, esc);
+    SecureZeroMemory(esc, esc_len);
+
+    return cmd;
+}
+
+struct arena_block {
+    struct arena_block *next;
+    size_t size;
+    size_t used;
+    char data[];
+};
+
+#define ARENA_BLOCK_SIZE 1024
+#define ARENA_ALIGN(n) (((n) + 7) & ~((size_t) 7))
+
+/**
+ * Allocate size bytes from the arena. The memory is zero-initialized
+ * and remains valid until arena_free(). Returns NULL on error.
+ */
+void *
+arena_alloc(arena_t *a, size_t size)
+{
+    struct arena_block *b = a->head;
+
+    size = ARENA_ALIGN(size ? size : 1);
+    if (!b || b->size - b->used < size)
+    {
+        size_t bsize = max(size, ARENA_BLOCK_SIZE);
+        b = calloc(1, sizeof(*b) + bsize);
+        if (!b)
+            return NULL;
+        b->size = bsize;
+        b->next = a->head;
+        a->head = b;
+    }
+
+    void *p = b->data + b->used;
+    b->used += size;
+    return p;
+}
+
+/**
+ * Wipe and release all memory allocated from the arena. The arena
+ * can be reused afterwards.
+ */
+void
+arena_free(arena_t *a)
+{
+    struct arena_block *b = a->head;
+    while (b)
+    {
+        struct arena_block *next = b->next;
+        SecureZeroMemory(b->data, b->used);
+        free(b);
+        b = next;
+    }
+    a->head = NULL;
+}
+
+/* Copy a string into the arena. Return NULL on error. */
+char *
+arena_strdup(arena_t *a, const char *str)
+{
+    size_t len = strlen(str) + 1;
+    char *p = arena_alloc(a, len);
+    if (p)
+        memcpy(p, str, len);
+    return p;
+}
@@ -0,0 +1,56 @@
+/*
+ *  OpenVPN-GUI -- A Windows GUI for OpenVPN.
+ *
+ *  Copyright (C) 2026 OpenVPN GUI contributors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program (see the file COPYING included with this
+ *  distribution); if not, write to the Free Software Foundation, Inc.,
+ *  59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef STRUTIL_H
+#define STRUTIL_H
+
+/*
+ * String helpers that use no Windows API beyond basic types so that
+ * they can be built and tested on any host (see tests/).
+ */
+
+#include <windows.h>
+#include <stddef.h>
+
+BOOL Base64Encode(const char *input, int input_len, char **output);
+int Base64Decode(const char *input, char **output);
+int Base64DecodeTo(const char *input, char *output, size_t size);
+size_t Base64DecodedSize(const char *input);
+
+/* Length of str after escaping, excluding the nul */
+size_t escape_string_len(const char *str);
+
+/* Escape str into out of size bytes. Returns the length or -1 if too small */
+int escape_string_buf(char *out, size_t size, const char *str);
+
+/* Return fmt formatted with its single %s replaced by escaped str */
+char *format_escaped(const char *fmt, const char *str);
+
+/* Bump allocator for temporaries released together */
+typedef struct {
+    struct arena_block *head;
+} arena_t;
+
+void *arena_alloc(arena_t *a, size_t size);
+char *arena_strdup(arena_t *a, const char *str);
+void arena_free(arena_t *a);
+
+#endif
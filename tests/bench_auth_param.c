@@ -0,0 +1,57 @@
+/*
+ *  OpenVPN-GUI -- A Windows GUI for OpenVPN.
+ *
+ *  Copyright (C) 2026 OpenVPN GUI contributors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program (see the file COPYING included with this
+ *  distribution); if not, write to the Free Software Foundation, Inc.,
+ *  59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/* Cost of parsing an authentication request including its allocations */
+
+#include <windows.h>
+#include <stdlib.h>
+
+#include "auth_param.h"
+#include "test.h"
+
+static void
+bench(const char *what, BOOL (*parser)(const char *, auth_param_t *), const char *str, int iterations)
+{
+    volatile int sink = 0;
+
+    double t0 = bench_now();
+    for (int i = 0; i < iterations; i++)
+    {
+        auth_param_t *param = calloc(1, sizeof(*param));
+        if (param && parser(str, param))
+            sink += param->str[0];
+        free_auth_param(param);
+    }
+    double t1 = bench_now();
+
+    printf("%-20s %8.1f ns/op\n", what, (t1 - t0)/iterations);
+}
+
+int
+main(void)
+{
+    bench("parse_dynamic_cr", parse_dynamic_cr,
+          "E,R:7a6f2c1e-9b1d-4d2e-8f3a-5c6b7d8e9f00:dXNlcm5hbWVAZXhhbXBsZS5jb20=:Enter the code from your token",
+          500000);
+    bench("parse_crtext", parse_crtext, "E,R:Enter the code from your token", 500000);
+    bench("parse_input_request", parse_input_request, "Need 'Token PIN' password MSG:Enter the PIN", 500000);
+    return 0;
+}
@@ -0,0 +1,77 @@
+/*
+ *  OpenVPN-GUI -- A Windows GUI for OpenVPN.
+ *
+ *  Copyright (C) 2026 OpenVPN GUI contributors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program (see the file COPYING included with this
+ *  distribution); if not, write to the Free Software Foundation, Inc.,
+ *  59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/* Throughput of the base64 codec on short secrets and larger blobs */
+
+#include <windows.h>
+#include <stdlib.h>
+
+#include "strutil.h"
+#include "test.h"
+
+static void
+bench(const char *what, int size, int iterations)
+{
+    char *in = malloc(size);
+    char *enc = NULL;
+    uint64_t rng = 1;
+
+    for (int i = 0; i < size; i++)
+        in[i] = (char) test_rand(&rng);
+    if (!in || !Base64Encode(in, size, &enc))
+        exit(1);
+
+    size_t dsize = Base64DecodedSize(enc);
+    char *dec = malloc(dsize);
+    volatile int sink = 0;
+
+    double t0 = bench_now();
+    for (int i = 0; i < iterations; i++)
+    {
+        char *out;
+        if (Base64Encode(in, size, &out))
+            sink += out[0];
+        free(out);
+    }
+    double t1 = bench_now();
+    for (int i = 0; i < iterations; i++)
+        sink += Base64DecodeTo(enc, dec, dsize);
+    double t2 = bench_now();
+
+    printf("%-8s %7d bytes: encode %8.1f ns/op %7.1f MB/s, decode %8.1f ns/op %7.1f MB/s\n",
+           what, size, (t1 - t0)/iterations, size*1e3*iterations/(t1 - t0),
+           (t2 - t1)/iterations, size*1e3*iterations/(t2 - t1));
+
+    free(dec);
+    free(enc);
+    free(in);
+}
+
+int
+main(void)
+{
+    bench("username", 16, 1000000);
+    bench("token", 256, 200000);
+    bench("cert", 1200, 100000);     /* DER of an RSA 2048 certificate, as in a pkcs11-id BLOB */
+    bench("cert", 4096, 30000);      /* a large certificate or a short chain */
+    bench("blob", 64*1024, 1000);
+    return 0;
+}
@@ -0,0 +1,63 @@
+/*
+ *  OpenVPN-GUI -- A Windows GUI for OpenVPN.
+ *
+ *  Copyright (C) 2026 OpenVPN GUI contributors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program (see the file COPYING included with this
+ *  distribution); if not, write to the Free Software Foundation, Inc.,
+ *  59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/* Throughput of the echo message fingerprint hash */
+
+#include <windows.h>
+#include <stdlib.h>
+
+#include "echo_hash.h"
+#include "test.h"
+
+static void
+bench(const char *what, size_t size, size_t chunk, int iterations)
+{
+    BYTE *data = calloc(1, size);
+    BYTE d[HASHLEN];
+    volatile BYTE sink = 0;
+
+    if (!data)
+        exit(1);
+
+    double t0 = bench_now();
+    for (int i = 0; i < iterations; i++)
+    {
+        struct echo_msg_hash_state hs = {0};
+        for (size_t pos = 0; pos < size; pos += chunk)
+            echo_msg_hash_update(&hs, data + pos, min(chunk, size - pos));
+        echo_msg_hash_final(&hs, d);
+        sink ^= d[0];
+    }
+    double t = bench_now() - t0;
+
+    printf("%-24s %7zu bytes: %9.1f ns/msg %8.1f MB/s\n",
+           what, size, t/iterations, size*1e3*iterations/t);
+    free(data);
+}
+
+int
+main(void)
+{
+    bench("short notice", 64, 64, 2000000);
+    bench("notice by 80 char lines", 4096, 160, 100000);
+    bench("long notice", 64*1024, 64*1024, 5000);
+    return 0;
+}
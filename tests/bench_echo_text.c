@@ -0,0 +1,154 @@
+/*
+ *  OpenVPN-GUI -- A Windows GUI for OpenVPN.
+ *
+ *  Copyright (C) 2026 OpenVPN GUI contributors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program (see the file COPYING included with this
+ *  distribution); if not, write to the Free Software Foundation, Inc.,
+ *  59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Accumulation of echo message text over many lines: the text is
+ * appended and folded into the fingerprint a line at a time, as
+ * echo_msg_append() does. For comparison the previous way is also
+ * timed: each line widened into its own allocation, the text
+ * reallocated to the exact size and hashed once at the end.
+ */
+
+#include <windows.h>
+#include <stdlib.h>
+
+#include "echo_text.h"
+#include "test.h"
+
+#define LINES 10000
+
+static char *lines[LINES];
+
+/* Lines of 40 to 120 chars, some with non-ASCII text */
+static void
+make_lines(void)
+{
+    static const char *words[] = {"Your", "session", "expires", "in", "Zürich", "at",
+                                  "12:00", "€", "please", "reconnect", "—", "maintenance"};
+    uint64_t rng = 1;
+
+    for (int i = 0; i < LINES; i++)
+    {
+        char buf[256] = "";
+        size_t target = 40 + test_rand(&rng) % 81;
+        while (strlen(buf) < target)
+        {
+            strcat(buf, words[test_rand(&rng) % _countof(words)]);
+            strcat(buf, " ");
+        }
+        lines[i] = strdup(buf);
+        if (!lines[i])
+            exit(1);
+    }
+}
+
+static int
+accumulate(struct echo_msg *m, int *grows)
+{
+    int size = m->txtsize;
+
+    for (int i = 0; i < LINES; i++)
+    {
+        int n = echo_msg_append_text(m, lines[i], TRUE);
+        if (n < 0)
+            return 0;
+        echo_msg_hash_update(&m->hash, (BYTE *) (m->text + m->txtlen - n), n*sizeof(WCHAR));
+        if (m->txtsize != size)
+            (*grows)++;
+        size = m->txtsize;
+    }
+    echo_msg_hash_final(&m->hash, m->fp.digest);
+    return 1;
+}
+
+static int
+accumulate_previous(struct echo_msg *m, int *grows)
+{
+    for (int i = 0; i < LINES; i++)
+    {
+        int wlen = MultiByteToWideChar(CP_UTF8, 0, lines[i], -1, NULL, 0);
+        WCHAR *wmsg = malloc(wlen*sizeof(WCHAR));
+        if (!wmsg)
+            return 0;
+        MultiByteToWideChar(CP_UTF8, 0, lines[i], -1, wmsg, wlen);
+
+        size_t len = m->txtlen + wlen - 1 + 2 + 1;
+        WCHAR *s = realloc(m->text, len*sizeof(WCHAR));
+        if (!s)
+            return 0;
+        swprintf(s + m->txtlen, len - m->txtlen, L"%ls%ls", wmsg, L"\r\n");
+        m->text = s;
+        m->txtlen = (int) len - 1;
+        (*grows)++;
+        free(wmsg);
+    }
+    echo_msg_hash_update(&m->hash, (BYTE *) m->text, m->txtlen*sizeof(WCHAR));
+    echo_msg_hash_final(&m->hash, m->fp.digest);
+    return 1;
+}
+
+static void
+bench(const char *what, int (*fn)(struct echo_msg *, int *), int iterations)
+{
+    int grows = 0;
+    int chars = 0;
+
+    double t0 = bench_now();
+    for (int i = 0; i < iterations; i++)
+    {
+        struct echo_msg m = {0};
+        grows = 0;
+        if (!fn(&m, &grows))
+            exit(1);
+        chars = m.txtlen;
+        free(m.text);
+    }
+    double t = (bench_now() - t0)/iterations;
+
+    printf("%-9s %d lines, %d chars: %8.2f ms, %6.2f M lines/s, %6d reallocs\n",
+           what, LINES, chars, t/1e6, LINES*1e3/t, grows);
+}
+
+int
+main(void)
+{
+    make_lines();
+
+    /* both must produce the same text and digest */
+    struct echo_msg a = {0}, b = {0};
+    int grows = 0;
+    if (!accumulate(&a, &grows) || !accumulate_previous(&b, &grows)
+        || a.txtlen != b.txtlen || wmemcmp(a.text, b.text, a.txtlen) != 0
+        || memcmp(a.fp.digest, b.fp.digest, HASHLEN) != 0)
+    {
+        fprintf(stderr, "accumulated text or digest differs\n");
+        return 1;
+    }
+    free(a.text);
+    free(b.text);
+
+    bench("append", accumulate, 50);
+    bench("previous", accumulate_previous, 50);
+
+    for (int i = 0; i < LINES; i++)
+        free(lines[i]);
+    return 0;
+}
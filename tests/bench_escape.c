@@ -0,0 +1,89 @@
+/*
+ *  OpenVPN-GUI -- A Windows GUI for OpenVPN.
+ *
+ *  Copyright (C) 2026 OpenVPN GUI contributors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program (see the file COPYING included with this
+ *  distribution); if not, write to the Free Software Foundation, Inc.,
+ *  59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/* Cost of escaping user input into management commands */
+
+#include <windows.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "strutil.h"
+#include "test.h"
+
+/* Random printable input with about one character in eight to escape */
+static char *
+make_input(int size)
+{
+    static const char special[] = "\\\" ";
+    char *in = malloc(size + 1);
+    uint64_t rng = 1;
+
+    if (!in)
+        exit(1);
+    for (int i = 0; i < size; i++)
+    {
+        uint64_t r = test_rand(&rng);
+        in[i] = (r % 8 == 0) ? special[(r >> 8) % 3] : (char) ('a' + (r >> 8) % 26);
+    }
+    in[size] = '\0';
+    return in;
+}
+
+static void
+bench(const char *what, int size, int iterations)
+{
+    char *in = make_input(size);
+    size_t len = escape_string_len(in);
+    char *out = malloc(len + 1);
+    volatile int sink = 0;
+
+    if (!out)
+        exit(1);
+
+    double t0 = bench_now();
+    for (int i = 0; i < iterations; i++)
+        sink += escape_string_buf(out, len + 1, in);
+    double t1 = bench_now();
+    for (int i = 0; i < iterations; i++)
+    {
+        char *cmd = format_escaped("password \"Auth\" \"%s\"", in);
+        if (cmd)
+            sink += cmd[0];
+        free(cmd);
+    }
+    double t2 = bench_now();
+
+    printf("%-8s %6d bytes: escape %8.1f ns/op %7.1f MB/s, format_escaped %8.1f ns/op\n",
+           what, size, (t1 - t0)/iterations, size*1e3*iterations/(t1 - t0),
+           (t2 - t1)/iterations);
+
+    free(out);
+    free(in);
+}
+
+int
+main(void)
+{
+    bench("username", 16, 1000000);
+    bench("password", 64, 1000000);
+    bench("token", 1024, 100000);
+    return 0;
+}
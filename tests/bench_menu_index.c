@@ -0,0 +1,146 @@
+/*
+ *  OpenVPN-GUI -- A Windows GUI for OpenVPN.
+ *
+ *  Copyright (C) 2026 OpenVPN GUI contributors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program (see the file COPYING included with this
+ *  distribution); if not, write to the Free Software Foundation, Inc.,
+ *  59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Cost of the menu tree logic when the tray menu opens, at 1k and 10k
+ * profiles in 20 folders of 10 subfolders each. Opening a group menu
+ * looks up its entries and the connected configs below it. This is
+ * compared to scanning all groups and configs for each menu, as was
+ * done before the index. The Win32 menu calls are not included.
+ */
+
+#include <windows.h>
+#include <stdlib.h>
+
+#include "menu_index.h"
+#include "test.h"
+
+#define TOP 20
+#define SUB 10
+#define GROUPS (1 + TOP + TOP*SUB)
+
+static volatile int sink;
+
+static void
+build(menu_index_t *mi, int configs)
+{
+    uint64_t rng = 1;
+
+    if (!menu_index_reset(mi, GROUPS, configs))
+        exit(1);
+    for (int g = 1; g <= TOP; g++)
+        menu_index_set_group(mi, g, 0, TRUE);
+    for (int g = TOP + 1; g < GROUPS; g++)
+        menu_index_set_group(mi, g, 1 + (g - TOP - 1)/SUB, TRUE);
+    for (int i = 0; i < configs; i++)
+        menu_index_set_config(mi, i, (int) (test_rand(&rng) % GROUPS));
+    menu_index_build(mi);
+}
+
+/* Open the menu of group g: list its entries and mark connected configs below it */
+static void
+open_indexed(const menu_index_t *mi, int g, const BOOL *connected)
+{
+    int count;
+    const int *entry = menu_index_entries(mi, g, &count);
+
+    for (int k = 0; k < count; k++)
+        sink += entry[k];
+    for (int i = 0; i < mi->num_configs; i++)
+    {
+        if (connected[i] && menu_index_in_group(mi, i, g))
+            sink++;
+    }
+}
+
+/* The same by scanning all groups and configs */
+static void
+open_scan(const menu_index_t *mi, int g, const BOOL *connected)
+{
+    for (int i = 1; i < mi->num_groups; i++)
+    {
+        if (mi->listed[i] && mi->parent[i] == g)
+            sink += i;
+    }
+    for (int i = 0; i < mi->num_configs; i++)
+    {
+        if (mi->config_group[i] == g)
+            sink += i;
+    }
+    for (int i = 0; i < mi->num_configs; i++)
+    {
+        if (!connected[i])
+            continue;
+        for (int cg = mi->config_group[i]; cg >= 0; cg = mi->parent[cg])
+        {
+            if (cg == g)
+            {
+                sink++;
+                break;
+            }
+        }
+    }
+}
+
+static void
+bench(int configs, int iterations)
+{
+    menu_index_t mi = {0};
+    BOOL *connected = calloc(configs, sizeof(*connected));
+
+    if (!connected)
+        exit(1);
+    connected[0] = connected[configs/2] = TRUE;
+
+    double t0 = bench_now();
+    for (int i = 0; i < iterations; i++)
+        build(&mi, configs);
+    double t1 = bench_now();
+
+    /* the root, a folder and a subfolder: the path to a profile */
+    const int path[] = {0, 1, TOP + 1};
+    for (int i = 0; i < iterations; i++)
+    {
+        for (int k = 0; k < 3; k++)
+            open_indexed(&mi, path[k], connected);
+    }
+    double t2 = bench_now();
+    for (int i = 0; i < iterations; i++)
+    {
+        for (int k = 0; k < 3; k++)
+            open_scan(&mi, path[k], connected);
+    }
+    double t3 = bench_now();
+
+    printf("%5d profiles: build %7.1f us, open 3 menus %7.1f us (scan %7.1f us)\n",
+           configs, (t1 - t0)/iterations/1e3, (t2 - t1)/iterations/1e3, (t3 - t2)/iterations/1e3);
+
+    menu_index_free(&mi);
+    free(connected);
+}
+
+int
+main(void)
+{
+    bench(1000, 2000);
+    bench(10000, 200);
+    return 0;
+}
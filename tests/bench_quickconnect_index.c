@@ -0,0 +1,102 @@
+/*
+ *  OpenVPN-GUI -- A Windows GUI for OpenVPN.
+ *
+ *  Copyright (C) 2026 OpenVPN GUI contributors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program (see the file COPYING included with this
+ *  distribution); if not, write to the Free Software Foundation, Inc.,
+ *  59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/* Query latency of the quick connect index with many configs */
+
+#include <windows.h>
+#include <stdlib.h>
+
+#include "quickconnect_index.h"
+#include "test.h"
+
+#define NUM_CONFIGS 10000
+#define REPS        50
+
+static const WCHAR *words[] = {
+    L"vpn", L"office", L"home", L"lab", L"prod", L"staging", L"eu", L"us", L"asia",
+    L"frankfurt", L"london", L"paris", L"tokyo", L"udp", L"tcp", L"backup", L"gw",
+};
+
+static int
+compare_double(const void *a, const void *b)
+{
+    double x = *(const double *) a;
+    double y = *(const double *) b;
+    return (x > y) - (x < y);
+}
+
+int
+main(void)
+{
+    static const WCHAR *queries[] = {L"frankfurt-udp", L"lab gw 042", L"zz", L"o"};
+    qc_index_t idx = {0};
+    struct qc_result results[100];
+    uint64_t rng = 99;
+    WCHAR path[64];
+    WCHAR name[64];
+
+    double t0 = bench_now();
+    if (!qc_index_reset(&idx, NUM_CONFIGS))
+        return 1;
+    for (int i = 0; i < NUM_CONFIGS; i++)
+    {
+        swprintf(path, _countof(path), L"%ls/%ls/", words[test_rand(&rng) % _countof(words)],
+                 words[test_rand(&rng) % _countof(words)]);
+        swprintf(name, _countof(name), L"%ls-%ls-%04d", words[test_rand(&rng) % _countof(words)],
+                 words[test_rand(&rng) % _countof(words)], i);
+        if (!qc_index_add(&idx, path, name))
+            return 1;
+    }
+    printf("build %d configs: %.3f ms\n", NUM_CONFIGS, (bench_now() - t0)/1e6);
+
+    for (size_t k = 0; k < _countof(queries); k++)
+    {
+        const WCHAR *q = queries[k];
+        WCHAR typed[64];
+        double samples[REPS*64];
+        double first = 0, total = 0;
+        int n = 0, len = (int) wcslen(q), count = 0;
+
+        for (int rep = 0; rep < REPS; rep++)
+        {
+            /* type the query one char at a time as in the dialog */
+            idx.have_matches = FALSE;
+            for (int i = 1; i <= len; i++)
+            {
+                wmemcpy(typed, q, i);
+                typed[i] = L'\0';
+                double t = bench_now();
+                n = qc_index_query(&idx, typed, results, _countof(results));
+                t = bench_now() - t;
+                if (i == 1)
+                    first += t;
+                total += t;
+                samples[count++] = t;
+            }
+        }
+        qsort(samples, count, sizeof(samples[0]), compare_double);
+        printf("%-16ls %5d results: first key %7.1f us, mean per key %7.1f us, p99 %7.1f us\n",
+               q, n, first/REPS/1e3, total/count/1e3, samples[count*99/100]/1e3);
+    }
+
+    qc_index_free(&idx);
+    return 0;
+}
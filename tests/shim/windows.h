@@ -0,0 +1,155 @@
+/*
+ *  OpenVPN-GUI -- A Windows GUI for OpenVPN.
+ *
+ *  Copyright (C) 2026 OpenVPN GUI contributors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program (see the file COPYING included with this
+ *  distribution); if not, write to the Free Software Foundation, Inc.,
+ *  59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Minimal stand-in for <windows.h> providing the types and helpers
+ * used by the portable sources so that they build with a host compiler.
+ */
+
+#ifndef TESTS_SHIM_WINDOWS_H
+#define TESTS_SHIM_WINDOWS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <wchar.h>
+#include <wctype.h>
+
+typedef int BOOL;
+typedef unsigned char BYTE;
+typedef unsigned int UINT;
+typedef uint16_t WORD;
+typedef uint32_t DWORD;
+typedef int64_t LONGLONG;
+typedef uint64_t ULONGLONG;
+typedef uint64_t UINT64;
+typedef void *HANDLE;
+typedef wchar_t WCHAR;
+typedef char *LPSTR;
+typedef const char *LPCSTR;
+typedef WCHAR *LPWSTR;
+typedef const WCHAR *LPCWSTR;
+typedef WCHAR TCHAR;
+typedef TCHAR *LPTSTR;
+typedef const TCHAR *LPCTSTR;
+
+#define TRUE  1
+#define FALSE 0
+#define VOID  void
+
+typedef struct {
+    DWORD nLength;
+    void *lpSecurityDescriptor;
+    BOOL bInheritHandle;
+} SECURITY_ATTRIBUTES;
+
+typedef struct {
+    void *opaque[5];
+} SECURITY_DESCRIPTOR;
+
+#define MAKELONG(a, b) ((DWORD) (((WORD) (a)) | ((DWORD) ((WORD) (b))) << 16))
+
+#ifndef _countof
+#define _countof(a) (sizeof(a)/sizeof((a)[0]))
+#endif
+#ifndef max
+#define max(a, b) (((a) > (b)) ? (a) : (b))
+#endif
+#ifndef min
+#define min(a, b) (((a) < (b)) ? (a) : (b))
+#endif
+
+#define _vsnprintf vsnprintf
+
+/* Lower-case in place: enough for the test data, unlike the real thing */
+static inline DWORD
+CharLowerBuffW(WCHAR *str, DWORD len)
+{
+    for (DWORD i = 0; i < len; i++)
+        str[i] = (WCHAR) towlower(str[i]);
+    return len;
+}
+
+#define CP_UTF8 65001
+
+/*
+ * UTF-8 to UTF-16 units, with invalid sequences replaced by U+FFFD as
+ * the real thing does without MB_ERR_INVALID_CHARS. Only CP_UTF8 and
+ * len = -1 (nul terminated input) are supported.
+ */
+static inline int
+MultiByteToWideChar(UINT cp, DWORD flags, LPCSTR str, int len, LPWSTR out, int size)
+{
+    const unsigned char *s = (const unsigned char *) str;
+    int n = 0;
+
+    (void) flags;
+    if (cp != CP_UTF8 || len != -1)
+        return 0;
+
+    for (;;)
+    {
+        uint32_t ch = *s++;
+        int follow = ch < 0x80 ? 0 : ch < 0xc2 ? -1 : ch < 0xe0 ? 1 : ch < 0xf0 ? 2 : ch < 0xf5 ? 3 : -1;
+
+        if (follow > 0)
+            ch &= 0x3f >> follow;
+        for (int i = 0; i < follow; i++)
+        {
+            /* an invalid byte, including the nul, starts the next character */
+            if ((*s & 0xc0) != 0x80)
+            {
+                follow = -1;
+                break;
+            }
+            ch = (ch << 6) | (*s++ & 0x3f);
+        }
+        if (follow < 0)
+            ch = 0xfffd;
+
+        int units = ch > 0xffff ? 2 : 1;
+        if (out && n + units > size)
+            return 0;
+        if (out && units == 2)
+        {
+            out[n] = (WCHAR) (0xd800 + ((ch - 0x10000) >> 10));
+            out[n + 1] = (WCHAR) (0xdc00 + (ch & 0x3ff));
+        }
+        else if (out)
+        {
+            out[n] = (WCHAR) ch;
+        }
+        n += units;
+        if (ch == 0)
+            return n;
+    }
+}
+
+static inline void
+SecureZeroMemory(void *p, size_t size)
+{
+    volatile unsigned char *v = p;
+    while (size--)
+        *v++ = 0;
+}
+
+#endif
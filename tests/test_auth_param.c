@@ -0,0 +1,172 @@
+/*
+ *  OpenVPN-GUI -- A Windows GUI for OpenVPN.
+ *
+ *  Copyright (C) 2026 OpenVPN GUI contributors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program (see the file COPYING included with this
+ *  distribution); if not, write to the Free Software Foundation, Inc.,
+ *  59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/* Parsers of dynamic challenge, crtext and password/string requests */
+
+#include <windows.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "auth_param.h"
+#include "test.h"
+
+typedef BOOL (*parser_t)(const char *, auth_param_t *);
+
+static auth_param_t *
+parse(parser_t parser, const char *str, BOOL expect)
+{
+    auth_param_t *param = calloc(1, sizeof(*param));
+    BOOL ok = param && parser(str, param);
+
+    if (ok != expect)
+    {
+        fprintf(stderr, "parsing \"%s\": got %d expected %d\n", str ? str : "(null)", ok, expect);
+        test_failures++;
+    }
+    if (!ok)
+    {
+        free_auth_param(param);
+        return NULL;
+    }
+    return param;
+}
+
+#define STREQ(a, b) ((a) && strcmp((a), (b)) == 0)
+
+static void
+test_dynamic_cr(void)
+{
+    auth_param_t *p;
+
+    p = parse(parse_dynamic_cr, "E,R:id123:dXNlcg==:Enter PIN", TRUE);
+    CHECK(p && p->flags == (FLAG_CR_TYPE_CRV1|FLAG_CR_ECHO|FLAG_CR_RESPONSE));
+    CHECK(p && STREQ(p->id, "id123") && STREQ(p->user, "user") && STREQ(p->str, "Enter PIN"));
+    free_auth_param(p);
+
+    /* the challenge text is the whole remainder, colons included */
+    p = parse(parse_dynamic_cr, "R:id:dXNlcg==:a:b::c", TRUE);
+    CHECK(p && p->flags == (FLAG_CR_TYPE_CRV1|FLAG_CR_RESPONSE));
+    CHECK(p && STREQ(p->str, "a:b::c"));
+    free_auth_param(p);
+
+    /* unknown flag letters are ignored */
+    p = parse(parse_dynamic_cr, "X:id:dXNlcg==:text", TRUE);
+    CHECK(p && p->flags == FLAG_CR_TYPE_CRV1);
+    free_auth_param(p);
+
+    /* empty flags, as in "CRV1::id:user:text": neither echo nor response */
+    p = parse(parse_dynamic_cr, ":id:dXNlcg==:text", TRUE);
+    CHECK(p && p->flags == FLAG_CR_TYPE_CRV1);
+    CHECK(p && STREQ(p->id, "id") && STREQ(p->user, "user") && STREQ(p->str, "text"));
+    free_auth_param(p);
+
+    /* missing or empty fields and a bad username */
+    parse(parse_dynamic_cr, "::dXNlcg==:text", FALSE);
+    parse(parse_dynamic_cr, ":id::text", FALSE);
+    parse(parse_dynamic_cr, "E::dXNlcg==:text", FALSE);
+    parse(parse_dynamic_cr, "E:id::text", FALSE);
+    parse(parse_dynamic_cr, "E:id:dXNlcg==:", FALSE);
+    parse(parse_dynamic_cr, "E:id:dXNlcg==", FALSE);
+    parse(parse_dynamic_cr, "E:id:!!!!:text", FALSE);
+    parse(parse_dynamic_cr, "", FALSE);
+    parse(parse_dynamic_cr, NULL, FALSE);
+}
+
+static void
+test_crtext(void)
+{
+    auth_param_t *p;
+
+    p = parse(parse_crtext, "E,R:Enter the code: 123", TRUE);
+    CHECK(p && p->flags == (FLAG_CR_TYPE_CRTEXT|FLAG_CR_ECHO|FLAG_CR_RESPONSE));
+    CHECK(p && STREQ(p->str, "Enter the code: 123"));
+    free_auth_param(p);
+
+    p = parse(parse_crtext, ":text", TRUE);
+    CHECK(p && p->flags == FLAG_CR_TYPE_CRTEXT && STREQ(p->str, "text"));
+    free_auth_param(p);
+
+    parse(parse_crtext, "no separator", FALSE);
+    parse(parse_crtext, NULL, FALSE);
+}
+
+static void
+test_input_request(void)
+{
+    auth_param_t *p;
+
+    p = parse(parse_input_request, "Need 'Private Key' password", TRUE);
+    CHECK(p && p->flags == FLAG_PASS_PKEY);
+    CHECK(p && STREQ(p->id, "Private Key") && STREQ(p->str, "Private Key"));
+    free_auth_param(p);
+
+    p = parse(parse_input_request, "Need 'Token PIN' password MSG:Enter the PIN", TRUE);
+    CHECK(p && p->flags == FLAG_PASS_TOKEN);
+    CHECK(p && STREQ(p->id, "Token PIN") && STREQ(p->str, "Enter the PIN"));
+    free_auth_param(p);
+
+    p = parse(parse_input_request, "Need 'pkcs11-id-request' string MSG:", TRUE);
+    CHECK(p && p->flags == FLAG_STRING_PKCS11 && STREQ(p->str, "pkcs11-id-request"));
+    free_auth_param(p);
+
+    p = parse(parse_input_request, "Need 'other' string", TRUE);
+    CHECK(p && p->flags == 0 && STREQ(p->id, "other"));
+    free_auth_param(p);
+
+    parse(parse_input_request, "Want 'Private Key' password", FALSE);
+    parse(parse_input_request, "Need 'Private Key'", FALSE);
+    parse(parse_input_request, "Need", FALSE);
+    parse(parse_input_request, "", FALSE);
+}
+
+/* Random input must never be read or written out of bounds */
+static void
+fuzz(uint64_t seed, int rounds)
+{
+    static const char chars[] = "ER,: 'Ndeapsword=MSG:Zm9v";
+    static const parser_t parsers[] = {parse_dynamic_cr, parse_crtext, parse_input_request};
+    uint64_t rng = seed;
+
+    for (int r = 0; r < rounds; r++)
+    {
+        char str[48];
+        int len = (int) (test_rand(&rng) % sizeof(str));
+        for (int i = 0; i < len; i++)
+            str[i] = chars[test_rand(&rng) % (sizeof(chars) - 1)];
+        str[len] = '\0';
+
+        auth_param_t *param = calloc(1, sizeof(*param));
+        if (param && parsers[r % _countof(parsers)](str, param))
+            CHECK(param->str && strlen(param->str) < sizeof(str));
+        free_auth_param(param);
+    }
+}
+
+int
+main(void)
+{
+    test_dynamic_cr();
+    test_crtext();
+    test_input_request();
+    fuzz(777, 100000);
+
+    return TEST_RESULT();
+}
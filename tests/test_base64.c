@@ -0,0 +1,213 @@
+/*
+ *  OpenVPN-GUI -- A Windows GUI for OpenVPN.
+ *
+ *  Copyright (C) 2026 OpenVPN GUI contributors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program (see the file COPYING included with this
+ *  distribution); if not, write to the Free Software Foundation, Inc.,
+ *  59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Base64 codec: known vectors, error cases and a differential fuzz test
+ * against a straightforward reference decoder.
+ */
+
+#include <windows.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "strutil.h"
+#include "test.h"
+
+static const char alphabet[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static void
+check_encode(const char *in, const char *expect)
+{
+    char *out = NULL;
+    CHECK(Base64Encode(in, (int) strlen(in), &out));
+    CHECK(out && strcmp(out, expect) == 0);
+    free(out);
+}
+
+static void
+check_decode(const char *in, const char *expect)
+{
+    char *out = NULL;
+    int len = Base64Decode(in, &out);
+    if (expect)
+    {
+        CHECK(len == (int) strlen(expect));
+        CHECK(out && strcmp(out, expect) == 0);
+    }
+    else
+    {
+        CHECK(len == -1);
+        CHECK(out == NULL);
+    }
+    free(out);
+}
+
+static void
+test_vectors(void)
+{
+    /* RFC 4648 section 10 */
+    static const char *vectors[][2] = {
+        {"", ""}, {"f", "Zg=="}, {"fo", "Zm8="}, {"foo", "Zm9v"},
+        {"foob", "Zm9vYg=="}, {"fooba", "Zm9vYmE="}, {"foobar", "Zm9vYmFy"},
+    };
+    for (size_t i = 0; i < _countof(vectors); i++)
+    {
+        check_encode(vectors[i][0], vectors[i][1]);
+        if (*vectors[i][0])
+            check_decode(vectors[i][1], vectors[i][0]);
+    }
+
+    /* whitespace is skipped and trailing padding is optional */
+    check_decode("Zm9v\r\nYmFy", "foobar");
+    check_decode(" Zm9v\tYg ", "foob");
+    check_decode("Zm9vYg", "foob");
+    check_decode("Zm9vYmE", "fooba");
+
+    /* malformed input */
+    check_decode("", NULL);
+    check_decode("Z", NULL);
+    check_decode("Zm9vY", NULL);
+    check_decode("Zm9v!", NULL);
+    check_decode("Zg==Zg==", NULL);
+    check_decode("Zg===", NULL);
+    check_decode("Z===", NULL);
+    check_decode("Zm9v\x80", NULL);
+
+    /* all byte values survive a round trip */
+    char bytes[256];
+    for (int i = 0; i < 256; i++)
+        bytes[i] = (char) i;
+    char *enc = NULL;
+    char dec[sizeof(bytes) + 8];
+    CHECK(Base64Encode(bytes, sizeof(bytes), &enc));
+    CHECK(enc && Base64DecodeTo(enc, dec, sizeof(dec)) == (int) sizeof(bytes));
+    CHECK(memcmp(bytes, dec, sizeof(bytes)) == 0);
+
+    /* too small an output buffer is refused */
+    CHECK(Base64DecodeTo(enc, dec, Base64DecodedSize(enc) - 1) == -1);
+    free(enc);
+
+    CHECK(!Base64Encode("x", -1, &enc));
+    CHECK(enc == NULL);
+}
+
+/* Reference decoder written for clarity, not speed */
+static int
+ref_decode(const char *in, unsigned char *out)
+{
+    unsigned char sextets[4096];
+    int n = 0;
+    int pad = 0;
+    int len = 0;
+
+    for ( ; *in; in++)
+    {
+        const char *p;
+        if (strchr(" \t\r\n", *in))
+            continue;
+        if (*in == '=')
+        {
+            pad++;
+            continue;
+        }
+        if (pad || !(p = strchr(alphabet, *in)))
+            return -1;
+        sextets[n++] = (unsigned char) (p - alphabet);
+    }
+    if (n % 4 == 1 || (pad && (n % 4 == 0 || n % 4 + pad != 4)))
+        return -1;
+
+    for (int i = 0; i < n; i += 4)
+    {
+        int left = min(n - i, 4);
+        unsigned long v = 0;
+        for (int k = 0; k < 4; k++)
+            v = (v << 6) | (k < left ? sextets[i + k] : 0);
+        for (int k = 0; k < left - 1; k++)
+            out[len++] = (unsigned char) (v >> (16 - 8*k));
+    }
+    return len;
+}
+
+static void
+fuzz(uint64_t seed, int rounds)
+{
+    uint64_t rng = seed;
+    static const char extra[] = "= \t\n!-_.\x80\xff";
+
+    for (int r = 0; r < rounds; r++)
+    {
+        /* round trip random bytes */
+        int len = (int) (test_rand(&rng) % 200);
+        unsigned char bytes[200];
+        for (int i = 0; i < len; i++)
+            bytes[i] = (unsigned char) test_rand(&rng);
+
+        char *enc = NULL;
+        CHECK(Base64Encode((char *) bytes, len, &enc));
+        if (!enc)
+            continue;
+        CHECK(strlen(enc) == (size_t) (len + 2)/3*4);
+
+        /* decode into a buffer of exactly the advertised size */
+        size_t size = Base64DecodedSize(enc);
+        char *dec = malloc(size);
+        CHECK(dec && Base64DecodeTo(enc, dec, size) == (len ? len : 0));
+        CHECK(dec && memcmp(dec, bytes, len) == 0);
+        free(dec);
+        free(enc);
+
+        /* random text mostly from the alphabet must match the reference */
+        char text[64];
+        int tlen = (int) (test_rand(&rng) % (sizeof(text) - 1));
+        for (int i = 0; i < tlen; i++)
+        {
+            uint64_t x = test_rand(&rng);
+            text[i] = (x % 16) ? alphabet[(x >> 8) % 64] : extra[(x >> 8) % (sizeof(extra) - 1)];
+        }
+        text[tlen] = '\0';
+
+        unsigned char expect[64];
+        int elen = ref_decode(text, expect);
+        size = Base64DecodedSize(text);
+        dec = malloc(size);
+        int dlen = dec ? Base64DecodeTo(text, dec, size) : -2;
+        if (dlen != elen || (elen > 0 && memcmp(dec, expect, elen) != 0))
+        {
+            fprintf(stderr, "mismatch on \"%s\": got %d expected %d\n", text, dlen, elen);
+            test_failures++;
+        }
+        free(dec);
+    }
+}
+
+int
+main(int argc, char **argv)
+{
+    uint64_t seed = (argc > 1) ? strtoull(argv[1], NULL, 0) : 0x9E3779B97F4A7C15ull;
+    int rounds = (argc > 2) ? atoi(argv[2]) : 100000;
+
+    test_vectors();
+    fuzz(seed, rounds);
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,135 @@
+/*
+ *  OpenVPN-GUI -- A Windows GUI for OpenVPN.
+ *
+ *  Copyright (C) 2026 OpenVPN GUI contributors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program (see the file COPYING included with this
+ *  distribution); if not, write to the Free Software Foundation, Inc.,
+ *  59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Echo message fingerprint hash: digests are persisted in the registry,
+ * so they must not depend on how the text was split into updates and
+ * must not change between releases.
+ */
+
+#include <windows.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "echo_hash.h"
+#include "test.h"
+
+static void
+digest(const void *data, size_t size, BYTE out[HASHLEN])
+{
+    struct echo_msg_hash_state hs = {0};
+    echo_msg_hash_update(&hs, data, size);
+    echo_msg_hash_final(&hs, out);
+}
+
+static void
+to_hex(const BYTE d[HASHLEN], char hex[2*HASHLEN + 1])
+{
+    for (int i = 0; i < HASHLEN; i++)
+        sprintf(hex + 2*i, "%02x", d[i]);
+}
+
+/* Changing these would invalidate the echo message history of users */
+static void
+test_known_digests(void)
+{
+    static const char *vectors[][2] = {
+        {"", "4480e95911f922776ec4236d2bbcd32f"},
+        {"a", "13a7f3d5f497525e6feeb0dd0f802b57"},
+        {"The quick brown fox jumps over the lazy dog", "1167fbf306fa6d79622a379590d16c3c"},
+    };
+    BYTE d[HASHLEN];
+    char hex[2*HASHLEN + 1];
+
+    for (size_t i = 0; i < _countof(vectors); i++)
+    {
+        digest(vectors[i][0], strlen(vectors[i][0]), d);
+        to_hex(d, hex);
+        if (strcmp(hex, vectors[i][1]) != 0)
+        {
+            fprintf(stderr, "digest of \"%s\" is %s expected %s\n", vectors[i][0], hex, vectors[i][1]);
+            test_failures++;
+        }
+    }
+}
+
+static void
+test_distinct(void)
+{
+    static const BYTE zeros[64];
+    BYTE d[65][HASHLEN];
+
+    /* runs of zero bytes differ only in their length */
+    for (int n = 0; n <= 64; n++)
+    {
+        digest(zeros, n, d[n]);
+        for (int m = 0; m < n; m++)
+            CHECK(memcmp(d[m], d[n], HASHLEN) != 0);
+    }
+
+    /* final resets the state for the next message */
+    struct echo_msg_hash_state hs = {0};
+    echo_msg_hash_update(&hs, (const BYTE *) "abc", 3);
+    echo_msg_hash_final(&hs, d[0]);
+    CHECK(hs.len == 0);
+    echo_msg_hash_update(&hs, (const BYTE *) "abc", 3);
+    echo_msg_hash_final(&hs, d[1]);
+    CHECK(memcmp(d[0], d[1], HASHLEN) == 0);
+}
+
+/* Any split of the data into updates gives the same digest */
+static void
+fuzz(uint64_t seed, int rounds)
+{
+    uint64_t rng = seed;
+    BYTE data[300];
+
+    for (int r = 0; r < rounds; r++)
+    {
+        size_t len = test_rand(&rng) % sizeof(data);
+        for (size_t i = 0; i < len; i++)
+            data[i] = (BYTE) test_rand(&rng);
+
+        BYTE whole[HASHLEN], parts[HASHLEN];
+        digest(data, len, whole);
+
+        struct echo_msg_hash_state hs = {0};
+        for (size_t pos = 0; pos < len; )
+        {
+            size_t n = (size_t) (test_rand(&rng) % 20);
+            n = min(n, len - pos);
+            echo_msg_hash_update(&hs, data + pos, n);
+            pos += n;
+        }
+        echo_msg_hash_final(&hs, parts);
+        CHECK(memcmp(whole, parts, HASHLEN) == 0);
+    }
+}
+
+int
+main(void)
+{
+    test_known_digests();
+    test_distinct();
+    fuzz(2024, 20000);
+
+    return TEST_RESULT();
+}
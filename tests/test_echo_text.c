@@ -0,0 +1,64 @@
+/*
+ *  OpenVPN-GUI -- A Windows GUI for OpenVPN.
+ *
+ *  Copyright (C) 2026 OpenVPN GUI contributors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program (see the file COPYING included with this
+ *  distribution); if not, write to the Free Software Foundation, Inc.,
+ *  59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/* Accumulation of echo message text a line at a time */
+
+#include <windows.h>
+#include <stdlib.h>
+
+#include "echo_text.h"
+#include "test.h"
+
+int
+main(void)
+{
+    struct echo_msg m = {0};
+
+    CHECK(echo_msg_append_text(&m, "Hello", TRUE) == 7);
+    CHECK(echo_msg_append_text(&m, "", FALSE) == 0);
+    CHECK(echo_msg_append_text(&m, "Zürich €", FALSE) == 8);
+    CHECK(m.txtlen == 15 && m.text && wcscmp(m.text, L"Hello\r\nZürich €") == 0);
+
+    /* many lines: the buffer grows geometrically and keeps its content */
+    int grows = 0;
+    int size = m.txtsize;
+    for (int i = 0; i < 10000; i++)
+    {
+        CHECK(echo_msg_append_text(&m, "0123456789", TRUE) == 12);
+        if (m.txtsize != size)
+            grows++;
+        size = m.txtsize;
+    }
+    CHECK(m.txtlen == 15 + 10000*12);
+    CHECK(m.txtlen < m.txtsize);
+    CHECK(grows <= 10);
+    CHECK(m.text && wcsncmp(m.text + m.txtlen - 12, L"0123456789\r\n", 12) == 0);
+    CHECK(m.text && m.text[m.txtlen] == L'\0');
+    free(m.text);
+
+    /* room is reserved in advance and never more than INT_MAX chars */
+    struct echo_msg r = {0};
+    CHECK(echo_msg_reserve(&r, 1000) && r.txtsize >= 1000);
+    CHECK(!echo_msg_reserve(&r, (size_t) 1 << 40));
+    free(r.text);
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,135 @@
+/*
+ *  OpenVPN-GUI -- A Windows GUI for OpenVPN.
+ *
+ *  Copyright (C) 2026 OpenVPN GUI contributors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program (see the file COPYING included with this
+ *  distribution); if not, write to the Free Software Foundation, Inc.,
+ *  59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/* Escaping of management command arguments */
+
+#include <windows.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "strutil.h"
+#include "test.h"
+
+static void
+check_escape(const char *in, const char *expect)
+{
+    char out[64];
+
+    CHECK(escape_string_len(in) == strlen(expect));
+    CHECK(escape_string_buf(out, sizeof(out), in) == (int) strlen(expect));
+    CHECK(strcmp(out, expect) == 0);
+}
+
+static void
+test_escape(void)
+{
+    check_escape("", "");
+    check_escape("plain", "plain");
+    check_escape("a b", "a\\ b");
+    check_escape("\"quoted\"", "\\\"quoted\\\"");
+    check_escape("C:\\dir\\", "C:\\\\dir\\\\");
+    check_escape("\\\" ", "\\\\\\\"\\ ");
+
+    /* newlines pass through: callers reject them with validate_input() */
+    check_escape("line1\nline2\r\n", "line1\nline2\r\n");
+}
+
+static void
+test_truncation(void)
+{
+    char out[16];
+    const char *in = "a \"b\"";     /* escapes to 8 chars */
+
+    /* too small by one: fails and leaves the buffer alone */
+    memset(out, '#', sizeof(out));
+    CHECK(escape_string_buf(out, 8, in) == -1);
+    CHECK(out[0] == '#' && out[7] == '#');
+
+    CHECK(escape_string_buf(out, 9, in) == 8);
+    CHECK(strcmp(out, "a\\ \\\"b\\\"") == 0);
+
+    CHECK(escape_string_buf(out, 0, "") == -1);
+    CHECK(escape_string_buf(out, 1, "") == 0 && out[0] == '\0');
+    CHECK(escape_string_buf(out, 1, "\\") == -1);
+    CHECK(escape_string_buf(out, 2, "\\") == -1);
+    CHECK(escape_string_buf(out, 3, "\\") == 2);
+}
+
+static void
+test_format(void)
+{
+    char *cmd = format_escaped("username \"Auth\" \"%s\"", "us\"er \\x");
+    CHECK(cmd && strcmp(cmd, "username \"Auth\" \"us\\\"er\\ \\\\x\"") == 0);
+    free(cmd);
+
+    cmd = format_escaped("password \"%s\"", "");
+    CHECK(cmd && strcmp(cmd, "password \"\"") == 0);
+    free(cmd);
+
+    cmd = format_escaped("%s", "two\nlines");
+    CHECK(cmd && strcmp(cmd, "two\nlines") == 0);
+    free(cmd);
+}
+
+/* Escaping random strings is reversible and sized as predicted */
+static void
+fuzz(uint64_t seed, int rounds)
+{
+    static const char chars[] = "ab \"\\\n\x01\xff";
+    uint64_t rng = seed;
+
+    for (int r = 0; r < rounds; r++)
+    {
+        char in[32];
+        char out[2*sizeof(in)];
+        char back[sizeof(in)];
+        int len = (int) (test_rand(&rng) % sizeof(in));
+
+        for (int i = 0; i < len; i++)
+            in[i] = chars[test_rand(&rng) % (sizeof(chars) - 1)];
+        in[len] = '\0';
+
+        int n = escape_string_buf(out, sizeof(out), in);
+        CHECK(n == (int) escape_string_len(in) && n == (int) strlen(out));
+
+        /* unescape */
+        int k = 0;
+        for (const char *p = out; *p; p++)
+        {
+            if (*p == '\\')
+                p++;
+            back[k++] = *p;
+        }
+        back[k] = '\0';
+        CHECK(strcmp(back, in) == 0);
+    }
+}
+
+int
+main(void)
+{
+    test_escape();
+    test_truncation();
+    test_format();
+    fuzz(12345, 100000);
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,105 @@
+/*
+ *  OpenVPN-GUI -- A Windows GUI for OpenVPN.
+ *
+ *  Copyright (C) 2026 OpenVPN GUI contributors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program (see the file COPYING included with this
+ *  distribution); if not, write to the Free Software Foundation, Inc.,
+ *  59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/* Positions and entries of the tray menu tree */
+
+#include <windows.h>
+#include <stdlib.h>
+
+#include "menu_index.h"
+#include "test.h"
+
+/*
+ * root (0)
+ *   work (1)
+ *     eu (3)
+ *   home (2)
+ *   empty (4) -- not listed
+ */
+static void
+build(menu_index_t *mi)
+{
+    static const int parent[] = {-1, 0, 0, 1, 0};
+    static const BOOL listed[] = {FALSE, TRUE, TRUE, TRUE, FALSE};
+    static const int config_group[] = {0, 3, 1, 2, 3, 0};
+
+    CHECK(menu_index_reset(mi, 5, 6));
+    for (int g = 0; g < 5; g++)
+        menu_index_set_group(mi, g, parent[g], listed[g]);
+    for (int i = 0; i < 6; i++)
+        menu_index_set_config(mi, i, config_group[i]);
+    menu_index_build(mi);
+}
+
+static void
+check_entries(const menu_index_t *mi, int g, const int *expect, int n)
+{
+    int count;
+    const int *entry = menu_index_entries(mi, g, &count);
+
+    CHECK(count == n);
+    CHECK(mi->children[g] == n);
+    for (int k = 0; k < n && k < count; k++)
+        CHECK(entry[k] == expect[k]);
+}
+
+int
+main(void)
+{
+    menu_index_t mi = {0};
+
+    build(&mi);
+
+    /* groups first, then configs, each in index order */
+    check_entries(&mi, 0, (int[]) {MENU_INDEX_GROUP(1), MENU_INDEX_GROUP(2), 0, 5}, 4);
+    check_entries(&mi, 1, (int[]) {MENU_INDEX_GROUP(3), 2}, 2);
+    check_entries(&mi, 2, (int[]) {3}, 1);
+    check_entries(&mi, 3, (int[]) {1, 4}, 2);
+    check_entries(&mi, 4, NULL, 0);
+
+    CHECK(mi.group_pos[1] == 0 && mi.group_pos[2] == 1 && mi.group_pos[3] == 0);
+    CHECK(mi.config_pos[0] == 2 && mi.config_pos[5] == 3);
+    CHECK(mi.config_pos[1] == 0 && mi.config_pos[4] == 1);
+    CHECK(mi.config_pos[2] == 1 && mi.config_pos[3] == 0);
+
+    /* membership at any depth */
+    CHECK(menu_index_in_group(&mi, 1, 3));
+    CHECK(menu_index_in_group(&mi, 1, 1));
+    CHECK(menu_index_in_group(&mi, 1, 0));
+    CHECK(!menu_index_in_group(&mi, 1, 2));
+    CHECK(!menu_index_in_group(&mi, 0, 1));
+    CHECK(menu_index_in_group(&mi, 0, 0));
+
+    /* a rebuild starts over */
+    build(&mi);
+    check_entries(&mi, 0, (int[]) {MENU_INDEX_GROUP(1), MENU_INDEX_GROUP(2), 0, 5}, 4);
+
+    /* no configs: the root lists the groups only */
+    CHECK(menu_index_reset(&mi, 2, 0));
+    menu_index_set_group(&mi, 1, 0, TRUE);
+    menu_index_build(&mi);
+    check_entries(&mi, 0, (int[]) {MENU_INDEX_GROUP(1)}, 1);
+
+    menu_index_free(&mi);
+    CHECK(mi.num_groups == 0 && !mi.entry);
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,132 @@
+/*
+ *  OpenVPN-GUI -- A Windows GUI for OpenVPN.
+ *
+ *  Copyright (C) 2026 OpenVPN GUI contributors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program (see the file COPYING included with this
+ *  distribution); if not, write to the Free Software Foundation, Inc.,
+ *  59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Masking of secrets in management recordings: the result must not
+ * depend on how the data was split into chunks, and a replay must see
+ * the lines it acts on, such as the management password prompt,
+ * unchanged.
+ */
+
+#include <windows.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "auth_param.h"
+#include "mgmt_redact.h"
+#include "test.h"
+
+/* A recorded session: the daemon sends the password prompt without a newline */
+static const char session[] =
+    "ENTER PASSWORD:SUCCESS: password is correct\r\n"
+    ">INFO:OpenVPN Management Interface Version 5 -- type 'help' for more info\r\n"
+    ">STATE:1700000000,AUTH,,,,,,\r\n"
+    ">PASSWORD:Verification Failed: 'Auth' ['CRV1:R,E:Om01u7Fh4LrGBS7u:dXNlcg==:Enter PIN']\r\n"
+    ">LOG:1700000001,I,>PASSWORD:Auth-Token:not-at-line-start\r\n"
+    ">PASSWORD:Auth-Token:c2VjcmV0LXRva2Vu\r\n"
+    ">INFOMSG:WEB_AUTH::https://vpn.example.com/auth?session=s3cr3t\r\n"
+    ">PASSWORD:Auth-Token:\r\n"
+    ">PASSWORD:Auth-Token:split-at-end";
+
+static void
+redact_chunks(char *buf, size_t len, size_t chunk)
+{
+    mgmt_redact_t r = {0};
+    for (size_t pos = 0; pos < len; pos += chunk)
+        mgmt_redact(&r, buf + pos, min(chunk, len - pos));
+}
+
+static void
+test_whole(char *out, size_t len)
+{
+    memcpy(out, session, len);
+    redact_chunks(out, len, len);
+
+    /* lines acted on by a replay are kept */
+    CHECK(memcmp(out, session, strlen("ENTER PASSWORD:SUCCESS: password is correct\r\n"
+                                      ">INFO:")) == 0);
+    CHECK(strstr(out, ">STATE:1700000000,AUTH,,,,,,\r\n"));
+    CHECK(strstr(out, ">LOG:1700000001,I,>PASSWORD:Auth-Token:not-at-line-start\r\n"));
+
+    /* secrets are masked */
+    CHECK(!strstr(out, "Om01u7Fh4LrGBS7u"));
+    CHECK(!strstr(out, "dXNlcg=="));
+    CHECK(!strstr(out, "c2VjcmV0"));
+    CHECK(!strstr(out, "s3cr3t"));
+    CHECK(!strstr(out, "split-at-end"));
+    CHECK(strstr(out, ">PASSWORD:Auth-Token:AAAAAAAAAAAAAAAA\r\n>"));
+    CHECK(strstr(out, ">PASSWORD:Auth-Token:\r\n>"));
+    CHECK(strstr(out, ">INFOMSG:WEB_AUTH::AAAAA:AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA\r\n"));
+}
+
+/* The masked challenge still parses, so a replay takes the same path */
+static void
+test_challenge(const char *out)
+{
+    const char *crv1 = strstr(out, "CRV1:");
+    CHECK(crv1);
+    if (!crv1)
+        return;
+
+    char str[128];
+    size_t n = strstr(crv1, "']") - crv1 - 5;
+    memcpy(str, crv1 + 5, n);
+    str[n] = '\0';
+    CHECK(strcmp(str, "A,A:AAAAAAAAAAAAAAAA:AAAAAAAA:AAAAAAAAA") == 0);
+
+    auth_param_t *param = calloc(1, sizeof(*param));
+    CHECK(param && parse_dynamic_cr(str, param));
+    CHECK(param && param->id && strcmp(param->id, "AAAAAAAAAAAAAAAA") == 0);
+    free_auth_param(param);
+}
+
+int
+main(void)
+{
+    const size_t len = sizeof(session) - 1;
+    char *expect = calloc(1, len + 1);
+    char *out = calloc(1, len + 1);
+    if (!expect || !out)
+        return 1;
+
+    test_whole(expect, len);
+    test_challenge(expect);
+
+    /* the same result for any split into chunks */
+    for (size_t chunk = 1; chunk < len; chunk++)
+    {
+        memcpy(out, session, len);
+        redact_chunks(out, len, chunk);
+        CHECK(memcmp(out, expect, len) == 0);
+    }
+    for (size_t split = 1; split < len; split++)
+    {
+        mgmt_redact_t r = {0};
+        memcpy(out, session, len);
+        mgmt_redact(&r, out, split);
+        mgmt_redact(&r, out + split, len - split);
+        CHECK(memcmp(out, expect, len) == 0);
+    }
+
+    free(expect);
+    free(out);
+    return TEST_RESULT();
+}
@@ -0,0 +1,150 @@
+/*
+ *  OpenVPN-GUI -- A Windows GUI for OpenVPN.
+ *
+ *  Copyright (C) 2026 OpenVPN GUI contributors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program (see the file COPYING included with this
+ *  distribution); if not, write to the Free Software Foundation, Inc.,
+ *  59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/* Search index of the quick connect dialog */
+
+#include <windows.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "quickconnect_index.h"
+#include "test.h"
+
+static const WCHAR *paths[] = {L"", L"work/", L"home/", L"work/eu/"};
+static const WCHAR *names[] = {L"office", L"office-vpn", L"Router", L"Frankfurt"};
+
+static int
+query(qc_index_t *idx, const WCHAR *q, int *index, int max)
+{
+    struct qc_result results[16];
+    int n = qc_index_query(idx, q, results, min(max, (int) _countof(results)));
+    for (int k = 0; k < n; k++)
+        index[k] = results[k].index;
+    return n;
+}
+
+static void
+test_query(void)
+{
+    qc_index_t idx = {0};
+    int r[16];
+
+    CHECK(qc_index_reset(&idx, _countof(names)));
+    for (size_t i = 0; i < _countof(names); i++)
+        CHECK(qc_index_add(&idx, paths[i], names[i]));
+    CHECK(!qc_index_add(&idx, L"", L"one too many"));
+
+    /* an empty query lists everything, a too small result buffer the best */
+    CHECK(query(&idx, L"", r, 16) == 4 && r[0] == 0 && r[3] == 3);
+    CHECK(query(&idx, L"", r, 2) == 2 && r[0] == 0 && r[1] == 1);
+
+    /* shorter text ranks first on equal matches, matches in the name
+     * rank above those spanning the group path */
+    CHECK(query(&idx, L"off", r, 16) == 3 && r[0] == 0 && r[1] == 1 && r[2] == 3);
+
+    /* case and white space are ignored, the group path is searched */
+    CHECK(query(&idx, L"FRA", r, 16) == 1 && r[0] == 3);
+    CHECK(query(&idx, L"w e f", r, 16) == 1 && r[0] == 3);
+    CHECK(query(&idx, L"home", r, 16) == 1 && r[0] == 2);
+    CHECK(query(&idx, L"zzz", r, 16) == 0);
+
+    /* extending a query narrows the previous matches */
+    CHECK(query(&idx, L"o", r, 16) == 4);
+    CHECK(query(&idx, L"ov", r, 16) == 1 && r[0] == 1);
+    CHECK(query(&idx, L"o", r, 16) == 4);
+
+    /* recent use ranks higher */
+    idx.entries[1].recent = 32;
+    CHECK(query(&idx, L"off", r, 16) == 3 && r[0] == 1 && r[1] == 0);
+
+    qc_index_free(&idx);
+}
+
+/* true if all of q appears in text in order */
+static BOOL
+is_subsequence(const WCHAR *q, const WCHAR *text)
+{
+    for ( ; *q && *text; text++)
+    {
+        if (*q == *text)
+            q++;
+    }
+    return *q == L'\0';
+}
+
+/* Compare the matches with a brute force scan while queries are typed */
+static void
+fuzz(uint64_t seed, int rounds)
+{
+    static const WCHAR chars[] = L"abcde-/";
+    enum { N = 200 };
+    uint64_t rng = seed;
+    WCHAR text[N][16];
+    qc_index_t idx = {0};
+    static struct qc_result results[N];
+
+    CHECK(qc_index_reset(&idx, N));
+    for (int i = 0; i < N; i++)
+    {
+        int len = 1 + (int) (test_rand(&rng) % 12);
+        for (int k = 0; k < len; k++)
+            text[i][k] = chars[test_rand(&rng) % (_countof(chars) - 1)];
+        text[i][len] = L'\0';
+        CHECK(qc_index_add(&idx, L"", text[i]));
+    }
+
+    for (int r = 0; r < rounds; r++)
+    {
+        WCHAR q[8] = L"";
+        int qlen = 1 + (int) (test_rand(&rng) % 6);
+
+        for (int k = 0; k < qlen; k++)
+        {
+            q[k] = chars[test_rand(&rng) % (_countof(chars) - 2)];
+            q[k + 1] = L'\0';
+
+            int n = qc_index_query(&idx, q, results, N);
+            int expect = 0;
+            for (int i = 0; i < N; i++)
+                expect += is_subsequence(q, text[i]);
+            CHECK(n == expect);
+
+            for (int j = 0; j < n; j++)
+            {
+                CHECK(is_subsequence(q, text[results[j].index]));
+                if (j > 0)
+                    CHECK(results[j-1].score > results[j].score
+                          || (results[j-1].score == results[j].score
+                              && results[j-1].index < results[j].index));
+            }
+        }
+    }
+    qc_index_free(&idx);
+}
+
+int
+main(void)
+{
+    test_query();
+    fuzz(4242, 2000);
+
+    return TEST_RESULT();
+}
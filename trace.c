@@ -0,0 +1,181 @@
+/*
+ *  OpenVPN-GUI -- A Windows GUI for OpenVPN.
+ *
+ *  Copyright (C) 2026 OpenVPN GUI contributors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program (see the file COPYING included with this
+ *  distribution); if not, write to the Free Software Foundation, Inc.,
+ *  59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <windows.h>
+#include <stdio.h>
+
+#include "main.h"
+#include "misc.h"
+#include "trace.h"
+
+#define TRACE_RING_SIZE 8192    /* events kept per thread */
+#define TRACE_MAX_RINGS 64      /* threads traced; later ones are ignored */
+
+struct trace_rec {
+    const char *name;
+    LONGLONG ts;                /* performance counter */
+    char phase;                 /* 'B' or 'E' */
+};
+
+struct trace_ring {
+    DWORD tid;
+    volatile LONG head;         /* total # of events written, only the owner thread updates this */
+    struct trace_rec rec[TRACE_RING_SIZE];
+};
+
+volatile LONG trace_enabled;
+
+static DWORD tls_index = TLS_OUT_OF_INDEXES;
+static struct trace_ring *volatile rings[TRACE_MAX_RINGS];
+static volatile LONG num_rings;
+static struct trace_ring no_ring;   /* marks threads that did not get a ring */
+static LONGLONG trace_t0;
+
+/* Get the ring of the calling thread, allocating it on first use */
+static struct trace_ring *
+get_ring(void)
+{
+    struct trace_ring *r = TlsGetValue(tls_index);
+    if (r)
+        return r;
+
+    LONG n = InterlockedIncrement(&num_rings) - 1;
+    r = (n < TRACE_MAX_RINGS) ? calloc(1, sizeof(*r)) : NULL;
+    if (r)
+    {
+        r->tid = GetCurrentThreadId();
+        rings[n] = r;
+    }
+    else
+    {
+        r = &no_ring;
+    }
+    TlsSetValue(tls_index, r);
+    return r;
+}
+
+void
+trace_event(const char *name, char phase)
+{
+    LARGE_INTEGER now;
+    struct trace_ring *r = get_ring();
+
+    if (r == &no_ring)
+        return;
+
+    QueryPerformanceCounter(&now);
+
+    struct trace_rec *rec = &r->rec[r->head % TRACE_RING_SIZE];
+    rec->name = name;
+    rec->ts = now.QuadPart;
+    rec->phase = phase;
+    r->head++;
+}
+
+void
+trace_start(void)
+{
+    LARGE_INTEGER now;
+
+    if (tls_index == TLS_OUT_OF_INDEXES)
+    {
+        tls_index = TlsAlloc();
+        if (tls_index == TLS_OUT_OF_INDEXES)
+        {
+            MsgToEventLog(EVENTLOG_ERROR_TYPE, L"Tracing not available: TlsAlloc failed (error = 0x%08x)",
+                          GetLastError());
+            return;
+        }
+    }
+
+    /* discard events of an earlier session */
+    for (int i = 0; i < min(num_rings, TRACE_MAX_RINGS); i++)
+    {
+        if (rings[i])
+            rings[i]->head = 0;
+    }
+
+    QueryPerformanceCounter(&now);
+    trace_t0 = now.QuadPart;
+    InterlockedExchange(&trace_enabled, 1);
+    PrintDebug(L"Tracing started");
+}
+
+void
+trace_stop(void)
+{
+    InterlockedExchange(&trace_enabled, 0);
+}
+
+BOOL
+trace_dump(const WCHAR *path)
+{
+    LARGE_INTEGER freq;
+    const char *sep = "";
+
+    if (tls_index == TLS_OUT_OF_INDEXES)
+        return false;
+
+    FILE *fp = _wfopen(path, L"w");
+    if (!fp)
+    {
+        MsgToEventLog(EVENTLOG_ERROR_TYPE, L"Failed to open trace file %ls", path);
+        return false;
+    }
+
+    /* pause recording so that rings are not overwritten while we read them */
+    LONG enabled = InterlockedExchange(&trace_enabled, 0);
+
+    QueryPerformanceFrequency(&freq);
+    DWORD pid = GetCurrentProcessId();
+
+    fprintf(fp, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    for (int i = 0; i < min(num_rings, TRACE_MAX_RINGS); i++)
+    {
+        struct trace_ring *r = rings[i];
+        if (!r)
+            continue;
+
+        LONG head = r->head;
+        LONG first = max(0, head - TRACE_RING_SIZE);
+        for (LONG j = first; j < head; j++)
+        {
+            const struct trace_rec *rec = &r->rec[j % TRACE_RING_SIZE];
+            if (rec->ts < trace_t0)
+                continue;
+            fprintf(fp, "%s\n{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":%lu,\"tid\":%lu}",
+                    sep, rec->name, rec->phase, (rec->ts - trace_t0)*1e6/freq.QuadPart, pid, r->tid);
+            sep = ",";
+        }
+    }
+    fprintf(fp, "\n]}\n");
+
+    InterlockedExchange(&trace_enabled, enabled);
+
+    BOOL ret = !ferror(fp);
+    fclose(fp);
+    PrintDebug(L"Trace written to %ls", path);
+    return ret;
+}
@@ -0,0 +1,47 @@
+/*
+ *  OpenVPN-GUI -- A Windows GUI for OpenVPN.
+ *
+ *  Copyright (C) 2026 OpenVPN GUI contributors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program (see the file COPYING included with this
+ *  distribution); if not, write to the Free Software Foundation, Inc.,
+ *  59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <windows.h>
+
+extern volatile LONG trace_enabled;
+
+/* Record an event in the ring buffer of the calling thread.
+ * name must be a string literal or otherwise outlive the trace.
+ */
+void trace_event(const char *name, char phase);
+
+/* Mark the begin and end of a span. Only a flag test when tracing is off */
+#define TRACE_BEGIN(name) do { if (trace_enabled) trace_event(name, 'B'); } while(0)
+#define TRACE_END(name)   do { if (trace_enabled) trace_event(name, 'E'); } while(0)
+
+void trace_start(void);
+void trace_stop(void);
+
+/*
+ * Write all recorded events to path in Chrome trace event format
+ * (load in chrome://tracing or ui.perfetto.dev). Returns false on error.
+ */
+BOOL trace_dump(const WCHAR *path);
+
+#endif
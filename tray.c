@@ -37,6 +37,9 @@
 #include "openvpn-gui-res.h"
 #include "localization.h"
 #include "misc.h"
+#include "trace.h"
+#include "quickconnect.h"
+#include "menu_index.h"
 #include "assert.h"
 
 /* Popup Menus */
@@ -45,8 +48,20 @@ HMENU *hMenuConn;
 HMENU hMenuImport;
 int hmenu_size = 0; /* allocated size of hMenuConn array */
 
+/* Menu positions and the entries of each group menu */
+static menu_index_t menu_index;
+
 HBITMAP hbmpConnecting;
 
+/* What hbmpConnecting was made for: it is reused while these stay the same */
+static struct {
+    LANGID lang;
+    UINT dpi_scale;
+    int cx;
+    int cy;
+    COLORREF bg;
+} hbmp_key;
+
 NOTIFYICONDATA ni;
 extern options_t o;
 
@@ -73,11 +88,16 @@ DeleteMenuBitmaps(void)
 static void
 CreateMenuBitmaps(void)
 {
+    int cx = GetSystemMetrics(SM_CXMENUCHECK);
+    int cy = GetSystemMetrics(SM_CYMENUCHECK);
+    COLORREF bg = GetSysColor(COLOR_MENU);
+
+    if (hbmpConnecting && hbmp_key.lang == GetGUILanguage() && hbmp_key.dpi_scale == o.dpi_scale
+        && hbmp_key.cx == cx && hbmp_key.cy == cy && hbmp_key.bg == bg)
+        return;
 
     DeleteMenuBitmaps();
 
-    int cx = GetSystemMetrics(SM_CXMENUCHECK);
-    int cy = GetSystemMetrics(SM_CYMENUCHECK);
     HICON icon = LoadLocalizedIconEx(ID_ICO_CONNECTING, cx, cy);
     ICONINFO iconinfo;
 
@@ -105,7 +125,6 @@ CreateMenuBitmaps(void)
 
     /* White mask pixels mark the background region */
     COLORREF ref = RGB(255, 255, 255);
-    COLORREF bg = GetSysColor(COLOR_MENU);
 
     for (int x = 0; x < cx; x++) {
         for (int y = 0; y < cy; y++) {
@@ -118,6 +137,12 @@ CreateMenuBitmaps(void)
     hbmpConnecting = (HBITMAP) SelectObject(imgDC, def1);
     SelectObject(maskDC, def2);
 
+    hbmp_key.lang = GetGUILanguage();
+    hbmp_key.dpi_scale = o.dpi_scale;
+    hbmp_key.cx = cx;
+    hbmp_key.cy = cy;
+    hbmp_key.bg = bg;
+
     /* We don't need the mask bitmap -- free it */
     DeleteObject(iconinfo.hbmMask);
 
@@ -146,6 +171,187 @@ AllocateConnectionMenu()
     return;
 }
 
+/* The group whose menu lists this config */
+static config_group_t *
+MenuGroup(const connection_t *c)
+{
+    return (USE_NESTED_CONFIG_MENU && CONFIG_GROUP(c)) ? CONFIG_GROUP(c) : &o.groups[0];
+}
+
+/* Create an empty submenu, tagged with data used to identify it when it opens */
+static HMENU
+CreateTaggedMenu(INT data)
+{
+    HMENU menu = CreatePopupMenu();
+    MENUINFO minfo = {.cbSize = sizeof(MENUINFO), .fMask = MIM_MENUDATA, .dwMenuData = data};
+    if (menu)
+        SetMenuInfo(menu, &minfo);
+    return menu;
+}
+
+/* Group menus are tagged with -(id + 1) to tell them apart from connection menus */
+#define GROUP_MENU_TAG(id) (-(id) - 1)
+
+/* Add the actions to the menu of connection i */
+static void
+FillConnectionMenu(int i)
+{
+    HMENU menu = hMenuConn[i];
+
+    AppendMenu(menu, MF_STRING, IDM_CONNECTMENU, LoadLocalizedString(IDS_MENU_CONNECT));
+    AppendMenu(menu, MF_STRING, IDM_DISCONNECTMENU, LoadLocalizedString(IDS_MENU_DISCONNECT));
+    AppendMenu(menu, MF_STRING, IDM_RECONNECTMENU, LoadLocalizedString(IDS_MENU_RECONNECT));
+    AppendMenu(menu, MF_STRING, IDM_STATUSMENU, LoadLocalizedString(IDS_MENU_STATUS));
+    AppendMenu(menu, MF_SEPARATOR, 0, 0);
+
+    AppendMenu(menu, MF_STRING, IDM_VIEWLOGMENU, LoadLocalizedString(IDS_MENU_VIEWLOG));
+
+    AppendMenu(menu, MF_STRING, IDM_EDITMENU, LoadLocalizedString(IDS_MENU_EDITCONFIG));
+    AppendMenu(menu, MF_STRING, IDM_CLEARPASSMENU, LoadLocalizedString(IDS_MENU_CLEARPASS));
+
+#ifndef DISABLE_CHANGE_PASSWORD
+    if (o.conn[i].flags & FLAG_ALLOW_CHANGE_PASSPHRASE)
+        AppendMenu(menu, MF_STRING, IDM_PASSPHRASEMENU, LoadLocalizedString(IDS_MENU_PASSPHRASE));
+#endif
+
+    SetMenuStatusById(i, o.conn[i].state);
+}
+
+/*
+ * Add entries for the child groups and configs of group g to its menu.
+ * Their own submenus are left empty until they are opened.
+ */
+static void
+PopulateGroupMenu(config_group_t *g)
+{
+    int id = (int) (g - o.groups);
+    int count;
+
+    /* no index if it could not be built */
+    if (id >= menu_index.num_groups)
+        return;
+
+    const int *entry = menu_index_entries(&menu_index, id, &count);
+    for (int k = 0; k < count; k++)
+    {
+        int i = entry[k];
+        if (i < 0)
+        {
+            config_group_t *this = &o.groups[MENU_INDEX_GROUP(i)];
+            this->menu = CreateTaggedMenu(GROUP_MENU_TAG(MENU_INDEX_GROUP(i)));
+            AppendMenu(g->menu, MF_POPUP, (UINT_PTR) this->menu, this->name);
+        }
+        else
+        {
+            hMenuConn[i] = CreateTaggedMenu(i);
+            AppendMenu(g->menu, MF_POPUP, (UINT_PTR) hMenuConn[i], o.conn[i].config_name);
+        }
+    }
+
+    /* set check marks of the new entries */
+    for (int i = 0; i < o.num_configs; i++)
+    {
+        if (o.conn[i].state != disconnected && menu_index_in_group(&menu_index, i, id))
+            SetMenuStatusById(i, o.conn[i].state);
+    }
+}
+
+/*
+ * Assign menu positions and index the entries of each group menu:
+ * groups first, then configs. Returns false if out of memory.
+ */
+static BOOL
+BuildMenuIndex(void)
+{
+    if (!menu_index_reset(&menu_index, o.num_groups, o.num_configs))
+    {
+        MsgToEventLog(EVENTLOG_ERROR_TYPE, L"Out of memory building the menu of %d configs", o.num_configs);
+        return false;
+    }
+
+    /* i = 0 is the root menu and has no parent */
+    for (int i = 1; i < o.num_groups; i++)
+        menu_index_set_group(&menu_index, i, o.groups[i].parent,
+                             USE_NESTED_CONFIG_MENU && o.groups[i].active);
+    for (int i = 0; i < o.num_configs; i++)
+        menu_index_set_config(&menu_index, i, (int) (MenuGroup(&o.conn[i]) - o.groups));
+    menu_index_build(&menu_index);
+
+    for (int i = 0; i < o.num_groups; i++)
+    {
+        o.groups[i].pos = menu_index.group_pos[i];
+        o.groups[i].children = menu_index.children[i];
+    }
+    for (int i = 0; i < o.num_configs; i++)
+        o.conn[i].pos = menu_index.config_pos[i];
+    return true;
+}
+
+static void
+ClearMenu(HMENU menu)
+{
+    /* this also destroys any submenus */
+    while (GetMenuItemCount(menu) > 0)
+        DeleteMenu(menu, 0, MF_BYPOSITION);
+}
+
+/*
+ * Release the submenus built while the menu was last shown. Done before
+ * showing the menu again, as commands from the previous session are
+ * handled after the menu is closed.
+ */
+static void
+RecycleSubmenus(void)
+{
+    if (o.num_configs <= 1)
+        return;
+
+    /* top level entries stay in place, their content is discarded */
+    for (int i = 1; i < o.num_groups; i++)
+    {
+        config_group_t *this = &o.groups[i];
+        if (this->menu && PARENT_GROUP(this) == &o.groups[0])
+            ClearMenu(this->menu);
+    }
+    for (int i = 1; i < o.num_groups; i++)
+    {
+        if (PARENT_GROUP(&o.groups[i]) != &o.groups[0])
+            o.groups[i].menu = NULL;
+    }
+    for (int i = 0; i < o.num_configs; i++)
+    {
+        if (MenuGroup(&o.conn[i]) != &o.groups[0])
+            hMenuConn[i] = NULL;
+        else if (hMenuConn[i])
+            ClearMenu(hMenuConn[i]);
+    }
+}
+
+/*
+ * Called on WM_INITMENUPOPUP: fill in a group or connection menu that
+ * is about to open.
+ */
+void
+OnInitMenuPopup(HMENU menu)
+{
+    MENUINFO minfo = {.cbSize = sizeof(MENUINFO), .fMask = MIM_MENUDATA};
+
+    if (o.num_configs <= 1 || menu == hMenu || menu == hMenuImport
+        || !GetMenuInfo(menu, &minfo) || GetMenuItemCount(menu) != 0)
+        return;
+
+    INT id = (INT) minfo.dwMenuData;
+    if (id >= 0 && id < o.num_configs && hMenuConn[id] == menu)
+    {
+        FillConnectionMenu(id);
+    }
+    else if (id < 0 && GROUP_MENU_TAG(id) < o.num_groups
+             && o.groups[GROUP_MENU_TAG(id)].menu == menu)
+    {
+        PopulateGroupMenu(&o.groups[GROUP_MENU_TAG(id)]);
+    }
+}
+
 /* Create popup menus */
 void
 CreatePopupMenus()
@@ -156,28 +362,19 @@ CreatePopupMenus()
      */
     assert(o.num_groups > 0);
 
+    TRACE_BEGIN("CreatePopupMenus");
     AllocateConnectionMenu();
 
     CreateMenuBitmaps();
     MENUINFO minfo = {.cbSize = sizeof(MENUINFO)};
 
+    /* Submenus are created when their parent is about to open */
     for (int i = 0; i < o.num_configs; i++)
-    {
-        hMenuConn[i] = CreatePopupMenu();
-        /* Save the connection index in the menu.*/
-        minfo.fMask = MIM_MENUDATA;
-        minfo.dwMenuData = i;
-        SetMenuInfo(hMenuConn[i], &minfo);
-    }
+        hMenuConn[i] = NULL;
     for (int i = 0; i < o.num_groups; i++)
-    {
-        if (!o.groups[i].active)
-            continue;
-        o.groups[i].menu = CreatePopupMenu();
-        o.groups[i].children = 0; /* we have to recount this when assigning menu position index */
-    }
+        o.groups[i].menu = NULL;
 
-    hMenu = o.groups[0].menu; /* the first group menu is also the root menu */
+    hMenu = o.groups[0].menu = CreatePopupMenu(); /* the first group menu is also the root menu */
 
     /* Set notify by position style for the top menu - gets automatically applied to sub-menus */
     minfo.fMask = MIM_STYLE;
@@ -217,47 +414,16 @@ CreatePopupMenus()
         SetMenuStatusById(0,  o.conn[0].state);
     }
     else {
-        /* construct the submenu tree first */
-        if (USE_NESTED_CONFIG_MENU)
-        {
-            /* i = 0 is the root menu and has no parent */
-            for (int i = 1; i < o.num_groups; i++)
-            {
-                config_group_t *this = &o.groups[i];
-                config_group_t *parent = PARENT_GROUP(this);
-
-                if (!this->active || !parent)
-                    continue;
-                AppendMenu(parent->menu, MF_POPUP, (UINT_PTR) this->menu, this->name);
-                this->pos = parent->children++;
-
-                PrintDebug(L"Submenu %d named %ls added to parent %ls with position %d",
-                        i, this->name, parent->name, this->pos);
-            }
-        }
+        BuildMenuIndex();
 
-        /* add config file (connection) entries */
-        for (int i = 0; i < o.num_configs; i++)
-        {
-            connection_t *c = &o.conn[i];
-            config_group_t *parent = &o.groups[0]; /* by default config is added to the root */
-
-            if (USE_NESTED_CONFIG_MENU)
-            {
-                parent = CONFIG_GROUP(c);
-            }
-            assert(parent);
-
-            /* Add config to the current sub menu */
-            AppendMenu(parent->menu, MF_POPUP, (UINT_PTR) hMenuConn[i], c->config_name);
-            c->pos = parent->children++;
-
-            PrintDebug(L"Config %d named %ls added to submenu %ls with position %d",
-                        i, c->config_name, parent->name, c->pos);
-        }
+        /* only the top level entries are added now */
+        PopulateGroupMenu(&o.groups[0]);
 
         if (o.num_configs > 0)
+        {
             AppendMenu(hMenu, MF_SEPARATOR, 0, 0);
+            AppendMenu(hMenu, MF_STRING, IDM_QUICKCONNECT, LoadLocalizedString(IDS_MENU_QUICKCONNECT));
+        }
 
         hMenuImport = CreatePopupMenu();
         AppendMenu(hMenu, MF_POPUP, (UINT_PTR) hMenuImport, LoadLocalizedString(IDS_MENU_IMPORT));
@@ -267,28 +433,8 @@ CreatePopupMenus()
 
         AppendMenu(hMenu, MF_STRING, IDM_SETTINGS, LoadLocalizedString(IDS_MENU_SETTINGS));
         AppendMenu(hMenu, MF_STRING, IDM_CLOSE, LoadLocalizedString(IDS_MENU_CLOSE));
-
-        /* Create popup menus for every connection */
-        for (int i = 0; i < o.num_configs; i++) {
-            AppendMenu(hMenuConn[i], MF_STRING, IDM_CONNECTMENU, LoadLocalizedString(IDS_MENU_CONNECT));
-            AppendMenu(hMenuConn[i], MF_STRING, IDM_DISCONNECTMENU, LoadLocalizedString(IDS_MENU_DISCONNECT));
-            AppendMenu(hMenuConn[i], MF_STRING, IDM_RECONNECTMENU, LoadLocalizedString(IDS_MENU_RECONNECT));
-            AppendMenu(hMenuConn[i], MF_STRING, IDM_STATUSMENU, LoadLocalizedString(IDS_MENU_STATUS));
-            AppendMenu(hMenuConn[i], MF_SEPARATOR, 0, 0);
-
-            AppendMenu(hMenuConn[i], MF_STRING, IDM_VIEWLOGMENU, LoadLocalizedString(IDS_MENU_VIEWLOG));
-
-            AppendMenu(hMenuConn[i], MF_STRING, IDM_EDITMENU, LoadLocalizedString(IDS_MENU_EDITCONFIG));
-            AppendMenu(hMenuConn[i], MF_STRING, IDM_CLEARPASSMENU, LoadLocalizedString(IDS_MENU_CLEARPASS));
-
-#ifndef DISABLE_CHANGE_PASSWORD
-            if (o.conn[i].flags & FLAG_ALLOW_CHANGE_PASSPHRASE)
-                AppendMenu(hMenuConn[i], MF_STRING, IDM_PASSPHRASEMENU, LoadLocalizedString(IDS_MENU_PASSPHRASE));
-#endif
-
-            SetMenuStatusById(i, o.conn[i].state);
-        }
     }
+    TRACE_END("CreatePopupMenus");
 }
 
 
@@ -296,13 +442,14 @@ CreatePopupMenus()
 static void
 DestroyPopupMenus()
 {
-    int i;
-    for (i = 0; i < o.num_configs; i++)
-        DestroyMenu(hMenuConn[i]);
-
-    DestroyMenu(hMenuImport);
+    /* submenus attached to the root are destroyed with it */
     DestroyMenu(hMenu);
 
+    for (int i = 0; i < o.num_configs; i++)
+        hMenuConn[i] = NULL;
+    for (int i = 0; i < o.num_groups; i++)
+        o.groups[i].menu = NULL;
+
     hMenuImport = NULL;
     hMenu = NULL;
 }
@@ -313,7 +460,48 @@ RecreatePopupMenus(void)
 {
     DestroyPopupMenus();
     BuildFileList();
+    QuickConnectIndexBuild();
     CreatePopupMenus();
+
+    /* new persistent configs may need attaching */
+    PostMessage(o.hWnd, WM_OVPN_PERSISTENT, (WPARAM) -1, 0);
+}
+
+/* Bring the check marks and enabled items of all configs up to date */
+static void
+RefreshMenuStatus(void)
+{
+    /* group check marks are set but never cleared by SetMenuStatusById */
+    if (o.num_configs > 1 && USE_NESTED_CONFIG_MENU)
+    {
+        for (int i = 1; i < o.num_groups; i++)
+        {
+            config_group_t *this = &o.groups[i];
+            config_group_t *parent = PARENT_GROUP(this);
+            if (this->active && parent)
+                CheckMenuItem(parent->menu, this->pos, MF_BYPOSITION | MF_UNCHECKED);
+        }
+    }
+    for (int i = 0; i < o.num_configs; i++)
+        SetMenuStatusById(i, o.conn[i].state);
+}
+
+/*
+ * Make the popup menus current before showing them. The config folders
+ * are rescanned only if they have changed since the last scan.
+ */
+static void
+UpdatePopupMenus(void)
+{
+    if (!hMenu || ConfigListChanged())
+    {
+        RecreatePopupMenus();
+    }
+    else
+    {
+        RecycleSubmenus();
+        RefreshMenuStatus();
+    }
 }
 
 /*
@@ -326,7 +514,7 @@ OnNotifyTray(LPARAM lParam)
 
     switch (lParam) {
     case WM_RBUTTONUP:
-        RecreatePopupMenus();
+        UpdatePopupMenus();
 
         GetCursorPos(&pt);
         SetForegroundWindow(o.hWnd);
@@ -338,7 +526,7 @@ OnNotifyTray(LPARAM lParam)
         {
             int disconnected_conns = CountConnState(disconnected);
 
-            RecreatePopupMenus();
+            UpdatePopupMenus();
 
             /* Start connection if only one config exist */
             if (o.num_configs == 1 && o.conn[0].state == disconnected)
@@ -349,8 +537,7 @@ OnNotifyTray(LPARAM lParam)
                 int num_shown = 0;
                 for (i = 0; i < o.num_configs; i++) {
                     if (o.conn[i].state != disconnected) {
-                        ShowWindow(o.conn[i].hwndStatus, SW_SHOW);
-                        SetForegroundWindow(o.conn[i].hwndStatus);
+                        ShowStatusWindowAsync(&o.conn[i], TRUE);
                         if (++num_shown >= 10) break;
                     }
                 }
@@ -388,55 +575,81 @@ ShowTrayIcon()
   Shell_NotifyIcon(NIM_ADD, &ni);
 }
 
+/* Tray tooltip under construction */
+struct tip {
+    TCHAR *buf;
+    size_t size;
+    size_t len;
+    const TCHAR *prefix;        /* added before the first name in a list */
+    const connection_t *last;   /* last connection added */
+};
+
+static void
+TipAppend(struct tip *tip, const TCHAR *str)
+{
+    if (tip->len + 1 >= tip->size)
+        return;
+    int n = _sntprintf(tip->buf + tip->len, tip->size - tip->len - 1, L"%ls", str);
+    tip->len = (n < 0) ? tip->size - 1 : tip->len + n;
+    tip->buf[tip->len] = _T('\0');
+}
+
+static void
+TipAddName(struct tip *tip, const connection_t *c)
+{
+    TipAppend(tip, tip->prefix ? tip->prefix : _T(", "));
+    TipAppend(tip, c->config_name);
+    tip->prefix = NULL;
+    tip->last = c;
+}
+
+static void
+TipAddConnected(connection_t *c, void *arg)
+{
+    if (c->state == connected)
+        TipAddName(arg, c);
+}
+
+static void
+TipAddConnecting(connection_t *c, void *arg)
+{
+    if (c->state == connecting || c->state == resuming || c->state == reconnecting)
+        TipAddName(arg, c);
+}
+
 void
 SetTrayIcon(conn_state_t state)
 {
     TCHAR msg[500];
     TCHAR msg_connected[100];
     TCHAR msg_connecting[100];
-    int i, config = 0;
-    BOOL first_conn;
     UINT icon_id;
+    struct tip tip = {.buf = msg, .size = _countof(ni.szTip)};
 
-    _tcsncpy(msg, LoadLocalizedString(IDS_TIP_DEFAULT), _countof(ni.szTip));
     _tcsncpy(msg_connected, LoadLocalizedString(IDS_TIP_CONNECTED), _countof(msg_connected));
     _tcsncpy(msg_connecting, LoadLocalizedString(IDS_TIP_CONNECTING), _countof(msg_connecting));
 
-    first_conn = TRUE;
-    for (i = 0; i < o.num_configs; i++) {
-        if (o.conn[i].state == connected) {
-            /* Append connection name to Icon Tip Msg */
-            _tcsncat(msg, (first_conn ? msg_connected : _T(", ")), _countof(msg) - _tcslen(msg) - 1);
-            _tcsncat(msg, o.conn[i].config_name, _countof(msg) - _tcslen(msg) - 1);
-            first_conn = FALSE;
-            config = i;
-        }
-    }
+    /* Build the tip from connections that are not disconnected only */
+    msg[0] = _T('\0');
+    TipAppend(&tip, LoadLocalizedString(IDS_TIP_DEFAULT));
+    tip.prefix = msg_connected;
+    ForEachActiveConn(TipAddConnected, &tip);
+    const connection_t *c = tip.last;
+    tip.prefix = msg_connecting;
+    ForEachActiveConn(TipAddConnecting, &tip);
 
-    first_conn = TRUE;
-    for (i = 0; i < o.num_configs; i++) {
-        if (o.conn[i].state == connecting || o.conn[i].state == resuming || o.conn[i].state == reconnecting) {
-            /* Append connection name to Icon Tip Msg */
-            _tcsncat(msg, (first_conn ? msg_connecting : _T(", ")), _countof(msg) - _tcslen(msg) - 1);
-            _tcsncat(msg, o.conn[i].config_name, _countof(msg) - _tcslen(msg) - 1);
-            first_conn = FALSE;
-        }
-    }
-
-    if (CountConnState(connected) == 1) {
+    if (CountConnState(connected) == 1 && c) {
         /* Append "Connected since and assigned IP" to message */
-        const connection_t *c = &o.conn[config];
         TCHAR time[50];
 
-        LocalizedTime(o.conn[config].connected_since, time, _countof(time));
-        _tcsncat(msg, LoadLocalizedString(IDS_TIP_CONNECTED_SINCE), _countof(msg) - _tcslen(msg) - 1);
-        _tcsncat(msg, time, _countof(msg) - _tcslen(msg) - 1);
+        LocalizedTime(c->connected_since, time, _countof(time));
+        TipAppend(&tip, LoadLocalizedString(IDS_TIP_CONNECTED_SINCE));
+        TipAppend(&tip, time);
 
         /* concatenate ipv4 and ipv6 addresses into one string */
         WCHAR ip[64];
         wcs_concat2(ip, _countof(ip), c->ip, c->ipv6, L", ");
-        WCHAR *assigned_ip = LoadLocalizedString(IDS_TIP_ASSIGNED_IP, ip);
-        _tcsncat(msg, assigned_ip, _countof(msg) - _tcslen(msg) - 1);
+        TipAppend(&tip, LoadLocalizedString(IDS_TIP_ASSIGNED_IP, ip));
     }
 
     icon_id = ID_ICO_CONNECTING;
@@ -494,14 +707,7 @@ ShowTrayBalloon(TCHAR *infotitle_msg, TCHAR *info_msg)
 void
 SetMenuStatus(connection_t *c, conn_state_t state)
 {
-    int i;
-
-    for (i = 0; i < o.num_configs; ++i)
-    {
-        if (c == &o.conn[i])
-            break;
-    }
-    SetMenuStatusById(i, state);
+    SetMenuStatusById((int) (c - o.conn), state);
 }
 
 void
@@ -550,12 +756,12 @@ SetMenuStatusById(int i, conn_state_t state)
     }
     else
     {
-        config_group_t *parent = &o.groups[0];
+        /* Submenus are built when opened: updates to menus not yet built
+         * are no-ops, and the state is applied when they are built.
+         */
+        config_group_t *parent = MenuGroup(c);
         int pos = c->pos;
 
-        if (USE_NESTED_CONFIG_MENU && CONFIG_GROUP(c))
-            parent = CONFIG_GROUP(c);
-
         if (checked == 1)
         {
             /* Connected: use system-default check mark */
@@ -35,6 +35,7 @@
 #define IDM_IMPORT_FILE         225
 #define IDM_IMPORT_AS           226
 #define IDM_IMPORT_URL          227
+#define IDM_QUICKCONNECT        228
 
 #define IDM_CONNECTMENU         300
 #define IDM_DISCONNECTMENU      (1 + IDM_CONNECTMENU)
@@ -48,6 +49,7 @@
 void RecreatePopupMenus(void);
 void CreatePopupMenus();
 void OnNotifyTray(LPARAM);
+void OnInitMenuPopup(HMENU);
 void OnDestroyTray(void);
 void ShowTrayIcon();
 void SetTrayIcon(conn_state_t);